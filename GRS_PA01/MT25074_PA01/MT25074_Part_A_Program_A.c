@@ -4,6 +4,7 @@
 #include<sys/wait.h>
 #include<string.h>
 #include"MT25074_Part_B_Program.h"
+#include"MT25074_Part_B_Pool.h"
 
 int main(int argc, char *argv[]) {
 
@@ -32,6 +33,17 @@ int main(int argc, char *argv[]) {
     //roll cycles are increased to get better stats
     long long roll_cycles = 8000; //4*10^3
 
+    //JOB_INPUT sets the job size: small to see what fork costs on short jobs,
+    //large so a scaling run lasts many sampler ticks
+    const char *job_input = getenv("JOB_INPUT");
+    if (job_input != NULL && atoll(job_input) > 0) roll_cycles = atoll(job_input);
+
+    //mixed tasks ("cpu+mem+io") or RUNTIME=pool: processes_count jobs per task
+    //go to a pool of long-lived workers instead of one fresh child per job
+    const char *runtime = getenv("RUNTIME");
+    if (strchr(task, '+') != NULL || (runtime != NULL && strcmp(runtime, "pool") == 0)) {
+        return pool_run(task, processes_count, roll_cycles) == 0 ? 0 : 1;
+    }
 
 
     printf("hello we are currently parent process with (pid:%d)\n", (int) getpid());
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <unistd.h>
 #include "MT25074_Part_B_Program.h"
+#include "MT25074_Part_B_Runtime.h"
 
 //wrapper for thread workers because cant pass cpu directly return types aren't void
 void *cpu_wrapper(void * args)
@@ -62,6 +63,17 @@ int main(int argc, char *argv[]) {
 
     long long roll_cycles = 8000;
 
+    //JOB_INPUT sets the job size, as for program_a1
+    const char *job_input = getenv("JOB_INPUT");
+    if (job_input != NULL && atoll(job_input) > 0) roll_cycles = atoll(job_input);
+
+    //mixed tasks ("cpu+mem+io") or RUNTIME=steal: the chunks of num_threads jobs
+    //per task go through the work-stealing pool instead of one thread per job
+    const char *runtime = getenv("RUNTIME");
+    if (strchr(task, '+') != NULL || (runtime != NULL && strcmp(runtime, "steal") == 0)) {
+        return ws_run(task, num_threads, roll_cycles) == 0 ? 0 : 1;
+    }
+
     //variable to store wrapper worker function pointer and assign according to cmd args
     void *(*wrapper_worker)(void *);
 
@@ -0,0 +1,358 @@
+#define _GNU_SOURCE  // sched_setaffinity
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "MT25074_Part_B_Program.h"
+#include "MT25074_Part_B_Pool.h"
+
+// ---------------------------------------------------------
+// PREFORK PROCESS POOL
+//
+// POOL_WORKERS processes (default: one per CPU we may run on) are forked once
+// and each pinned to its own CPU. They share one shm_open()/mmap() region:
+//   - a bounded lock-free MPMC ring of job ids (Vyukov's sequence-numbered
+//     slots), filled by the parent and drained by whichever worker is free
+//   - one spec per job (task, input) and one result slot per job, which the
+//     worker fills in and publishes with a release store
+//   - per-worker counters
+// A worker builds each job with work_job_create(), runs all of it, and goes
+// back to the ring, so the fork is paid once per worker, not once per job.
+// An empty ring is polled with a backoff of up to POOL_MAX_SLEEP_NS.
+// Output, with times counted from the first job being queued:
+//   POOL,job,<id>,<task>,<worker>,<start_s>,<run_s>,<done_s>,<checksum>
+//   POOL,worker,<id>,<pid>,<cpu>,<jobs>,<busy_s>
+//   POOL,summary,<workers>,<jobs>,<fork_s>,<makespan_s>,<jobs_per_s>,<p50_done_s>,<p99_done_s>
+
+#define POOL_CACHE_LINE 64
+#define POOL_RING_SIZE 1024        //power of two
+#define POOL_TASK_LEN 8
+#define POOL_MAX_KINDS 8
+#define POOL_MAX_SLEEP_NS 1000000L
+
+struct pool_slot {
+    _Atomic uint64_t seq;
+    int job;
+};
+
+struct pool_job {
+    char task[POOL_TASK_LEN];
+    long long input;
+};
+
+struct pool_result {
+    _Atomic int done;             //set last, with release
+    int worker;
+    int failed;
+    double checksum;
+    uint64_t start_ns, done_ns;
+};
+
+struct pool_worker {
+    _Alignas(POOL_CACHE_LINE) int pid;
+    int cpu;
+    long jobs;
+    uint64_t busy_ns;
+};
+
+struct pool_shm {
+    _Alignas(POOL_CACHE_LINE) _Atomic uint64_t enqueue_pos;
+    _Alignas(POOL_CACHE_LINE) _Atomic uint64_t dequeue_pos;
+    _Alignas(POOL_CACHE_LINE) _Atomic int jobs_done;
+    _Atomic int shutdown;
+    int nworkers, njobs;
+    struct pool_slot ring[POOL_RING_SIZE];
+    //followed by njobs pool_job, njobs pool_result and nworkers pool_worker
+};
+
+struct pool_layout {
+    struct pool_shm *shm;
+    struct pool_job *jobs;
+    struct pool_result *results;
+    struct pool_worker *workers;
+    size_t size;
+};
+
+static uint64_t pool_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t align_up(size_t n) {
+    return (n + POOL_CACHE_LINE - 1) / POOL_CACHE_LINE * POOL_CACHE_LINE;
+}
+
+// ---------------------------------------------------------
+// SHARED RING
+
+static void ring_init(struct pool_shm *shm) {
+    for (uint64_t i = 0; i < POOL_RING_SIZE; i++) atomic_init(&shm->ring[i].seq, i);
+    atomic_init(&shm->enqueue_pos, 0);
+    atomic_init(&shm->dequeue_pos, 0);
+}
+
+//returns 0 when the ring is full
+static int ring_push(struct pool_shm *shm, int job) {
+    uint64_t pos = atomic_load_explicit(&shm->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+       struct pool_slot *slot = &shm->ring[pos & (POOL_RING_SIZE - 1)];
+       int64_t dif = (int64_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) - pos);
+       if (dif == 0) {
+          if (atomic_compare_exchange_weak_explicit(&shm->enqueue_pos, &pos, pos + 1,
+                                                    memory_order_relaxed, memory_order_relaxed)) {
+             slot->job = job;
+             atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+             return 1;
+          }
+       }
+       else if (dif < 0) {
+          return 0;
+       }
+       else {
+          pos = atomic_load_explicit(&shm->enqueue_pos, memory_order_relaxed);
+       }
+    }
+}
+
+//returns 0 when the ring is empty
+static int ring_pop(struct pool_shm *shm, int *job) {
+    uint64_t pos = atomic_load_explicit(&shm->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+       struct pool_slot *slot = &shm->ring[pos & (POOL_RING_SIZE - 1)];
+       int64_t dif = (int64_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) - (pos + 1));
+       if (dif == 0) {
+          if (atomic_compare_exchange_weak_explicit(&shm->dequeue_pos, &pos, pos + 1,
+                                                    memory_order_relaxed, memory_order_relaxed)) {
+             *job = slot->job;
+             //hand the slot back to producers one lap later
+             atomic_store_explicit(&slot->seq, pos + POOL_RING_SIZE, memory_order_release);
+             return 1;
+          }
+       }
+       else if (dif < 0) {
+          return 0;
+       }
+       else {
+          pos = atomic_load_explicit(&shm->dequeue_pos, memory_order_relaxed);
+       }
+    }
+}
+
+//spin a little, then sleep a little longer each time, capped
+static void backoff(long *sleep_ns) {
+    if (*sleep_ns == 0) {
+       *sleep_ns = 1000;
+       sched_yield();
+       return;
+    }
+    struct timespec ts = { 0, *sleep_ns };
+    nanosleep(&ts, NULL);
+    if (*sleep_ns < POOL_MAX_SLEEP_NS) *sleep_ns *= 2;
+}
+
+// ---------------------------------------------------------
+// WORKER PROCESS
+
+static void pool_worker_main(struct pool_layout *l, int id) {
+    struct pool_worker *me = &l->workers[id];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(me->cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+
+    long sleep_ns = 0;
+    while (!atomic_load_explicit(&l->shm->shutdown, memory_order_acquire)) {
+       int j;
+       if (!ring_pop(l->shm, &j)) {
+          backoff(&sleep_ns);
+          continue;
+       }
+       sleep_ns = 0;
+
+       struct pool_result *r = &l->results[j];
+       r->worker = id;
+       r->start_ns = pool_now_ns();
+       struct work_job *work = work_job_create(l->jobs[j].task, l->jobs[j].input);
+       if (work != NULL) {
+          r->checksum = work_job_run(work, 0, work_job_units(work));
+          work_job_finish(work);
+          work_job_destroy(work);
+       }
+       r->failed = work == NULL;
+       r->done_ns = pool_now_ns();
+       atomic_store_explicit(&r->done, 1, memory_order_release);
+       atomic_fetch_add_explicit(&l->shm->jobs_done, 1, memory_order_release);
+
+       me->jobs++;
+       me->busy_ns += r->done_ns - r->start_ns;
+    }
+}
+
+// ---------------------------------------------------------
+// PARENT
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int map_region(struct pool_layout *l, int njobs, int nworkers) {
+    size_t jobs_off = align_up(sizeof(struct pool_shm));
+    size_t results_off = align_up(jobs_off + njobs * sizeof(struct pool_job));
+    size_t workers_off = align_up(results_off + njobs * sizeof(struct pool_result));
+    l->size = workers_off + nworkers * sizeof(struct pool_worker);
+
+    //a named object, as a separate program could attach to it; unlinked once mapped
+    char name[64];
+    snprintf(name, sizeof(name), "/MT25074_pool_%d", getpid());
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+       fprintf(stderr, "shm_open %s: %s\n", name, strerror(errno));
+       return 0;
+    }
+    int ok = ftruncate(fd, (off_t)l->size) == 0;
+    char *base = ok ? mmap(NULL, l->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (base == MAP_FAILED) fprintf(stderr, "shared region: %s\n", strerror(errno));
+    shm_unlink(name);
+    close(fd);
+    if (base == MAP_FAILED) return 0;
+
+    //ftruncate zero-fills, so every counter and flag starts at 0
+    l->shm = (struct pool_shm *)base;
+    l->jobs = (struct pool_job *)(base + jobs_off);
+    l->results = (struct pool_result *)(base + results_off);
+    l->workers = (struct pool_worker *)(base + workers_off);
+    return 1;
+}
+
+static void pool_report(struct pool_layout *l, uint64_t t0, double fork_s) {
+    int njobs = l->shm->njobs;
+    double *done = malloc(njobs * sizeof(double));
+    double makespan = 0.0;
+
+    for (int j = 0; j < njobs; j++) {
+       struct pool_result *r = &l->results[j];
+       done[j] = (r->done_ns - t0) / 1e9;
+       if (done[j] > makespan) makespan = done[j];
+       printf("POOL,job,%d,%s,%d,%.3f,%.3f,%.3f,%.6f%s\n", j, l->jobs[j].task, r->worker,
+              (r->start_ns - t0) / 1e9, (r->done_ns - r->start_ns) / 1e9, done[j], r->checksum,
+              r->failed ? ",failed" : "");
+    }
+    for (int i = 0; i < l->shm->nworkers; i++) {
+       struct pool_worker *w = &l->workers[i];
+       printf("POOL,worker,%d,%d,%d,%ld,%.3f\n", i, w->pid, w->cpu, w->jobs, w->busy_ns / 1e9);
+    }
+
+    qsort(done, njobs, sizeof(double), cmp_double);
+    long p50 = (long)(0.50 * njobs + 0.999999) - 1;
+    long p99 = (long)(0.99 * njobs + 0.999999) - 1;
+    printf("POOL,summary,%d,%d,%.3f,%.3f,%.1f,%.3f,%.3f\n", l->shm->nworkers, njobs, fork_s, makespan,
+           makespan > 0 ? njobs / makespan : 0.0, done[p50 < 0 ? 0 : p50], done[p99 < 0 ? 0 : p99]);
+    free(done);
+}
+
+int pool_run(const char *tasks, int count, long long input) {
+
+    //"cpu+mem+io" -> task names
+    char list[128];
+    char *kinds[POOL_MAX_KINDS];
+    int nkinds = 0;
+    snprintf(list, sizeof(list), "%s", tasks);
+    char *save;
+    for (char *tok = strtok_r(list, "+", &save); tok && nkinds < POOL_MAX_KINDS; tok = strtok_r(NULL, "+", &save)) {
+       if (strcmp(tok, "cpu") != 0 && strcmp(tok, "mem") != 0 && strcmp(tok, "io") != 0) {
+          fprintf(stderr, "Error: Unknown task '%s'\n", tok);
+          return -1;
+       }
+       kinds[nkinds++] = tok;
+    }
+    if (nkinds == 0 || count < 1) {
+       fprintf(stderr, "Error: nothing to run\n");
+       return -1;
+    }
+
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE], ncpus = 0;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+       for (int c = 0; c < CPU_SETSIZE; c++) {
+          if (CPU_ISSET(c, &allowed)) cpus[ncpus++] = c;
+       }
+    }
+    if (ncpus == 0) cpus[ncpus++] = 0;
+    const char *env = getenv("POOL_WORKERS");
+    int nworkers = env ? atoi(env) : ncpus;
+    if (nworkers < 1) nworkers = 1;
+
+    //jobs interleaved by type: cpu, mem, io, cpu, mem, io, ...
+    int njobs = count * nkinds;
+    struct pool_layout l;
+    if (!map_region(&l, njobs, nworkers)) return -1;
+    ring_init(l.shm);
+    l.shm->nworkers = nworkers;
+    l.shm->njobs = njobs;
+    for (int j = 0; j < njobs; j++) {
+       snprintf(l.jobs[j].task, POOL_TASK_LEN, "%s", kinds[j % nkinds]);
+       l.jobs[j].input = input;
+    }
+    printf("process pool: %d workers, %d jobs (%s x %d), input %lld\n", nworkers, njobs, tasks, count, input);
+    fflush(stdout);   //or every child flushes its copy of the buffer on exit
+
+    //fork the pool once
+    uint64_t fork_start = pool_now_ns();
+    int started = 0;
+    for (; started < nworkers; started++) {
+       l.workers[started].cpu = cpus[started % ncpus];
+       pid_t pid = fork();
+       if (pid < 0) {
+          fprintf(stderr, "fork failed\n");
+          break;
+       }
+       if (pid == 0) {
+          pool_worker_main(&l, started);
+          _exit(0);
+       }
+       l.workers[started].pid = pid;
+    }
+    double fork_s = (pool_now_ns() - fork_start) / 1e9;
+    l.shm->nworkers = started;
+
+    //queue every job (waiting for room when the ring is full), then wait for the results
+    uint64_t t0 = pool_now_ns();
+    int queued = 0, ok = started > 0;
+    long sleep_ns = 0;
+    while (ok && atomic_load_explicit(&l.shm->jobs_done, memory_order_acquire) < njobs) {
+       int before = queued;
+       while (queued < njobs && ring_push(l.shm, queued)) queued++;
+       if (queued > before) sleep_ns = 0;
+
+       //a worker that dies takes its job with it; stop instead of waiting forever
+       int status;
+       pid_t dead = waitpid(-1, &status, WNOHANG);
+       if (dead > 0) {
+          fprintf(stderr, "pool worker %d exited early\n", (int)dead);
+          ok = 0;
+          break;
+       }
+       backoff(&sleep_ns);
+    }
+
+    atomic_store_explicit(&l.shm->shutdown, 1, memory_order_release);
+    for (int i = 0; i < started; i++) {
+       if (!ok) kill(l.workers[i].pid, SIGKILL);
+       waitpid(l.workers[i].pid, NULL, 0);
+    }
+    if (ok) pool_report(&l, t0, fork_s);
+
+    munmap(l.shm, l.size);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,9 @@
+#ifndef POOL_H //prefork process pool for the fork driver
+#define POOL_H
+
+//runs `count` jobs of every task in `tasks` ("cpu", "mem+io", "cpu+mem+io", ...)
+//on long-lived worker processes that pull them from a shared-memory ring;
+//returns 0, or -1 if the pool could not be set up or a worker died
+int pool_run(const char *tasks, int count, long long input);
+
+#endif
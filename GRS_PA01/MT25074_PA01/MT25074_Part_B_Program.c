@@ -1,93 +1,1022 @@
+#define _GNU_SOURCE  // O_DIRECT
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <math.h>
 #include <pthread.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <linux/mempolicy.h>
 #include "MT25074_Part_B_Program.h"
+#include "MT25074_Part_B_Uring.h"
 
 // ---------------------------------------------------------
 // CPU TASK
+//
+// The same work in every engine: input * 15000 sin(i) * cos(i) evaluations,
+// summed. CPU_ENGINE picks how it is computed:
+//   scalar   - libm sin() and cos(), one i at a time (reference)
+//   simd     - polynomial sincos on the widest ISA this CPU has (default)
+//   avx512 / avx2 / portable - force one SIMD path
+// The SIMD paths keep several independent accumulators so the loop is bound
+// by the FMA units, not by the latency of one long add chain. Every worker
+// prints "CPU,<engine>,<ops>,<seconds>,<ops_per_sec>,<checksum>" at the end.
 
-void cpu(long long input) {
-    long long cycles = input * 15000LL;
-    volatile double val = 0.0;
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_X86 1
+#endif
+
+// Cody-Waite split of pi/2; with FMA, x - q*PIO2_1 is exact for the |x| we see
+#define PIO2_1 1.57079632673412561417e+00
+#define PIO2_2 6.07710050630396597660e-11
+#define PIO2_3 2.02226624871116645580e-21
+#define TWO_OVER_PI 6.36619772367581382433e-01
+
+// fdlibm minimax coefficients on [-pi/4, pi/4]
+#define S1 -1.66666666666666324348e-01
+#define S2  8.33333333332248946124e-03
+#define S3 -1.98412698298579493134e-04
+#define S4  2.75573137070700676789e-06
+#define S5 -2.50507602534068634195e-08
+#define S6  1.58969099521155010221e-10
+#define C1  4.16666666666666019037e-02
+#define C2 -1.38888888888741095749e-03
+#define C3  2.48015872894767294178e-05
+#define C4 -2.75573143513906633035e-07
+#define C5  2.08757232129817482790e-09
+#define C6 -1.13596475577881948265e-11
+
+#define CPU_ACCUMULATORS 4
+
+//sin(x) * cos(x) with the same reduction and polynomials as the vector paths
+static double sincos_product(double x) {
+    double q = nearbyint(x * TWO_OVER_PI);
+    double r = fma(-q, PIO2_1, x);
+    r = fma(-q, PIO2_2, r);
+    r = fma(-q, PIO2_3, r);
+
+    double z = r * r;
+    double s = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    double c = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
 
-   //simple trigonometry functions computation
-    for (long long i = 0; i < cycles; i++) {
+    //quadrant: swap sin/cos when odd, then fix the signs
+    long n = (long)q & 3;
+    double sin_x = (n & 1) ? c : s;
+    double cos_x = (n & 1) ? s : c;
+    if (n & 2) sin_x = -sin_x;
+    if ((n + 1) & 2) cos_x = -cos_x;
+    return sin_x * cos_x;
+}
+
+//every engine sums i in [begin, end), so a run can be split into chunks
+static double cpu_scalar(long long begin, long long end) {
+    double val = 0.0;
+    for (long long i = begin; i < end; i++) {
        val += sin(i) * cos(i);
     }
+    return val;
+}
+
+static double cpu_portable(long long begin, long long end) {
+    double acc[CPU_ACCUMULATORS] = {0};
+    long long i = begin;
+    for (; i + CPU_ACCUMULATORS <= end; i += CPU_ACCUMULATORS) {
+       for (int k = 0; k < CPU_ACCUMULATORS; k++) {
+          acc[k] += sincos_product((double)(i + k));
+       }
+    }
+    for (; i < end; i++) acc[0] += sincos_product((double)i);
+
+    double val = 0.0;
+    for (int k = 0; k < CPU_ACCUMULATORS; k++) val += acc[k];
+    return val;
+}
+
+#ifdef CPU_X86
+
+__attribute__((target("avx2,fma")))
+static __m256d sincos_product_avx2(__m256d x) {
+    __m256d q = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(TWO_OVER_PI)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(q, _mm256_set1_pd(PIO2_1), x);
+    r = _mm256_fnmadd_pd(q, _mm256_set1_pd(PIO2_2), r);
+    r = _mm256_fnmadd_pd(q, _mm256_set1_pd(PIO2_3), r);
+
+    __m256d z = _mm256_mul_pd(r, r);
+    __m256d ps = _mm256_fmadd_pd(z, _mm256_set1_pd(S6), _mm256_set1_pd(S5));
+    ps = _mm256_fmadd_pd(z, ps, _mm256_set1_pd(S4));
+    ps = _mm256_fmadd_pd(z, ps, _mm256_set1_pd(S3));
+    ps = _mm256_fmadd_pd(z, ps, _mm256_set1_pd(S2));
+    ps = _mm256_fmadd_pd(z, ps, _mm256_set1_pd(S1));
+    __m256d s = _mm256_fmadd_pd(_mm256_mul_pd(r, z), ps, r);
+
+    __m256d pc = _mm256_fmadd_pd(z, _mm256_set1_pd(C6), _mm256_set1_pd(C5));
+    pc = _mm256_fmadd_pd(z, pc, _mm256_set1_pd(C4));
+    pc = _mm256_fmadd_pd(z, pc, _mm256_set1_pd(C3));
+    pc = _mm256_fmadd_pd(z, pc, _mm256_set1_pd(C2));
+    pc = _mm256_fmadd_pd(z, pc, _mm256_set1_pd(C1));
+    __m256d c = _mm256_fmadd_pd(_mm256_mul_pd(z, z), pc,
+                                _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, _mm256_set1_pd(1.0)));
+
+    //quadrant bits as 64-bit lanes: bit 0 swaps, bit 1 flips the sign
+    __m256i n = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q));
+    __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(
+                       _mm256_and_si256(n, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1)));
+    __m256d sin_x = _mm256_blendv_pd(s, c, swap);
+    __m256d cos_x = _mm256_blendv_pd(c, s, swap);
+    __m256i two = _mm256_set1_epi64x(2);
+    __m256i sin_sign = _mm256_slli_epi64(_mm256_and_si256(n, two), 62);
+    __m256i cos_sign = _mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(n, _mm256_set1_epi64x(1)), two), 62);
+    sin_x = _mm256_xor_pd(sin_x, _mm256_castsi256_pd(sin_sign));
+    cos_x = _mm256_xor_pd(cos_x, _mm256_castsi256_pd(cos_sign));
+    return _mm256_mul_pd(sin_x, cos_x);
+}
+
+__attribute__((target("avx2,fma")))
+static double cpu_avx2(long long begin, long long end) {
+    __m256d acc[CPU_ACCUMULATORS];
+    __m256d x[CPU_ACCUMULATORS];
+    for (int k = 0; k < CPU_ACCUMULATORS; k++) {
+       acc[k] = _mm256_setzero_pd();
+       x[k] = _mm256_add_pd(_mm256_set1_pd((double)(begin + 4 * k)), _mm256_setr_pd(0, 1, 2, 3));
+    }
+    const __m256d step = _mm256_set1_pd(4 * CPU_ACCUMULATORS);
+
+    long long i = begin;
+    for (; i + 4 * CPU_ACCUMULATORS <= end; i += 4 * CPU_ACCUMULATORS) {
+       for (int k = 0; k < CPU_ACCUMULATORS; k++) {
+          acc[k] = _mm256_add_pd(acc[k], sincos_product_avx2(x[k]));
+          x[k] = _mm256_add_pd(x[k], step);
+       }
+    }
+
+    double lanes[4];
+    double val = 0.0;
+    for (int k = 0; k < CPU_ACCUMULATORS; k++) {
+       _mm256_storeu_pd(lanes, acc[k]);
+       val += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    for (; i < end; i++) val += sincos_product((double)i);
+    return val;
+}
+
+__attribute__((target("avx512f")))
+static __m512d sincos_product_avx512(__m512d x) {
+    __m512d q = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(TWO_OVER_PI)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(q, _mm512_set1_pd(PIO2_1), x);
+    r = _mm512_fnmadd_pd(q, _mm512_set1_pd(PIO2_2), r);
+    r = _mm512_fnmadd_pd(q, _mm512_set1_pd(PIO2_3), r);
+
+    __m512d z = _mm512_mul_pd(r, r);
+    __m512d ps = _mm512_fmadd_pd(z, _mm512_set1_pd(S6), _mm512_set1_pd(S5));
+    ps = _mm512_fmadd_pd(z, ps, _mm512_set1_pd(S4));
+    ps = _mm512_fmadd_pd(z, ps, _mm512_set1_pd(S3));
+    ps = _mm512_fmadd_pd(z, ps, _mm512_set1_pd(S2));
+    ps = _mm512_fmadd_pd(z, ps, _mm512_set1_pd(S1));
+    __m512d s = _mm512_fmadd_pd(_mm512_mul_pd(r, z), ps, r);
+
+    __m512d pc = _mm512_fmadd_pd(z, _mm512_set1_pd(C6), _mm512_set1_pd(C5));
+    pc = _mm512_fmadd_pd(z, pc, _mm512_set1_pd(C4));
+    pc = _mm512_fmadd_pd(z, pc, _mm512_set1_pd(C3));
+    pc = _mm512_fmadd_pd(z, pc, _mm512_set1_pd(C2));
+    pc = _mm512_fmadd_pd(z, pc, _mm512_set1_pd(C1));
+    __m512d c = _mm512_fmadd_pd(_mm512_mul_pd(z, z), pc,
+                                _mm512_fnmadd_pd(_mm512_set1_pd(0.5), z, _mm512_set1_pd(1.0)));
+
+    __m512i n = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(q));
+    __mmask8 swap = _mm512_test_epi64_mask(n, _mm512_set1_epi64(1));
+    __m512d sin_x = _mm512_mask_blend_pd(swap, s, c);
+    __m512d cos_x = _mm512_mask_blend_pd(swap, c, s);
+    __m512i two = _mm512_set1_epi64(2);
+    __m512i sin_sign = _mm512_slli_epi64(_mm512_and_si512(n, two), 62);
+    __m512i cos_sign = _mm512_slli_epi64(_mm512_and_si512(_mm512_add_epi64(n, _mm512_set1_epi64(1)), two), 62);
+    sin_x = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(sin_x), sin_sign));
+    cos_x = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(cos_x), cos_sign));
+    return _mm512_mul_pd(sin_x, cos_x);
+}
+
+__attribute__((target("avx512f")))
+static double cpu_avx512(long long begin, long long end) {
+    __m512d acc[CPU_ACCUMULATORS];
+    __m512d x[CPU_ACCUMULATORS];
+    for (int k = 0; k < CPU_ACCUMULATORS; k++) {
+       acc[k] = _mm512_setzero_pd();
+       x[k] = _mm512_add_pd(_mm512_set1_pd((double)(begin + 8 * k)), _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    const __m512d step = _mm512_set1_pd(8 * CPU_ACCUMULATORS);
+
+    long long i = begin;
+    for (; i + 8 * CPU_ACCUMULATORS <= end; i += 8 * CPU_ACCUMULATORS) {
+       for (int k = 0; k < CPU_ACCUMULATORS; k++) {
+          acc[k] = _mm512_add_pd(acc[k], sincos_product_avx512(x[k]));
+          x[k] = _mm512_add_pd(x[k], step);
+       }
+    }
+
+    double val = 0.0;
+    for (int k = 0; k < CPU_ACCUMULATORS; k++) val += _mm512_reduce_add_pd(acc[k]);
+    for (; i < end; i++) val += sincos_product((double)i);
+    return val;
+}
+
+#endif
+
+static const struct {
+    const char *name;
+    double (*run)(long long begin, long long end);
+} cpu_engines[] = {
+    { "scalar",   cpu_scalar },
+    { "portable", cpu_portable },
+#ifdef CPU_X86
+    { "avx2",     cpu_avx2 },
+    { "avx512",   cpu_avx512 },
+#endif
+};
+
+static int cpu_engine_supported(const char *name) {
+#ifdef CPU_X86
+    __builtin_cpu_init();
+    if (strcmp(name, "avx2") == 0) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (strcmp(name, "avx512") == 0) return __builtin_cpu_supports("avx512f");
+#endif
+    return 1;
+}
+
+//CPU_ENGINE from the environment, "simd" resolved to the widest supported path
+static int cpu_pick_engine(void) {
+    const char *want = getenv("CPU_ENGINE");
+    int count = sizeof(cpu_engines) / sizeof(cpu_engines[0]);
+
+    if (want != NULL && strcmp(want, "simd") != 0) {
+       int e = 0;
+       while (e < count && strcmp(want, cpu_engines[e].name) != 0) e++;
+       if (e == count) {
+          fprintf(stderr, "CPU_ENGINE=%s: unknown, using simd\n", want);
+       } else if (!cpu_engine_supported(want)) {
+          fprintf(stderr, "CPU_ENGINE=%s: not supported on this CPU, using simd\n", want);
+       } else {
+          return e;
+       }
+    }
+
+    //entries are ordered narrowest to widest
+    for (int e = count - 1; e > 0; e--) {
+       if (cpu_engine_supported(cpu_engines[e].name)) return e;
+    }
+    return 1;
+}
+
+void cpu(long long input) {
+    long long cycles = input * 15000LL;
+    int engine = cpu_pick_engine();
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    double val = cpu_engines[engine].run(0, cycles);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    //result goes through a volatile once, so the work cannot be optimised away
+    volatile double sink = val;
+    (void)sink;
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("CPU,%s,%lld,%.3f,%.0f,%.6f\n", cpu_engines[engine].name, cycles, elapsed,
+           elapsed > 0 ? cycles / elapsed : 0.0, val);
 }
 
 // ---------------------------------------------------------
 // MEMORY TASK
+//
+// MEM_MODE picks the access pattern, MEM_SIZE the working set (bytes, K/M/G
+// suffix allowed, default 256M) so one mode can be swept from L1 to DRAM:
+//   stream - STREAM copy, scale and triad over three arrays (default)
+//   chase  - dependent loads around a random cycle of cache lines (latency)
+//   stride - read every MEM_STRIDE bytes (default 64), all offsets in turn
+// Every worker prints "MEM,<mode>,<bytes>,<accesses>,<seconds>,<gb_per_s>,<ns_per_access>"
+// (one line per STREAM kernel). GB/s counts the bytes the kernel asks for,
+// as STREAM does, not whole cache lines.
+//
+// MEM_PAGES=thp|hugetlb backs buffers of 1 MB and up with 2 MB pages
+// (MADV_HUGEPAGE, or MAP_HUGETLB from the reserved pool, falling back to THP),
+// and MEM_NUMA=local binds them to the NUMA node of the worker's CPU. Either
+// way the buffer is pre-faulted when it is allocated, so page faults and
+// zeroing stay out of the timed kernels and the TLB numbers are the workload's.
 
-void mem(long long input) {
+#define MEM_DEFAULT_SIZE (256LL << 20)
+#define MEM_LINE 64
+#define MEM_HUGE_PAGE (2UL << 20)
+#define MEM_MAX_NODES 1024
+
+enum mem_pages { PAGES_DEFAULT, PAGES_THP, PAGES_HUGETLB };
+
+static enum mem_pages mem_pages_wanted(size_t len) {
+    const char *pages = getenv("MEM_PAGES");
+    //below half a huge page there is no TLB reach to gain
+    if (pages == NULL || len < MEM_HUGE_PAGE / 2) return PAGES_DEFAULT;
+    if (strcmp(pages, "thp") == 0) return PAGES_THP;
+    if (strcmp(pages, "hugetlb") == 0) return PAGES_HUGETLB;
+    return PAGES_DEFAULT;
+}
+
+static int mem_numa_local(void) {
+    const char *numa = getenv("MEM_NUMA");
+    return numa != NULL && strcmp(numa, "local") == 0;
+}
+
+//mapping length for a buffer of len bytes, 0 when it comes from the heap
+static size_t mem_map_length(size_t len) {
+    if (mem_pages_wanted(len) != PAGES_DEFAULT) {
+       return (len + MEM_HUGE_PAGE - 1) / MEM_HUGE_PAGE * MEM_HUGE_PAGE;
+    }
+    if (mem_numa_local()) {
+       size_t page = (size_t)sysconf(_SC_PAGESIZE);
+       return (len + page - 1) / page * page;
+    }
+    return 0;
+}
+
+static void mem_bind_local(void *addr, size_t len) {
+    unsigned cpu, node;
+    unsigned long mask[MEM_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) < 0 || node >= MEM_MAX_NODES) return;
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
 
-    long long arr_size = 64000000; // 256 MB
+    //maxnode counts one past the last bit the kernel should read
+    if (syscall(SYS_mbind, addr, len, MPOL_BIND, mask, MEM_MAX_NODES + 1, 0) < 0) {
+       fprintf(stderr, "mbind to node %u failed: %s\n", node, strerror(errno));
+    }
+}
+
+static void *mem_alloc(size_t len) {
+    size_t map_len = mem_map_length(len);
+    if (map_len == 0) {
+       return aligned_alloc(MEM_LINE, (len + MEM_LINE - 1) / MEM_LINE * MEM_LINE);
+    }
+
+    enum mem_pages pages = mem_pages_wanted(len);
+    int numa = mem_numa_local();
+    void *p = MAP_FAILED;
+
+    //the binding has to be in place before the pages are touched, so
+    //MAP_POPULATE is only used when there is none to apply
+    if (pages == PAGES_HUGETLB) {
+       p = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (numa ? 0 : MAP_POPULATE), -1, 0);
+       if (p == MAP_FAILED) {
+          fprintf(stderr, "MAP_HUGETLB failed: %s, using THP\n", strerror(errno));
+          pages = PAGES_THP;
+       }
+    }
+    if (p == MAP_FAILED && pages == PAGES_THP) {
+       //THP only backs 2 MB aligned ranges: over-map and trim
+       size_t span = map_len + MEM_HUGE_PAGE;
+       char *raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+       if (raw == MAP_FAILED) return NULL;
+       char *aligned = (char *)(((uintptr_t)raw + MEM_HUGE_PAGE - 1) / MEM_HUGE_PAGE * MEM_HUGE_PAGE);
+       if (aligned > raw) munmap(raw, aligned - raw);
+       munmap(aligned + map_len, raw + span - (aligned + map_len));
+       madvise(aligned, map_len, MADV_HUGEPAGE);
+       p = aligned;
+    }
+    else if (p == MAP_FAILED) {
+       p = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+       if (p == MAP_FAILED) return NULL;
+    }
+    else if (!numa) {
+       return p;  //hugetlb, already populated
+    }
 
-   //large array allocation
-    int *data_array = (int *)malloc(arr_size * sizeof(int));
+    if (numa) mem_bind_local(p, map_len);
+    if (madvise(p, map_len, MADV_POPULATE_WRITE) != 0) {
+       //pre-5.14 kernels: touch one byte per page
+       for (size_t off = 0; off < map_len; off += 4096) ((volatile char *)p)[off] = 0;
+    }
+    return p;
+}
 
-    if (data_array == NULL) {
+static void mem_free(void *p, size_t len) {
+    if (p == NULL) return;
+    size_t map_len = mem_map_length(len);
+    if (map_len) munmap(p, map_len);
+    else free(p);
+}
+
+static double elapsed_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//"64K", "8M", "1G" or plain bytes
+static long long parse_size(const char *text, long long fallback) {
+    if (text == NULL || *text == '\0') return fallback;
+    char *end;
+    long long value = strtoll(text, &end, 10);
+    switch (*end) {
+       case 'k': case 'K': value <<= 10; end++; break;
+       case 'm': case 'M': value <<= 20; end++; break;
+       case 'g': case 'G': value <<= 30; end++; break;
+    }
+    if (*end != '\0' || value <= 0) {
+       fprintf(stderr, "bad size '%s', using %lld\n", text, fallback);
+       return fallback;
+    }
+    return value;
+}
+
+static void mem_report(const char *mode, long long bytes, long long accesses,
+                       double moved, double elapsed) {
+    printf("MEM,%s,%lld,%lld,%.3f,%.2f,%.2f\n", mode, bytes, accesses, elapsed,
+           elapsed > 0 ? moved / elapsed / 1e9 : 0.0,
+           accesses > 0 ? elapsed * 1e9 / accesses : 0.0);
+}
+
+//passes needed so a kernel touches at least `limit` elements
+static long long mem_passes(long long limit, long long elements) {
+    long long passes = (limit + elements - 1) / elements;
+    return passes > 0 ? passes : 1;
+}
+
+static void mem_stream(long long limit, long long bytes) {
+    long long n = bytes / 3 / sizeof(double);
+    if (n < 1) n = 1;
+    size_t len = n * sizeof(double);
+    double *a = mem_alloc(len);
+    double *b = mem_alloc(len);
+    double *c = mem_alloc(len);
+    if (a == NULL || b == NULL || c == NULL) {
        printf("Memory allocation failed!\n");
+       mem_free(a, len); mem_free(b, len); mem_free(c, len);
        return;
     }
 
-   //initialise array to zeroes
-    memset(data_array, 0, arr_size * sizeof(int));
+    //first touch outside the timed kernels
+    for (long long i = 0; i < n; i++) {
+       a[i] = 1.0; b[i] = 2.0; c[i] = 0.0;
+    }
 
-    //used volatile to make sure cpu instructions are done regularly
-    volatile int sink = 0;
+    const double scalar = 3.0;
+    long long passes = mem_passes(limit, n);
+    struct timespec start;
 
-    //long limit to increase cycles
-    long long limit = input * 25000LL;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long long p = 0; p < passes; p++)
+       for (long long i = 0; i < n; i++) c[i] = a[i];
+    mem_report("stream-copy", 3 * n * sizeof(double), 2 * n * passes,
+               2.0 * sizeof(double) * n * passes, elapsed_since(&start));
 
-    //memory access work
-    for (long long i = 0; i < limit; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long long p = 0; p < passes; p++)
+       for (long long i = 0; i < n; i++) b[i] = scalar * c[i];
+    mem_report("stream-scale", 3 * n * sizeof(double), 2 * n * passes,
+               2.0 * sizeof(double) * n * passes, elapsed_since(&start));
 
-       //gets the data from RAM and updates
-       data_array[i % arr_size] += 1;
-       sink = data_array[i % arr_size];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long long p = 0; p < passes; p++)
+       for (long long i = 0; i < n; i++) a[i] = b[i] + scalar * c[i];
+    mem_report("stream-triad", 3 * n * sizeof(double), 3 * n * passes,
+               3.0 * sizeof(double) * n * passes, elapsed_since(&start));
+
+    //used volatile so the kernels' stores stay live
+    volatile double sink = a[n / 2] + b[n - 1] + c[0];
+    (void)sink;
+    mem_free(a, len); mem_free(b, len); mem_free(c, len);
+}
+
+static void mem_chase(long long limit, long long bytes) {
+    long long lines = bytes / MEM_LINE;
+    if (lines < 2) lines = 2;
+    char *base = mem_alloc(lines * MEM_LINE);
+    long long *order = malloc(lines * sizeof(long long));
+    if (base == NULL || order == NULL) {
+       printf("Memory allocation failed!\n");
+       mem_free(base, lines * MEM_LINE); free(order);
+       return;
     }
 
+    //Sattolo's shuffle gives one cycle through every line, so the walk
+    //never settles into a short loop the caches could hold
+    uint64_t seed = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)getpid() << 32) ^ (uint64_t)pthread_self();
+    for (long long i = 0; i < lines; i++) order[i] = i;
+    for (long long i = lines - 1; i > 0; i--) {
+       seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+       long long j = seed % i;
+       long long t = order[i]; order[i] = order[j]; order[j] = t;
+    }
+    for (long long i = 0; i < lines; i++) {
+       *(void **)(base + order[i] * MEM_LINE) = base + order[(i + 1) % lines] * MEM_LINE;
+    }
+    free(order);
+
+    //a dependent load is ~100x slower than a streamed one at DRAM size
+    long long steps = limit / 10;
+    void **p = (void **)base;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long long i = 0; i < steps; i++) p = (void **)*p;
+    double elapsed = elapsed_since(&start);
+
+    void *volatile sink = p;
     (void)sink;
-    //freeing up the memory
-    free(data_array);
+    mem_report("chase", lines * MEM_LINE, steps, (double)steps * sizeof(void *), elapsed);
+    mem_free(base, lines * MEM_LINE);
+}
+
+static void mem_stride(long long limit, long long bytes) {
+    long long stride = parse_size(getenv("MEM_STRIDE"), MEM_LINE) / sizeof(long long);
+    long long n = bytes / sizeof(long long);
+    if (stride < 1) stride = 1;
+    if (n < stride) n = stride;
+
+    long long *data = mem_alloc(n * sizeof(long long));
+    if (data == NULL) {
+       printf("Memory allocation failed!\n");
+       return;
+    }
+    for (long long i = 0; i < n; i++) data[i] = i;
+
+    //one pass reads every element, offset by offset, so each offset is a
+    //fresh walk over the whole array at the given stride
+    long long passes = mem_passes(limit, n);
+    long long sum = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long long p = 0; p < passes; p++)
+       for (long long off = 0; off < stride; off++)
+          for (long long i = off; i < n; i += stride) sum += data[i];
+    double elapsed = elapsed_since(&start);
+
+    volatile long long sink = sum;
+    (void)sink;
+
+    char mode[32];
+    snprintf(mode, sizeof(mode), "stride-%lld", stride * (long long)sizeof(long long));
+    mem_report(mode, n * sizeof(long long), n * passes, (double)n * passes * sizeof(long long), elapsed);
+    mem_free(data, n * sizeof(long long));
+}
+
+void mem(long long input) {
+
+    //long limit to increase cycles
+    long long limit = input * 25000LL;
+    long long bytes = parse_size(getenv("MEM_SIZE"), MEM_DEFAULT_SIZE);
+    const char *mode = getenv("MEM_MODE");
+
+    if (mode == NULL || strcmp(mode, "stream") == 0) {
+       mem_stream(limit, bytes);
+    }
+    else if (strcmp(mode, "chase") == 0) {
+       mem_chase(limit, bytes);
+    }
+    else if (strcmp(mode, "stride") == 0) {
+       mem_stride(limit, bytes);
+    }
+    else {
+       fprintf(stderr, "MEM_MODE=%s: unknown (stream, chase or stride)\n", mode);
+    }
 }
 
 // ---------------------------------------------------------
 // IO TASK
+//
+// Each worker writes input * 10 * 4 KB (320 MB by default) to its own file in
+// IO_DIR (default /tmp) in IO_BLOCK sized pieces (default 4K). IO_MODE picks
+// how the writes reach the kernel:
+//   buffered - pwrite() into the page cache, fsync every 1000 ops (default)
+//   direct   - pwrite() with O_DIRECT from page-aligned buffers
+//   pwritev  - IO_DEPTH adjacent blocks per pwritev() call (default 32)
+//   uring    - io_uring, IO_DEPTH writes in flight
+// IO_PATTERN=random writes every block once in shuffled order (seq is the
+// default), IO_DIRECT=1 adds O_DIRECT to pwritev and uring, and IO_READ=1
+// reads the file back the same way after dropping it from the page cache.
+// Each phase ends with fsync() inside the timed region and prints
+//   "IO,<mode>,<write|read>,<block>,<ops>,<seconds>,<mb_per_s>,<ops_per_s>,
+//    <p50_us>,<p99_us>,<p99_9_us>,<max_us>"
+// where an op is one syscall (one pwritev batch) or one io_uring request.
+
+#define IO_ALIGN 4096
+#define IO_FSYNC_EVERY 1000
+
+enum io_mode { IO_BUFFERED, IO_DIRECT, IO_PWRITEV, IO_URING };
+
+static const char *io_mode_names[] = { "buffered", "direct", "pwritev", "uring" };
+
+struct io_job {
+    int fd;
+    enum io_mode mode;
+    const char *label;        //mode name as printed (direct may have fallen back)
+    size_t block;
+    int depth;                //pwritev batch / io_uring queue depth
+    long long blocks;         //file size in blocks
+    long long units;          //ops per phase
+    int per_unit;             //blocks per op: depth for pwritev, else 1
+    long long *order;         //op i covers unit order[i]
+    char **bufs;              //depth aligned buffers of one block each
+    uint64_t *lat_ns;         //per op latency of the current phase
+    int failed;               //a phase stopped early: skip the rest of the job
+    int bufs_busy;            //io_uring requests could not be waited out: never free bufs
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_us(const uint64_t *sorted, long long n, double p) {
+    if (n == 0) return 0.0;
+    long long idx = (long long)(p * n + 0.999999) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= n) idx = n - 1;
+    return sorted[idx] / 1000.0;
+}
+
+static void io_report(struct io_job *job, const char *phase, long long ops, double elapsed) {
+    qsort(job->lat_ns, ops, sizeof(uint64_t), cmp_u64);
+    //a failed phase reports only what completed
+    long long blocks = ops * job->per_unit < job->blocks ? ops * job->per_unit : job->blocks;
+    double bytes = (double)blocks * job->block;
+    printf("IO,%s,%s,%zu,%lld,%.3f,%.1f,%.0f,%.1f,%.1f,%.1f,%.1f\n",
+           job->label, phase, job->block, ops, elapsed,
+           elapsed > 0 ? bytes / elapsed / 1e6 : 0.0,
+           elapsed > 0 ? ops / elapsed : 0.0,
+           percentile_us(job->lat_ns, ops, 0.50), percentile_us(job->lat_ns, ops, 0.99),
+           percentile_us(job->lat_ns, ops, 0.999), ops > 0 ? job->lat_ns[ops - 1] / 1000.0 : 0.0);
+}
+
+//first block and block count of op i
+static long long io_unit_span(const struct io_job *job, long long i, int *count) {
+    long long first = job->order[i] * job->per_unit;
+    long long left = job->blocks - first;
+    *count = left < job->per_unit ? (int)left : job->per_unit;
+    return first;
+}
+
+//pwrite / pread / pwritev / preadv, one op per loop
+static long long io_sync_phase(struct io_job *job, int reading) {
+    struct iovec iov[job->per_unit];
+    for (long long i = 0; i < job->units; i++) {
+       int count;
+       off_t off = (off_t)io_unit_span(job, i, &count) * job->block;
+       size_t want = (size_t)count * job->block;
+       uint64_t start = now_ns();
+       ssize_t done;
+
+       if (job->mode == IO_PWRITEV) {
+          for (int k = 0; k < count; k++) {
+             iov[k].iov_base = job->bufs[k];
+             iov[k].iov_len = job->block;
+          }
+          done = reading ? preadv(job->fd, iov, count, off) : pwritev(job->fd, iov, count, off);
+       }
+       else {
+          done = reading ? pread(job->fd, job->bufs[0], want, off) : pwrite(job->fd, job->bufs[0], want, off);
+       }
+       // Sync every 1000 ops, as before, so the page cache cannot soak up the whole run
+       if (!reading && job->mode == IO_BUFFERED && i % IO_FSYNC_EVERY == 0) fsync(job->fd);
+       job->lat_ns[i] = now_ns() - start;
+
+       if (done != (ssize_t)want) {
+          fprintf(stderr, "io %s: %s at offset %lld\n", reading ? "read" : "write",
+                  done < 0 ? strerror(errno) : "short transfer", (long long)off);
+          job->failed = 1;
+          return i;
+       }
+    }
+    return job->units;
+}
+
+//a phase that stops early still has requests in flight that point into
+//job->bufs: waits for every one the kernel has taken (SQEs it has not taken
+//are never submitted, since the job ends with this phase)
+static void io_uring_drain(struct io_job *job, struct io_ring *ring, long long queued) {
+    long long in_flight = queued - (ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE));
+    uint64_t slot;
+    int res;
+    for (;;) {
+       while (in_flight > 0 && io_ring_peek(ring, &slot, &res)) in_flight--;
+       if (in_flight <= 0) return;
+       if (io_ring_submit(ring, 1) < 0) {
+          fprintf(stderr, "io_uring_enter: %s, %lld requests left in flight\n", strerror(errno), in_flight);
+          job->bufs_busy = 1;
+          return;
+       }
+    }
+}
+
+//keeps depth requests in flight; each slot owns one buffer
+static long long io_uring_phase(struct io_job *job, struct io_ring *ring, int reading) {
+    uint64_t slot_start[job->depth];
+    int free_slots[job->depth];
+    int nfree = job->depth;
+    for (int k = 0; k < job->depth; k++) free_slots[k] = k;
+
+    long long next = 0, completed = 0;
+    while (completed < job->units) {
+       while (next < job->units && nfree > 0) {
+          struct io_uring_sqe *sqe = io_ring_get_sqe(ring);
+          if (sqe == NULL) break;
+          int slot = free_slots[--nfree];
+          sqe->opcode = reading ? IORING_OP_READ : IORING_OP_WRITE;
+          sqe->fd = job->fd;
+          sqe->addr = (uint64_t)(uintptr_t)job->bufs[slot];
+          sqe->len = job->block;
+          sqe->off = (uint64_t)job->order[next] * job->block;
+          sqe->user_data = slot;
+          slot_start[slot] = now_ns();
+          next++;
+       }
+       if (io_ring_submit(ring, 1) < 0) {
+          fprintf(stderr, "io_uring_enter: %s\n", strerror(errno));
+          job->failed = 1;
+          io_uring_drain(job, ring, next - completed);
+          return completed;
+       }
+
+       uint64_t slot;
+       int res;
+       while (io_ring_peek(ring, &slot, &res)) {
+          job->lat_ns[completed++] = now_ns() - slot_start[slot];
+          free_slots[nfree++] = (int)slot;
+          if (res != (int)job->block) {
+             fprintf(stderr, "io_uring %s: %s\n", reading ? "read" : "write",
+                     res < 0 ? strerror(-res) : "short transfer");
+             job->failed = 1;
+             io_uring_drain(job, ring, next - completed);
+             return completed;
+          }
+       }
+    }
+    return completed;
+}
+
+static void io_phase(struct io_job *job, struct io_ring *ring, int reading) {
+    uint64_t start = now_ns();
+    long long ops = job->mode == IO_URING ? io_uring_phase(job, ring, reading)
+                                          : io_sync_phase(job, reading);
+    if (!reading) fsync(job->fd);
+    io_report(job, reading ? "read" : "write", ops, (now_ns() - start) / 1e9);
+}
+
+static int env_flag(const char *name) {
+    const char *v = getenv(name);
+    return v != NULL && strcmp(v, "1") == 0;
+}
 
 void io(long long input) {
 
-    char fname[100];
-    char temp[4096]; // 4KB buffer
-    //initialising the memory
-    memset(temp, 'A', sizeof(temp));
+    struct io_job job;
+    memset(&job, 0, sizeof(job));
+    job.block = (size_t)parse_size(getenv("IO_BLOCK"), 4096);
+    job.depth = (int)parse_size(getenv("IO_DEPTH"), 32);
+    if (job.depth > 1024) job.depth = 1024;   //IOV_MAX
+
+    const char *mode = getenv("IO_MODE");
+    job.mode = IO_BUFFERED;
+    for (int m = 0; mode != NULL && m <= IO_URING; m++) {
+       if (strcmp(mode, io_mode_names[m]) == 0) job.mode = m;
+    }
+    if (mode != NULL && strcmp(mode, io_mode_names[job.mode]) != 0) {
+       fprintf(stderr, "IO_MODE=%s: unknown (buffered, direct, pwritev or uring), using buffered\n", mode);
+    }
+    job.label = io_mode_names[job.mode];
+
+    // 80,000 * 4KB = 320 MB Total Write at the default input
+    long long total = input * 10 * 4096LL;
+    job.blocks = total / (long long)job.block;
+    if (job.blocks < 1) job.blocks = 1;
+    job.per_unit = job.mode == IO_PWRITEV ? job.depth : 1;
+    job.units = (job.blocks + job.per_unit - 1) / job.per_unit;
+    int nbufs = job.mode == IO_PWRITEV || job.mode == IO_URING ? job.depth : 1;
 
+    job.order = malloc(job.units * sizeof(long long));
+    job.lat_ns = malloc(job.units * sizeof(uint64_t));
+    job.bufs = calloc(nbufs, sizeof(char *));
+    int ok = job.order != NULL && job.lat_ns != NULL && job.bufs != NULL;
+    for (int k = 0; ok && k < nbufs; k++) {
+       //aligned for O_DIRECT, filled so the device sees real data
+       if (posix_memalign((void **)&job.bufs[k], IO_ALIGN, job.block) != 0) ok = 0;
+       else memset(job.bufs[k], 'A', job.block);
+    }
+
+    //sequential, or every unit once in shuffled order
+    const char *pattern = getenv("IO_PATTERN");
+    int random_order = pattern != NULL && strcmp(pattern, "random") == 0;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)getpid() << 32) ^ (uint64_t)pthread_self();
+    for (long long i = 0; ok && i < job.units; i++) job.order[i] = i;
+    for (long long i = job.units - 1; ok && random_order && i > 0; i--) {
+       seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+       long long j = seed % (i + 1);
+       long long t = job.order[i]; job.order[i] = job.order[j]; job.order[j] = t;
+    }
+
+    char fname[256];
+    const char *dir = getenv("IO_DIR");
     unsigned long tid = (unsigned long)pthread_self();
     //  using /tmp/ to use the disk
-    snprintf(fname, sizeof(fname), "/tmp/MT25074_IO_P%d_T%lu.txt", getpid(), tid);
+    snprintf(fname, sizeof(fname), "%s/MT25074_IO_P%d_T%lu.txt", dir ? dir : "/tmp", getpid(), tid);
+
+    int direct = job.mode == IO_DIRECT || ((job.mode == IO_PWRITEV || job.mode == IO_URING) && env_flag("IO_DIRECT"));
+    job.fd = -1;
+    if (ok) {
+       job.fd = open(fname, O_RDWR | O_CREAT | O_TRUNC | (direct ? O_DIRECT : 0), 0644);
+       if (job.fd < 0 && direct && errno == EINVAL) {
+          //tmpfs and some overlay filesystems refuse O_DIRECT
+          fprintf(stderr, "O_DIRECT not supported in %s, writing through the page cache\n", dir ? dir : "/tmp");
+          job.fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+          job.label = job.mode == IO_DIRECT ? "direct-cached" : job.label;
+       }
+       if (job.fd < 0) fprintf(stderr, "open %s: %s\n", fname, strerror(errno));
+    }
 
-    FILE *filePointer = fopen(fname, "w");
-    if (filePointer == NULL) return;
+    struct io_ring ring;
+    int have_ring = 0;
+    if (job.fd >= 0 && job.mode == IO_URING) {
+       have_ring = io_ring_init(&ring, (unsigned)job.depth) == 0;
+       if (!have_ring) fprintf(stderr, "io_uring_setup: %s\n", strerror(errno));
+    }
+
+    if (job.fd >= 0 && (job.mode != IO_URING || have_ring)) {
+       io_phase(&job, &ring, 0);
+       if (env_flag("IO_READ") && !job.failed) {
+          //drop the cached copy so the read phase goes to the device too
+          posix_fadvise(job.fd, 0, 0, POSIX_FADV_DONTNEED);
+          io_phase(&job, &ring, 1);
+       }
+    }
+
+    //close and delete the file
+    if (have_ring) io_ring_exit(&ring);
+    if (job.fd >= 0) {
+       close(job.fd);
+       unlink(fname);
+    }
+    //leaked rather than freed under a request the kernel may still complete
+    for (int k = 0; job.bufs != NULL && !job.bufs_busy && k < nbufs; k++) free(job.bufs[k]);
+    if (!job.bufs_busy) free(job.bufs);
+    free(job.order);
+    free(job.lat_ns);
+}
+
+// ---------------------------------------------------------
+// CHUNKED JOBS
+//
+// The same three workloads cut into units that any thread can run, in any
+// order, for the work-stealing runtime (MT25074_Part_B_Runtime.c). A job is
+// as much work as one cpu() / mem() / io() call with the same input:
+//   cpu - one unit is one i of sin(i) * cos(i), on the CPU_ENGINE path
+//   mem - one unit is one element of a dot product over two arrays of
+//         MEM_SIZE / 2 (read only, so two chunks never race on a store)
+//   io  - one unit is one IO_BLOCK block of the job's 320 MB file, written
+//         with pwrite() (O_DIRECT with IO_MODE=direct); finishing the job
+//         fsyncs the file
+
+enum work_kind { WORK_CPU, WORK_MEM, WORK_IO };
 
+static const char *work_kind_names[] = { "cpu", "mem", "io" };
 
-    // 80,000 * 4KB = 320 MB Total Write.
-    long long adjusted_input = input * 10;
+struct work_job {
+    enum work_kind kind;
+    long long units;
+    int engine;                 //cpu
+    double *a, *b;              //mem
+    long long elements;         //mem: per array
+    int fd;                     //io
+    size_t block;
+    char *buf;
+    char path[256];
+};
 
-    for (long long i = 0; i < adjusted_input; i++) {
-       fwrite(temp, 1, sizeof(temp), filePointer);
+static atomic_int work_job_ids;
 
-       // Sync less often (Every 1000 instead of 500)
-       // This allows the OS to buffer more, increasing the KB/s speed
-       // seen by iostat when it finally flushes.
-       if (i % 1000 == 0) {
-          fsync(fileno(filePointer));
+static int work_job_open_file(struct work_job *job) {
+    const char *dir = getenv("IO_DIR");
+    const char *mode = getenv("IO_MODE");
+    int direct = mode != NULL && strcmp(mode, "direct") == 0;
+    snprintf(job->path, sizeof(job->path), "%s/MT25074_IO_P%d_J%d.txt", dir ? dir : "/tmp",
+             getpid(), atomic_fetch_add(&work_job_ids, 1));
+
+    job->fd = open(job->path, O_RDWR | O_CREAT | O_TRUNC | (direct ? O_DIRECT : 0), 0644);
+    if (job->fd < 0 && direct && errno == EINVAL) {
+       job->fd = open(job->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    if (job->fd < 0) fprintf(stderr, "open %s: %s\n", job->path, strerror(errno));
+    return job->fd >= 0;
+}
+
+struct work_job *work_job_create(const char *task, long long input) {
+    struct work_job *job = calloc(1, sizeof(*job));
+    if (job == NULL) return NULL;
+    job->fd = -1;
+
+    int ok = 1;
+    if (strcmp(task, "cpu") == 0) {
+       job->kind = WORK_CPU;
+       job->units = input * 15000LL;
+       job->engine = cpu_pick_engine();
+    }
+    else if (strcmp(task, "mem") == 0) {
+       job->kind = WORK_MEM;
+       long long bytes = parse_size(getenv("MEM_SIZE"), MEM_DEFAULT_SIZE);
+       job->elements = bytes / 2 / sizeof(double);
+       if (job->elements < 1) job->elements = 1;
+       job->units = job->elements * mem_passes(input * 25000LL, job->elements);
+       job->a = mem_alloc(job->elements * sizeof(double));
+       job->b = mem_alloc(job->elements * sizeof(double));
+       ok = job->a != NULL && job->b != NULL;
+       //first touch outside the timed chunks
+       for (long long i = 0; ok && i < job->elements; i++) {
+          job->a[i] = 1.0; job->b[i] = 2.0;
        }
     }
-    //close and delete the file
-    fclose(filePointer);
-    unlink(fname);
-}
\ No newline at end of file
+    else if (strcmp(task, "io") == 0) {
+       job->kind = WORK_IO;
+       job->block = (size_t)parse_size(getenv("IO_BLOCK"), 4096);
+       job->units = input * 10 * 4096LL / (long long)job->block;
+       if (job->units < 1) job->units = 1;
+       ok = posix_memalign((void **)&job->buf, IO_ALIGN, job->block) == 0;
+       if (ok) memset(job->buf, 'A', job->block);
+       ok = ok && work_job_open_file(job);
+    }
+    else {
+       fprintf(stderr, "Error: Unknown task '%s'\n", task);
+       ok = 0;
+    }
+
+    if (!ok) {
+       work_job_destroy(job);
+       return NULL;
+    }
+    return job;
+}
+
+long long work_job_units(const struct work_job *job) {
+    return job->units;
+}
+
+const char *work_job_name(const struct work_job *job) {
+    return work_kind_names[job->kind];
+}
+
+double work_job_run(struct work_job *job, long long begin, long long end) {
+    if (job->kind == WORK_CPU) {
+       return cpu_engines[job->engine].run(begin, end);
+    }
+
+    if (job->kind == WORK_MEM) {
+       //unit u is element u % elements of pass u / elements
+       double acc[CPU_ACCUMULATORS] = {0};
+       for (long long u = begin; u < end; ) {
+          long long i = u % job->elements;
+          long long stop = i + (end - u) < job->elements ? i + (end - u) : job->elements;
+          u += stop - i;
+          for (; i + CPU_ACCUMULATORS <= stop; i += CPU_ACCUMULATORS) {
+             for (int k = 0; k < CPU_ACCUMULATORS; k++) acc[k] += job->a[i + k] * job->b[i + k];
+          }
+          for (; i < stop; i++) acc[0] += job->a[i] * job->b[i];
+       }
+       double sum = 0.0;
+       for (int k = 0; k < CPU_ACCUMULATORS; k++) sum += acc[k];
+       return sum;
+    }
+
+    for (long long u = begin; u < end; u++) {
+       if (pwrite(job->fd, job->buf, job->block, (off_t)u * job->block) != (ssize_t)job->block) {
+          fprintf(stderr, "io write: %s at block %lld\n", strerror(errno), u);
+          return (double)(u - begin);
+       }
+    }
+    return (double)(end - begin);
+}
+
+void work_job_finish(struct work_job *job) {
+    if (job->kind == WORK_IO) fsync(job->fd);
+}
+
+void work_job_destroy(struct work_job *job) {
+    if (job == NULL) return;
+    mem_free(job->a, job->elements * sizeof(double));
+    mem_free(job->b, job->elements * sizeof(double));
+    if (job->fd >= 0) {
+       close(job->fd);
+       unlink(job->path);
+    }
+    free(job->buf);
+    free(job);
+}
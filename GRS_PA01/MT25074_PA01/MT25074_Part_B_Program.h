@@ -5,4 +5,14 @@ void cpu(long long input);
 void mem(long long input);
 void io(long long input);
 
+//chunked form of the workers for the work-stealing runtime: a job covers
+//units [0, units) and any sub-range can run on any thread, in any order
+struct work_job;
+struct work_job *work_job_create(const char *task, long long input);
+long long work_job_units(const struct work_job *job);
+const char *work_job_name(const struct work_job *job);
+double work_job_run(struct work_job *job, long long begin, long long end);  //returns a partial checksum
+void work_job_finish(struct work_job *job);   //once, after the last unit
+void work_job_destroy(struct work_job *job);
+
 #endif
@@ -0,0 +1,389 @@
+#define _GNU_SOURCE  // pthread_attr_setaffinity_np
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "MT25074_Part_B_Program.h"
+#include "MT25074_Part_B_Runtime.h"
+
+// ---------------------------------------------------------
+// WORK-STEALING RUNTIME
+//
+// A fixed pool of WS_WORKERS threads (default: one per CPU we may run on),
+// each pinned to its own CPU and owning a Chase-Lev deque of tasks. A task
+// is a range of one job's units. A worker takes tasks from the bottom of its
+// own deque; while a task is bigger than the grain (job units / WS_CHUNKS,
+// default 64 chunks per job) it pushes the upper half back and keeps the
+// lower half, so the biggest pieces sit at the top, where an idle worker
+// steals from a random victim.
+// WS_SEED decides where each job starts:
+//   job    - job j on worker j % workers, like one thread per job (default)
+//   single - every job on worker 0, the others only get what they steal
+// Output, with times counted from the start of the batch:
+//   WS,job,<id>,<task>,<units>,<chunks>,<start_s>,<done_s>,<checksum>
+//   WS,worker,<id>,<cpu>,<chunks>,<steals>,<busy_s>,<idle_s>
+//   WS,summary,<workers>,<jobs>,<makespan_s>,<p50_done_s>,<p99_done_s>,<imbalance>
+// where imbalance is the busiest worker's busy time over the mean.
+
+#define WS_CACHE_LINE 64
+#define WS_MAX_KINDS 8
+#define WS_SPLIT_DEPTH 64         //a range halves at most this often
+#define WS_ABORT ((struct ws_task *)1)
+
+struct ws_task {
+    struct ws_job *job;
+    long long begin, end;
+};
+
+struct ws_job {
+    struct work_job *work;
+    long long grain;
+    _Atomic long long units_left;
+    _Atomic double checksum;
+    _Atomic int chunks;
+    _Atomic uint64_t start_ns;    //0 until the first chunk runs
+    uint64_t done_ns;
+
+    //every task of the job comes from here; splitting stops if it runs out
+    struct ws_task *tasks;
+    int max_tasks;
+    _Atomic int next_task;
+};
+
+//Chase-Lev deque with a fixed ring: the owner pushes and pops at the bottom,
+//thieves take from the top (Le et al., "Correct and Efficient Work-Stealing
+//for Weak Memory Models", PPoPP 2013)
+struct ws_deque {
+    _Alignas(WS_CACHE_LINE) _Atomic long top;
+    _Alignas(WS_CACHE_LINE) _Atomic long bottom;
+    _Atomic(struct ws_task *) *buf;
+    long mask;
+};
+
+struct ws_pool;
+
+struct ws_worker {
+    struct ws_deque deque;
+    struct ws_pool *pool;
+    pthread_t thread;
+    int id, cpu;
+    uint64_t rng;
+    long chunks, steals;
+    uint64_t busy_ns, life_ns;
+};
+
+struct ws_pool {
+    struct ws_worker *workers;
+    int nworkers;
+    _Atomic int jobs_left;
+    uint64_t t0;
+};
+
+static uint64_t ws_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// ---------------------------------------------------------
+// DEQUE
+
+static int deque_init(struct ws_deque *d, long capacity) {
+    long size = 1;
+    while (size < capacity) size <<= 1;
+    d->buf = calloc(size, sizeof(*d->buf));
+    d->mask = size - 1;
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    return d->buf != NULL;
+}
+
+//owner only; returns 0 when the ring is full
+static int deque_push(struct ws_deque *d, struct ws_task *t) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - top > d->mask) return 0;
+    atomic_store_explicit(&d->buf[b & d->mask], t, memory_order_relaxed);
+    //release: a thief that sees the new bottom also sees the task's fields
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return 1;
+}
+
+//owner only; the newest task, or NULL
+static struct ws_task *deque_pop(struct ws_deque *d) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {   //empty
+       atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+       return NULL;
+    }
+    struct ws_task *x = atomic_load_explicit(&d->buf[b & d->mask], memory_order_relaxed);
+    if (t == b) {
+       //last one: race the thieves for it
+       if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                    memory_order_seq_cst, memory_order_relaxed)) x = NULL;
+       atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return x;
+}
+
+//any thread; the oldest task, NULL when empty, WS_ABORT when another thread won
+static struct ws_task *deque_steal(struct ws_deque *d) {
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+
+    struct ws_task *x = atomic_load_explicit(&d->buf[t & d->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) return WS_ABORT;
+    return x;
+}
+
+// ---------------------------------------------------------
+// WORKERS
+
+static struct ws_task *task_alloc(struct ws_job *job) {
+    int i = atomic_fetch_add_explicit(&job->next_task, 1, memory_order_relaxed);
+    return i < job->max_tasks ? &job->tasks[i] : NULL;
+}
+
+static struct ws_task *ws_steal(struct ws_worker *w) {
+    int n = w->pool->nworkers;
+    for (int attempt = 0; n > 1 && attempt < 2 * n; attempt++) {
+       w->rng ^= w->rng << 13; w->rng ^= w->rng >> 7; w->rng ^= w->rng << 17;
+       int victim = (int)(w->rng % n);
+       if (victim == w->id) continue;
+
+       struct ws_task *t = deque_steal(&w->pool->workers[victim].deque);
+       if (t != NULL && t != WS_ABORT) {
+          w->steals++;
+          return t;
+       }
+    }
+    return NULL;
+}
+
+static void ws_execute(struct ws_worker *w, struct ws_task *t) {
+    struct ws_job *job = t->job;
+    uint64_t start = ws_now_ns();
+    uint64_t unset = 0;
+    atomic_compare_exchange_strong(&job->start_ns, &unset, start);
+
+    //upper halves go back on our deque for whoever runs out of work first
+    while (t->end - t->begin > job->grain) {
+       struct ws_task *half = task_alloc(job);
+       if (half == NULL) break;
+       long long mid = t->begin + (t->end - t->begin) / 2;
+       half->job = job;
+       half->begin = mid;
+       half->end = t->end;
+       if (!deque_push(&w->deque, half)) break;
+       t->end = mid;
+    }
+
+    double part = work_job_run(job->work, t->begin, t->end);
+    double sum = atomic_load_explicit(&job->checksum, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&job->checksum, &sum, sum + part,
+                                                  memory_order_relaxed, memory_order_relaxed));
+    atomic_fetch_add_explicit(&job->chunks, 1, memory_order_relaxed);
+    w->chunks++;
+
+    long long n = t->end - t->begin;
+    if (atomic_fetch_sub_explicit(&job->units_left, n, memory_order_acq_rel) == n) {
+       work_job_finish(job->work);
+       job->done_ns = ws_now_ns();
+       atomic_fetch_sub_explicit(&w->pool->jobs_left, 1, memory_order_release);
+    }
+    w->busy_ns += ws_now_ns() - start;
+}
+
+static void *ws_worker_main(void *arg) {
+    struct ws_worker *w = arg;
+    while (atomic_load_explicit(&w->pool->jobs_left, memory_order_acquire) > 0) {
+       struct ws_task *t = deque_pop(&w->deque);
+       if (t == NULL) t = ws_steal(w);
+       if (t == NULL) {
+          //nothing anywhere right now; let a descheduled owner run if we share its CPU
+          sched_yield();
+          continue;
+       }
+       ws_execute(w, t);
+    }
+    w->life_ns = ws_now_ns() - w->pool->t0;
+    return NULL;
+}
+
+// ---------------------------------------------------------
+// BATCH
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+//CPUs this process may run on, in order; returns how many
+static int allowed_cpus(int *cpus, int max) {
+    cpu_set_t set;
+    int n = 0;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return 0;
+    for (int c = 0; c < CPU_SETSIZE && n < max; c++) {
+       if (CPU_ISSET(c, &set)) cpus[n++] = c;
+    }
+    return n;
+}
+
+static void ws_report(struct ws_pool *pool, struct ws_job *jobs, int njobs) {
+    double *done = malloc(njobs * sizeof(double));
+    double makespan = 0.0;
+
+    for (int j = 0; j < njobs; j++) {
+       uint64_t start = atomic_load(&jobs[j].start_ns);
+       done[j] = (jobs[j].done_ns - pool->t0) / 1e9;
+       if (done[j] > makespan) makespan = done[j];
+       printf("WS,job,%d,%s,%lld,%d,%.3f,%.3f,%.6f\n", j, work_job_name(jobs[j].work),
+              work_job_units(jobs[j].work), atomic_load(&jobs[j].chunks),
+              start ? (start - pool->t0) / 1e9 : 0.0, done[j], atomic_load(&jobs[j].checksum));
+    }
+
+    double busy_max = 0.0, busy_sum = 0.0;
+    for (int i = 0; i < pool->nworkers; i++) {
+       struct ws_worker *w = &pool->workers[i];
+       double busy = w->busy_ns / 1e9;
+       busy_sum += busy;
+       if (busy > busy_max) busy_max = busy;
+       printf("WS,worker,%d,%d,%ld,%ld,%.3f,%.3f\n", w->id, w->cpu, w->chunks, w->steals,
+              busy, w->life_ns / 1e9 - busy);
+    }
+
+    qsort(done, njobs, sizeof(double), cmp_double);
+    long p50 = (long)(0.50 * njobs + 0.999999) - 1;
+    long p99 = (long)(0.99 * njobs + 0.999999) - 1;
+    printf("WS,summary,%d,%d,%.3f,%.3f,%.3f,%.2f\n", pool->nworkers, njobs, makespan,
+           done[p50 < 0 ? 0 : p50], done[p99 < 0 ? 0 : p99],
+           busy_sum > 0 ? busy_max * pool->nworkers / busy_sum : 0.0);
+    free(done);
+}
+
+int ws_run(const char *tasks, int count, long long input) {
+
+    //"cpu+mem+io" -> task names
+    char list[128];
+    char *kinds[WS_MAX_KINDS];
+    int nkinds = 0;
+    snprintf(list, sizeof(list), "%s", tasks);
+    char *save;
+    for (char *tok = strtok_r(list, "+", &save); tok && nkinds < WS_MAX_KINDS; tok = strtok_r(NULL, "+", &save)) {
+       kinds[nkinds++] = tok;
+    }
+    if (nkinds == 0 || count < 1) {
+       fprintf(stderr, "Error: nothing to run\n");
+       return -1;
+    }
+
+    const char *env = getenv("WS_CHUNKS");
+    long long chunks = env ? atoll(env) : 64;
+    if (chunks < 1) chunks = 1;
+    env = getenv("WS_SEED");
+    int seed_single = env != NULL && strcmp(env, "single") == 0;
+
+    int cpus[CPU_SETSIZE];
+    int ncpus = allowed_cpus(cpus, CPU_SETSIZE);
+    if (ncpus == 0) cpus[ncpus++] = 0;
+    env = getenv("WS_WORKERS");
+    int nworkers = env ? atoi(env) : ncpus;
+    if (nworkers < 1) nworkers = 1;
+
+    //jobs interleaved by type: cpu, mem, io, cpu, mem, io, ...
+    int njobs = count * nkinds;
+    struct ws_job *jobs = calloc(njobs, sizeof(*jobs));
+    struct ws_pool pool = { 0 };
+    pool.nworkers = nworkers;
+    pool.workers = aligned_alloc(WS_CACHE_LINE, nworkers * sizeof(struct ws_worker));
+    int ok = jobs != NULL && pool.workers != NULL;
+    if (pool.workers != NULL) memset(pool.workers, 0, nworkers * sizeof(struct ws_worker));
+
+    for (int j = 0; ok && j < njobs; j++) {
+       struct ws_job *job = &jobs[j];
+       job->work = work_job_create(kinds[j % nkinds], input);
+       if (job->work == NULL) {
+          ok = 0;
+          break;
+       }
+       long long units = work_job_units(job->work);
+       job->grain = (units + chunks - 1) / chunks;
+       job->max_tasks = 2 * (int)((units + job->grain - 1) / job->grain) + 1;
+       job->tasks = calloc(job->max_tasks, sizeof(struct ws_task));
+       ok = job->tasks != NULL;
+       atomic_init(&job->units_left, units);
+       atomic_init(&job->checksum, 0.0);
+       atomic_init(&job->chunks, 0);
+       atomic_init(&job->start_ns, 0);
+       atomic_init(&job->next_task, 0);
+    }
+
+    if (ok) {
+       for (int i = 0; ok && i < nworkers; i++) {
+          struct ws_worker *w = &pool.workers[i];
+          w->pool = &pool;
+          w->id = i;
+          w->cpu = cpus[i % ncpus];
+          w->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+          ok = deque_init(&w->deque, njobs + WS_SPLIT_DEPTH + 1);
+       }
+    }
+
+    if (ok) {
+       //each job starts as one task covering all its units
+       for (int j = 0; j < njobs; j++) {
+          struct ws_task *t = task_alloc(&jobs[j]);
+          t->job = &jobs[j];
+          t->begin = 0;
+          t->end = work_job_units(jobs[j].work);
+          deque_push(&pool.workers[seed_single ? 0 : j % nworkers].deque, t);
+       }
+       atomic_init(&pool.jobs_left, njobs);
+
+       printf("work-stealing runtime: %d workers, %d jobs (%s x %d), %lld chunks per job, seed %s\n",
+              nworkers, njobs, tasks, count, chunks, seed_single ? "single" : "job");
+       pool.t0 = ws_now_ns();
+       int started = 0;
+       for (; started < nworkers; started++) {
+          pthread_attr_t attr;
+          cpu_set_t set;
+          pthread_attr_init(&attr);
+          CPU_ZERO(&set);
+          CPU_SET(pool.workers[started].cpu, &set);
+          pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+          int rc = pthread_create(&pool.workers[started].thread, &attr, ws_worker_main, &pool.workers[started]);
+          pthread_attr_destroy(&attr);
+          if (rc != 0) {
+             perror("Failed to create thread");
+             break;
+          }
+       }
+       //whoever did start still drains every deque by stealing
+       for (int i = 0; i < started; i++) pthread_join(pool.workers[i].thread, NULL);
+       ok = started > 0;
+       if (ok) {
+          pool.nworkers = started;
+          ws_report(&pool, jobs, njobs);
+       }
+    }
+
+    for (int j = 0; jobs != NULL && j < njobs; j++) {
+       work_job_destroy(jobs[j].work);
+       free(jobs[j].tasks);
+    }
+    for (int i = 0; pool.workers != NULL && i < nworkers; i++) free(pool.workers[i].deque.buf);
+    free(pool.workers);
+    free(jobs);
+    return ok ? 0 : -1;
+}
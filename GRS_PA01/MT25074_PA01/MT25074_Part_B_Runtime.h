@@ -0,0 +1,9 @@
+#ifndef RUNTIME_H //work-stealing task runtime for the thread driver
+#define RUNTIME_H
+
+//runs `count` jobs of every task in `tasks` ("cpu", "mem+io", "cpu+mem+io", ...)
+//on a pool of pinned workers with work-stealing deques; returns 0, or -1 if a
+//job could not be set up
+int ws_run(const char *tasks, int count, long long input);
+
+#endif
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "MT25074_Part_B_Uring.h"
+
+// ---------------------------------------------------------
+// RING SETUP (the same steps liburing takes)
+
+int io_ring_init(struct io_ring *r, unsigned entries) {
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+
+    r->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->ring_fd < 0) return -1;
+    r->entries = p.sq_entries;
+
+    r->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+       if (r->cq_size > r->sq_size) r->sq_size = r->cq_size;
+       r->cq_size = r->sq_size;
+    }
+
+    r->sq_ptr = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     r->ring_fd, IORING_OFF_SQ_RING);
+    r->cq_ptr = single_mmap ? r->sq_ptr
+                            : mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                   r->ring_fd, IORING_OFF_CQ_RING);
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->ring_fd, IORING_OFF_SQES);
+
+    if (r->sq_ptr == MAP_FAILED || r->cq_ptr == MAP_FAILED || r->sqes == MAP_FAILED) {
+       int saved = errno;
+       if (r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_size);
+       if (!single_mmap && r->cq_ptr != MAP_FAILED) munmap(r->cq_ptr, r->cq_size);
+       if (r->sq_ptr != MAP_FAILED) munmap(r->sq_ptr, r->sq_size);
+       close(r->ring_fd);
+       errno = saved;
+       return -1;
+    }
+
+    char *sq = r->sq_ptr, *cq = r->cq_ptr;
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->sq_local_tail = *r->sq_tail;
+    return 0;
+}
+
+void io_ring_exit(struct io_ring *r) {
+    munmap(r->sqes, r->sqes_size);
+    if (r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_size);
+    munmap(r->sq_ptr, r->sq_size);
+    close(r->ring_fd);
+}
+
+// ---------------------------------------------------------
+// SUBMIT / COMPLETE
+
+struct io_uring_sqe *io_ring_get_sqe(struct io_ring *r) {
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (r->sq_local_tail - head >= r->entries) return NULL;
+
+    unsigned idx = r->sq_local_tail & *r->sq_mask;
+    r->sq_array[idx] = idx;
+    r->sq_local_tail++;
+
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int io_ring_submit(struct io_ring *r, unsigned wait_nr) {
+    unsigned to_submit = r->sq_local_tail - *r->sq_tail;
+    __atomic_store_n(r->sq_tail, r->sq_local_tail, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+       ret = (int)syscall(__NR_io_uring_enter, r->ring_fd, to_submit, wait_nr,
+                          wait_nr ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret < 0 ? -1 : 0;
+}
+
+int io_ring_peek(struct io_ring *r, uint64_t *user_data, int *res) {
+    unsigned head = *r->cq_head;
+    if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) return 0;
+
+    struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
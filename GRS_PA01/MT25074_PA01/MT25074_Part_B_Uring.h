@@ -0,0 +1,38 @@
+#ifndef URING_H //minimal io_uring ring for the io() worker (raw syscalls, no liburing)
+#define URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+struct io_ring {
+    int ring_fd;
+    unsigned entries;
+
+    //submission queue, shared with the kernel
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sq_local_tail;   //filled up to here, published on submit
+
+    //completion queue, shared with the kernel
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size, sqes_size;
+};
+
+//returns 0, or -1 with errno set (no io_uring in this kernel, or blocked)
+int io_ring_init(struct io_ring *r, unsigned entries);
+void io_ring_exit(struct io_ring *r);
+
+//next free SQE (zeroed), or NULL when the submission queue is full
+struct io_uring_sqe *io_ring_get_sqe(struct io_ring *r);
+
+//publishes the queued SQEs and waits for at least wait_nr completions
+int io_ring_submit(struct io_ring *r, unsigned wait_nr);
+
+//takes one completion if there is one: returns 1 and fills user_data / res, else 0
+int io_ring_peek(struct io_ring *r, uint64_t *user_data, int *res);
+
+#endif
@@ -0,0 +1,312 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+// ---------------------------------------------------------
+// RESOURCE SAMPLER
+//
+// Runs a command and samples it and every process it forks straight from
+// /proc (stat, status, io) every --interval ms, instead of forking top,
+// pgrep and iostat once a second. Usage:
+//   ./sampler [--interval MS] [--csv FILE] [--label NAME] [--quiet] -- <command> [args...]
+// --csv gets one row per process per tick:
+//   t_ms,pid,state,threads,cpu_pct,utime_ms,stime_ms,rss_kb,mem_pct,
+//   read_kb,write_kb,io_kbps,vol_ctx,invol_ctx
+// When the command exits one summary line goes to stdout. The averages are
+// per tick, summed over all processes alive at that tick (what the scripts
+// used to add up from top), and the CPU times come from getrusage():
+//   SAMPLE,<label>,<samples>,<wall_s>,<avg_cpu_pct>,<avg_mem_pct>,<avg_io_kbps>,
+//          <user_s>,<sys_s>,<max_rss_kb>
+// I/O is the storage traffic the processes caused (/proc/<pid>/io
+// read_bytes + write_bytes), not whole-device traffic as iostat reported it.
+
+#define MAX_TRACKED 4096
+
+struct proc_sample {
+    int pid;
+    unsigned long long cpu_ticks;   //utime + stime at the last tick
+    unsigned long long io_bytes;    //read_bytes + write_bytes at the last tick
+};
+
+static struct proc_sample tracked[MAX_TRACKED];
+static int num_tracked;
+static long clk_tck;
+static long mem_total_kb;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//whole small /proc file into buf; returns bytes read or -1
+static int read_proc(const char *path, char *buf, size_t len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, len - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+static long long status_field(const char *status, const char *name) {
+    const char *p = strstr(status, name);
+    return p ? atoll(p + strlen(name)) : 0;
+}
+
+static long read_mem_total_kb(void) {
+    char buf[4096];
+    if (read_proc("/proc/meminfo", buf, sizeof(buf)) < 0) return 0;
+    return (long)status_field(buf, "MemTotal:");
+}
+
+static struct proc_sample *find_tracked(int pid) {
+    for (int i = 0; i < num_tracked; i++) {
+       if (tracked[i].pid == pid) return &tracked[i];
+    }
+    if (num_tracked == MAX_TRACKED) return NULL;
+    struct proc_sample *p = &tracked[num_tracked++];
+    memset(p, 0, sizeof(*p));   //a new process: everything it has used is new
+    p->pid = pid;
+    return p;
+}
+
+// ---------------------------------------------------------
+// PROCESS TREE
+
+//root and every descendant, through /proc/<pid>/task/<tid>/children
+static int collect_tree(int root, int *pids, int max) {
+    int count = 0;
+    pids[count++] = root;
+    for (int i = 0; i < count; i++) {
+       char path[64];
+       snprintf(path, sizeof(path), "/proc/%d/task", pids[i]);
+       DIR *dir = opendir(path);
+       if (dir == NULL) continue;
+
+       struct dirent *ent;
+       while ((ent = readdir(dir)) != NULL) {
+          if (ent->d_name[0] < '0' || ent->d_name[0] > '9') continue;
+          char file[320], buf[4096];
+          snprintf(file, sizeof(file), "/proc/%d/task/%s/children", pids[i], ent->d_name);
+          if (read_proc(file, buf, sizeof(buf)) <= 0) continue;
+
+          char *save;
+          for (char *tok = strtok_r(buf, " \n", &save); tok; tok = strtok_r(NULL, " \n", &save)) {
+             if (count < max) pids[count++] = atoi(tok);
+          }
+       }
+       closedir(dir);
+    }
+    return count;
+}
+
+// ---------------------------------------------------------
+// ONE TICK
+
+struct tick_total {
+    double cpu_pct;
+    double mem_pct;
+    double io_kbps;
+};
+
+static struct tick_total sample_tick(int root, double t, double dt, FILE *csv) {
+    struct tick_total total = {0, 0, 0};
+    int pids[MAX_TRACKED];
+    int n = collect_tree(root, pids, MAX_TRACKED);
+
+    for (int i = 0; i < n; i++) {
+       char path[64], stat[1024], status[4096], io[1024];
+       snprintf(path, sizeof(path), "/proc/%d/stat", pids[i]);
+       if (read_proc(path, stat, sizeof(stat)) < 0) continue;   //exited meanwhile
+       snprintf(path, sizeof(path), "/proc/%d/status", pids[i]);
+       if (read_proc(path, status, sizeof(status)) < 0) continue;
+       snprintf(path, sizeof(path), "/proc/%d/io", pids[i]);
+       if (read_proc(path, io, sizeof(io)) < 0) io[0] = '\0';   //needs ptrace access
+
+       //fields after the ")" that closes comm: state is field 3, utime 14, stime 15
+       char *after = strrchr(stat, ')');
+       if (after == NULL) continue;
+       char state;
+       unsigned long long utime, stime;
+       if (sscanf(after + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                  &state, &utime, &stime) != 3) continue;
+       if (state == 'Z') continue;
+
+       long long rss_kb = status_field(status, "VmRSS:");
+       long long threads = status_field(status, "Threads:");
+       long long vol = status_field(status, "\nvoluntary_ctxt_switches:");
+       long long invol = status_field(status, "nonvoluntary_ctxt_switches:");
+       unsigned long long read_b = status_field(io, "read_bytes:");
+       unsigned long long write_b = status_field(io, "\nwrite_bytes:");
+
+       struct proc_sample *prev = find_tracked(pids[i]);
+       if (prev == NULL) continue;
+       unsigned long long cpu_ticks = utime + stime;
+       double cpu_pct = dt > 0 ? (cpu_ticks - prev->cpu_ticks) * 100.0 / clk_tck / dt : 0.0;
+       double io_kbps = dt > 0 ? (read_b + write_b - prev->io_bytes) / 1024.0 / dt : 0.0;
+       double mem_pct = mem_total_kb > 0 ? rss_kb * 100.0 / mem_total_kb : 0.0;
+       prev->cpu_ticks = cpu_ticks;
+       prev->io_bytes = read_b + write_b;
+
+       total.cpu_pct += cpu_pct;
+       total.mem_pct += mem_pct;
+       total.io_kbps += io_kbps;
+
+       if (csv) {
+          fprintf(csv, "%.0f,%d,%c,%lld,%.2f,%llu,%llu,%lld,%.3f,%llu,%llu,%.1f,%lld,%lld\n",
+                  t * 1000, pids[i], state, threads, cpu_pct,
+                  utime * 1000 / clk_tck, stime * 1000 / clk_tck, rss_kb, mem_pct,
+                  read_b / 1024, write_b / 1024, io_kbps, vol, invol);
+       }
+    }
+    return total;
+}
+
+// ---------------------------------------------------------
+// MAIN
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--interval MS] [--csv FILE] [--label NAME] [--quiet] -- <command> [args...]\n", prog);
+    fprintf(stderr, "  --interval MS  sampling period (default 50)\n");
+    fprintf(stderr, "  --csv FILE     per-process time series\n");
+    fprintf(stderr, "  --label NAME   label of the SAMPLE summary line (default: the command)\n");
+    fprintf(stderr, "  --quiet        send the command's output to /dev/null\n");
+}
+
+int main(int argc, char *argv[]) {
+
+    static const struct option long_opts[] = {
+        {"interval", required_argument, NULL, 'i'},
+        {"csv",      required_argument, NULL, 'c'},
+        {"label",    required_argument, NULL, 'l'},
+        {"quiet",    no_argument,       NULL, 'q'},
+        {NULL, 0, NULL, 0}
+    };
+    int interval_ms = 50;
+    const char *csv_path = NULL;
+    const char *label = NULL;
+    int quiet = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "+i:c:l:q", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'i': interval_ms = atoi(optarg); break;
+        case 'c': csv_path = optarg; break;
+        case 'l': label = optarg; break;
+        case 'q': quiet = 1; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || interval_ms < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (label == NULL) label = argv[optind];
+
+    clk_tck = sysconf(_SC_CLK_TCK);
+    mem_total_kb = read_mem_total_kb();
+
+    FILE *csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (csv == NULL) {
+            perror("Cannot open the CSV file");
+            return 1;
+        }
+        fprintf(csv, "t_ms,pid,state,threads,cpu_pct,utime_ms,stime_ms,rss_kb,mem_pct,"
+                     "read_kb,write_kb,io_kbps,vol_ctx,invol_ctx\n");
+    }
+
+    double start = now_s();
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork failed");
+        return 1;
+    }
+    if (child == 0) {
+        if (quiet) {
+            int devnull = open("/dev/null", O_WRONLY);
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+        }
+        execvp(argv[optind], &argv[optind]);
+        perror("exec failed");
+        _exit(127);
+    }
+
+    //a pidfd becomes readable the moment the command exits, so the wait for
+    //the next tick doubles as the wait for the exit and wall_s is not rounded
+    //up to a tick (without pidfd_open, pre-5.3 kernels, it is)
+    int pidfd = (int)syscall(SYS_pidfd_open, child, 0);
+
+    //absolute ticks, so the time spent sampling does not stretch the period
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    double last = now_s();
+    double sum_cpu = 0, sum_mem = 0, sum_io = 0;
+    long samples = 0;
+    int status = 0;
+
+    for (;;) {
+        next.tv_nsec += interval_ms * 1000000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        if (pidfd >= 0) {
+            struct timespec now, left;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            left.tv_sec = next.tv_sec - now.tv_sec;
+            left.tv_nsec = next.tv_nsec - now.tv_nsec;
+            if (left.tv_nsec < 0) {
+                left.tv_nsec += 1000000000L;
+                left.tv_sec--;
+            }
+            if (left.tv_sec < 0) left.tv_sec = left.tv_nsec = 0;   //sampling overran the tick
+            struct pollfd pfd = { .fd = pidfd, .events = POLLIN };
+            ppoll(&pfd, 1, &left, NULL);
+        } else {
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+
+        //stop once the command is done (a zombie still has /proc entries)
+        if (waitpid(child, &status, WNOHANG) == child) break;
+
+        double t = now_s();
+        struct tick_total tick = sample_tick(child, t - start, t - last, csv);
+        last = t;
+        sum_cpu += tick.cpu_pct;
+        sum_mem += tick.mem_pct;
+        sum_io += tick.io_kbps;
+        samples++;
+    }
+    double wall = now_s() - start;
+    if (pidfd >= 0) close(pidfd);
+
+    struct rusage ru;
+    getrusage(RUSAGE_CHILDREN, &ru);
+    if (csv) fclose(csv);
+
+    long n = samples > 0 ? samples : 1;
+    printf("SAMPLE,%s,%ld,%.3f,%.2f,%.2f,%.2f,%.3f,%.3f,%ld\n", label, samples, wall,
+           sum_cpu / n, sum_mem / n, sum_io / n,
+           ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6,
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6, ru.ru_maxrss);
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -7,6 +7,8 @@
 OUTPUT_FILE="MT25074_Part_C_CSV.csv"
 PIN_CORE="2"
 TEST_COUNT="2"
+SAMPLE_MS=${SAMPLE_MS:-50}              # sampler period, sub-100 ms
+SERIES_DIR="MT25074_Part_C_Samples"     # per-run time series from the sampler
 
 # --- DEPENDENCY CHECK ---
 check_tool() {
@@ -20,17 +22,16 @@ check_tool() {
 echo "Checking dependencies..."
 check_tool "make" "build-essential"
 check_tool "gnuplot" "gnuplot"
-check_tool "iostat" "sysstat"
-check_tool "bc" "bc"
 echo "All dependencies found."
 echo "-----------------------------------------------------"
 
 # 1. CLEANUP & COMPILE
 rm -f $OUTPUT_FILE
+rm -rf $SERIES_DIR && mkdir -p $SERIES_DIR
 make clean > /dev/null 2>&1
 make > /dev/null 2>&1
 
-if [ ! -f "./program_a1" ] || [ ! -f "./program_a2" ]; then
+if [ ! -f "./program_a1" ] || [ ! -f "./program_a2" ] || [ ! -f "./sampler" ]; then
     echo "Error: Executables not found. Compilation failed."
     exit 1
 fi
@@ -45,51 +46,20 @@ measure_stats() {
     prog_cmd=$1
     task=$2
     label=$3
-    prog_name=$(basename "$prog_cmd")
 
-    # Run Program
-    taskset -c $PIN_CORE $prog_cmd $task $TEST_COUNT > /dev/null 2>&1 &
-    MAIN_PID=$!
+    # Run Program under the sampler: every $SAMPLE_MS ms it reads /proc/<pid>/stat,
+    # status and io for the program and every child it forks, and at the end
+    # prints one line: SAMPLE,<label>,<samples>,<wall_s>,<cpu%>,<mem%>,<io_kbps>,...
+    summary=$(./sampler --interval $SAMPLE_MS --quiet --label "$label+$task" \
+        --csv "$SERIES_DIR/${label}_${task}.csv" \
+        -- taskset -c $PIN_CORE $prog_cmd $task $TEST_COUNT | grep "^SAMPLE,")
 
-    total_cpu=0; total_mem=0; total_io=0; samples=0
-
-    # Monitor Loop
-    while [ -e /proc/$MAIN_PID ]; do
-        state=$(awk '{print $3}' /proc/$MAIN_PID/stat 2>/dev/null)
-        if [ "$state" == "Z" ] || [ -z "$state" ]; then break; fi
-
-        PIDS=$(pgrep -d',' -f "$prog_name")
-        if [ -z "$PIDS" ]; then sleep 0.1; continue; fi
-
-        # Capture Stats
-        stats=$(top -b -n 1 -p "$PIDS" | grep -E "^ *[0-9]+" | awk '{cpu+=$9; mem+=$10} END {print cpu+0, mem+0}')
-        io_now=$(iostat -d -k 1 2 | grep -E "sd[a-z]|vd[a-z]|nvme" | tail -1 | awk '{print $4}')
-
-        cpu_now=$(echo "$stats" | awk '{print $1}')
-        mem_now=$(echo "$stats" | awk '{print $2}')
-
-        # Sanitize empty values
-        if [ -z "$cpu_now" ]; then cpu_now=0; fi
-        if [ -z "$mem_now" ]; then mem_now=0; fi
-        if [ -z "$io_now" ]; then io_now=0; fi
-
-        # Sum using bc
-        total_cpu=$(echo "$total_cpu + $cpu_now" | bc)
-        total_mem=$(echo "$total_mem + $mem_now" | bc)
-        total_io=$(echo "$total_io + $io_now" | bc)
-        samples=$((samples + 1))
-
-        sleep 1
-    done
-
-    # Calculate Average
-    if [ $samples -eq 0 ]; then samples=1; fi
-    avg_cpu=$(echo "scale=2; $total_cpu / $samples" | bc)
-    avg_mem=$(echo "scale=2; $total_mem / $samples" | bc)
-    avg_io=$(echo "scale=2; $total_io / $samples" | bc)
+    avg_cpu=$(echo "$summary" | cut -d, -f5)
+    avg_mem=$(echo "$summary" | cut -d, -f6)
+    avg_io=$(echo "$summary" | cut -d, -f7)
 
     # OUTPUT (Updated to use Commas)
-    echo "$label+$task,$avg_cpu,$avg_mem,$avg_io" | tee -a $OUTPUT_FILE
+    echo "$label+$task,${avg_cpu:-0},${avg_mem:-0},${avg_io:-0}" | tee -a $OUTPUT_FILE
 }
 
 # 3. RUN EXPERIMENTS
@@ -0,0 +1,232 @@
+#!/bin/bash
+
+# =========================================================
+# MT25074 - Part D: Multi-Core Scaling Harness & Gnuplot
+# =========================================================
+#
+# MT25074_Part_D_shell.sh pins every run to one core, so it only measures
+# time-slicing. This script gives each run a set of 1..N cores instead and
+# sweeps the worker count against it, for both placements:
+#   compact - fill one physical core (all its SMT siblings), then the next,
+#             then the next socket
+#   scatter - one CPU per physical core, round-robin over sockets; SMT
+#             siblings only once every physical core is in use
+# and with SMT siblings on (all logical CPUs) or off (one per physical core).
+#
+# Every worker does the same fixed amount of work, so the work done grows
+# with the worker count. Per run:
+#   Speedup    = Workers * T(1 worker, 1 core) / Wall_s
+#   Efficiency = Speedup / Cores
+# Wall time is taken from the sampler (MT25074_Part_C_Sampler.c), which stamps
+# it when the program exits rather than on the next tick; each point is the
+# best of $REPEATS runs. Jobs are sized (JOB_INPUT) so that one worker runs
+# for a couple of seconds, i.e. dozens of sampler ticks, not the ~0.2 s of the
+# drivers' default cpu job.
+#
+# Tunables (environment):
+#   WORKERS="1 2 4 8"   worker counts (default: powers of two up to 2x the cores)
+#   TASKS="cpu mem io"  task types
+#   REPEATS=3           runs per point
+#   MAX_CORES=N         cap on the core counts swept
+#   JOB_INPUT=N         job size for every task (default: per task, see job_input)
+
+OUTPUT_FILE="MT25074_Part_D_Scaling_CSV.csv"
+TASKS=${TASKS:-"cpu mem io"}
+REPEATS=${REPEATS:-3}
+SAMPLE_MS=${SAMPLE_MS:-50}
+
+# --- DEPENDENCY CHECK ---
+check_tool() {
+    if ! command -v $1 &> /dev/null; then
+        echo "Error: Required tool '$1' is not installed."
+        echo "Install it using: sudo apt install $2 -y"
+        exit 1
+    fi
+}
+
+echo "Checking dependencies..."
+check_tool "make" "build-essential"
+check_tool "gnuplot" "gnuplot"
+check_tool "taskset" "util-linux"
+echo "All dependencies found."
+echo "-----------------------------------------------------"
+
+# 1. CLEANUP & COMPILE
+rm -f $OUTPUT_FILE
+make > /dev/null 2>&1
+
+if [ ! -f "./program_a1" ] || [ ! -f "./program_a2" ] || [ ! -f "./sampler" ]; then
+    echo "Error: Executables not found."
+    exit 1
+fi
+
+# =========================================================
+# 2. CPU TOPOLOGY
+# =========================================================
+# One line per CPU we are allowed to run on: "cpu package core thread", where
+# thread is the CPU's position among its SMT siblings (0 = first sibling)
+
+expand_list() {
+    # "0-3,8,10-11" -> one number per line
+    echo "$1" | tr ',' '\n' | awk -F- '{ if (NF == 2) for (i = $1; i <= $2; i++) print i; else if ($1 != "") print $1 }'
+}
+
+allowed=$(grep Cpus_allowed_list /proc/self/status | awk '{ print $2 }')
+TOPOLOGY=$(
+    for cpu in $(expand_list "$allowed"); do
+        topo=/sys/devices/system/cpu/cpu$cpu/topology
+        pkg=$(cat $topo/physical_package_id 2>/dev/null || echo 0)
+        core=$(cat $topo/core_id 2>/dev/null || echo $cpu)
+        siblings=$(expand_list "$(cat $topo/thread_siblings_list 2>/dev/null || echo $cpu)")
+        thread=$(echo "$siblings" | grep -n -x "$cpu" | cut -d: -f1)
+        echo "$cpu $pkg $core $((thread - 1))"
+    done
+)
+
+# Ordered CPU list for a placement and SMT setting (space separated)
+cpu_order() {
+    placement=$1
+    smt=$2
+    echo "$TOPOLOGY" | awk -v smt=$smt '$4 == 0 || smt == "on"' |
+    if [ "$placement" == "compact" ]; then
+        sort -k2,2n -k3,3n -k4,4n
+    else
+        # rank each physical core within its socket, then deal ranks out over sockets
+        sort -k2,2n -k3,3n -k4,4n |
+            awk '{ if ($4 == 0) rank[$2]++; print $0, rank[$2] }' |
+            sort -k4,4n -k5,5n -k2,2n
+    fi | awk '{ printf "%s ", $1 }'
+}
+
+SMT_MODES="off"
+if echo "$TOPOLOGY" | awk '$4 > 0 { found = 1 } END { exit !found }'; then
+    SMT_MODES="off on"
+fi
+
+echo "Allowed CPUs: $allowed"
+echo "SMT settings: $SMT_MODES"
+echo "-----------------------------------------------------"
+
+# =========================================================
+# 3. MEASUREMENT
+# =========================================================
+
+# job size per task, about 2 s for one worker (the drivers default to 8000,
+# which is ~0.2 s of cpu work); io stays moderate since it is 40 KB of file per unit
+job_input() {
+    if [ -n "$JOB_INPUT" ]; then
+        echo $JOB_INPUT
+        return
+    fi
+    case $1 in
+        cpu) echo 80000 ;;
+        mem) echo 12000 ;;
+        *)   echo 16000 ;;
+    esac
+}
+
+# best wall time (s) of $REPEATS runs: run_wall <cpu list> <program> <task> <workers>
+run_wall() {
+    for r in $(seq $REPEATS); do
+        JOB_INPUT=$(job_input $3) ./sampler --interval $SAMPLE_MS --quiet -- taskset -c $1 $2 $3 $4 | grep "^SAMPLE," | cut -d, -f4
+    done | sort -g | head -1
+}
+
+echo "Program,Task,Placement,SMT,Cores,CPUs,Workers,Wall_s,Speedup,Efficiency" | tee $OUTPUT_FILE
+
+for prog in "program_a1:Process_A" "program_a2:Thread_B"; do
+    prog_cmd="./${prog%%:*}"
+    prog_name=${prog##*:}
+
+    for task in $TASKS; do
+        # baseline: one worker alone on the first CPU
+        first_cpu=$(cpu_order compact off | awk '{ print $1 }')
+        base=$(run_wall $first_cpu $prog_cmd $task 1)
+        echo "# $prog_name $task baseline: ${base}s on CPU $first_cpu (JOB_INPUT=$(job_input $task))"
+
+        for smt in $SMT_MODES; do
+            for placement in compact scatter; do
+                order=($(cpu_order $placement $smt))
+                # with one socket and no SMT both placements are the same CPUs
+                if [ "$placement" == "scatter" ] && [ "${order[*]}" == "$(cpu_order compact $smt | xargs)" ]; then
+                    continue
+                fi
+
+                max=${#order[@]}
+                [ -n "$MAX_CORES" ] && [ $MAX_CORES -lt $max ] && max=$MAX_CORES
+                for cores in $(seq $max); do
+                    cpus=$(echo "${order[@]:0:$cores}" | tr ' ' ',')
+                    counts=${WORKERS:-$(w=1; while [ $w -le $((2 * cores)) ]; do echo -n "$w "; w=$((w * 2)); done)}
+
+                    for workers in $counts; do
+                        wall=$(run_wall $cpus $prog_cmd $task $workers)
+                        echo "$prog_name,$task,$placement,$smt,$cores,${cpus//,/ },$workers,$wall" |
+                            awk -F, -v base=$base -v OFS=, '{
+                                speedup = $8 > 0 ? $7 * base / $8 : 0
+                                print $0, sprintf("%.3f", speedup), sprintf("%.3f", speedup / $5)
+                            }' | tee -a $OUTPUT_FILE
+                    done
+                done
+            done
+        done
+    done
+done
+
+echo "Scaling Data Collection Complete!"
+echo "-----------------------------------------------------"
+
+# =========================================================
+# STEP 4: GENERATE PLOTS (GNUPLOT)
+# =========================================================
+# Top row: speedup vs cores with one worker per core; bottom row: efficiency.
+# One line per program / placement / SMT setting.
+echo "Generating Plots using Gnuplot..."
+
+SERIES=""
+for task in $TASKS; do
+    for key in $(awk -F, -v t=$task 'NR > 1 && $2 == t && $5 == $7 { print $1 "," $3 "," $4 }' $OUTPUT_FILE | sort -u); do
+        file="scaling_${task}_$(echo $key | tr ',' '_').dat"
+        awk -F, -v t=$task -v k=$key 'NR > 1 && $2 == t && $5 == $7 && ($1 "," $3 "," $4) == k' $OUTPUT_FILE > $file
+        SERIES="$SERIES $file"
+    done
+done
+
+plot_cmd() {
+    # plot_cmd <task> <column>
+    cmd=""
+    for file in $(ls scaling_$1_*.dat 2>/dev/null); do
+        title=$(echo ${file%.dat} | cut -d_ -f3- | tr '_' ' ')
+        cmd="$cmd${cmd:+, }'$file' using 5:$2 with linespoints lw 2 pt 7 title '$title'"
+    done
+    echo "${cmd:-0 notitle}"
+}
+
+gnuplot << EOF
+set terminal pngcairo size 1800,1000 enhanced font 'Verdana,10'
+set output 'MT25074_Part_D_Scaling_Plot.png'
+set datafile separator ","
+set multiplot layout 2,3 title "Part D: Multi-Core Scaling (workers = cores)" font ",14"
+set grid
+set key top left
+set xlabel "Cores"
+
+$(for task in $TASKS; do
+    echo "set title \"$task: Speedup\""
+    echo "set ylabel \"Speedup\""
+    echo "plot $(plot_cmd $task 9), x with lines dt 2 lc rgb 'gray' title 'ideal'"
+done)
+
+$(for task in $TASKS; do
+    echo "set title \"$task: Parallel Efficiency\""
+    echo "set ylabel \"Efficiency\""
+    echo "plot [] [0:1.2] $(plot_cmd $task 10)"
+done)
+
+unset multiplot
+EOF
+
+# Cleanup
+rm -f $SERIES
+
+echo "Success! Generated: MT25074_Part_D_Scaling_Plot.png"
+echo "-----------------------------------------------------"
@@ -6,6 +6,8 @@
 
 OUTPUT_FILE="MT25074_Part_D_CSV.csv"
 PIN_CORE="2"
+SAMPLE_MS=${SAMPLE_MS:-50}              # sampler period, sub-100 ms
+SERIES_DIR="MT25074_Part_D_Samples"     # per-run time series from the sampler
 
 # --- DEPENDENCY CHECK ---
 check_tool() {
@@ -19,17 +21,16 @@ check_tool() {
 echo "Checking dependencies..."
 check_tool "make" "build-essential"
 check_tool "gnuplot" "gnuplot"
-check_tool "iostat" "sysstat"
-check_tool "bc" "bc"
 echo "All dependencies found."
 echo "-----------------------------------------------------"
 
 # 1. CLEANUP & COMPILE
 rm -f $OUTPUT_FILE
+rm -rf $SERIES_DIR && mkdir -p $SERIES_DIR
 make clean > /dev/null 2>&1
 make > /dev/null 2>&1
 
-if [ ! -f "./program_a1" ] || [ ! -f "./program_a2" ]; then
+if [ ! -f "./program_a1" ] || [ ! -f "./program_a2" ] || [ ! -f "./sampler" ]; then
     echo "Error: Executables not found."
     exit 1
 fi
@@ -50,49 +51,22 @@ measure_stats() {
 
             echo -n "Running $prog_name [$task] Count: $count ... "
 
-            # A. Start Workload
-            taskset -c $PIN_CORE $prog_cmd $task $count > /dev/null 2>&1 &
-            WORKLOAD_PID=$!
-
-            # B. Monitor Loop
-            total_metric=0
-            samples=0
-            sleep 0.2
-
-            while kill -0 $WORKLOAD_PID 2> /dev/null; do
-
-                # Identify PIDs
-                if [[ "$prog_name" == "Process_A" ]]; then
-                    PIDS=$(pgrep -f "program_a1" | tr '\n' ',' | sed 's/,$//')
-                else
-                    PIDS=$(pgrep -f "program_a2" | tr '\n' ',' | sed 's/,$//')
-                fi
-
-                if [ -z "$PIDS" ]; then break; fi
-
-                # Capture Metrics
-                current_val=0.0
-                if [[ "$task" == "cpu" ]]; then
-                    current_val=$(top -b -n 1 -p "$PIDS" 2>/dev/null | awk 'NR>7 {sum+=$9} END {print sum+0}')
-                elif [[ "$task" == "mem" ]]; then
-                    current_val=$(top -b -n 1 -p "$PIDS" 2>/dev/null | awk 'NR>7 {sum+=$10} END {print sum+0}')
-                elif [[ "$task" == "io" ]]; then
-                    # --- FIX IS HERE: Use '1 2' and 'tail -1' ---
-                    current_val=$(iostat -d -k 1 2 | grep -E 'sd|vd|nvme' | tail -1 | awk '{sum+=$4} END {print sum}')
-                fi
-
-                total_metric=$(echo "$total_metric + $current_val" | bc)
-                samples=$((samples + 1))
-                sleep 1
-            done
-
-
-            # Computing Average
-            if [ $samples -gt 0 ]; then
-                avg_val=$(echo "scale=2; $total_metric / $samples" | bc)
+            # A. Run the workload under the sampler (see MT25074_Part_C_Sampler.c):
+            # /proc is read every $SAMPLE_MS ms for the program and all its children
+            summary=$(./sampler --interval $SAMPLE_MS --quiet --label "$prog_name+$task+$count" \
+                --csv "$SERIES_DIR/${prog_name}_${task}_${count}.csv" \
+                -- taskset -c $PIN_CORE $prog_cmd $task $count | grep "^SAMPLE,")
+
+            # B. The metric that matters for the task: CPU%, Mem% or I/O KB/s
+            # (SAMPLE,<label>,<samples>,<wall_s>,<cpu%>,<mem%>,<io_kbps>,...)
+            if [[ "$task" == "cpu" ]]; then
+                avg_val=$(echo "$summary" | cut -d, -f5)
+            elif [[ "$task" == "mem" ]]; then
+                avg_val=$(echo "$summary" | cut -d, -f6)
             else
-                avg_val="0"
+                avg_val=$(echo "$summary" | cut -d, -f7)
             fi
+            avg_val=${avg_val:-0}
 
             echo "Avg: $avg_val"
             echo "$prog_name,$task,$count,$avg_val" >> $OUTPUT_FILE
@@ -13,81 +13,22 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <time.h>
-
-#define SERVER_IP "10.0.0.1"
-#define SERVER_PORT 8080
-#define NUM_FIELDS 8
-#define DURATION_SECONDS 10  // Fixed duration - CLIENT controls this
-
-struct message {
-    char *fields[NUM_FIELDS];
-};
-
-struct message* create_message(size_t field_size) {
-    struct message *msg = malloc(sizeof(struct message)); //memory for struct message which holds pointers to 8 string data
-    if (!msg) return NULL;
-    
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        msg->fields[i] = malloc(field_size); //allocating heap memory and storing address in string pointer field
-        if (!msg->fields[i]) {
-            for (int j = 0; j < i; j++) free(msg->fields[j]);
-            free(msg);
-            return NULL;
-        }
-        memset(msg->fields[i], 'C' + i, field_size);  // Client pattern
-   }
-    return msg;
-}
-
-void free_message(struct message *msg) {
-    if (!msg) return;
-    for (int i = 0; i < NUM_FIELDS; i++) free(msg->fields[i]);
-    free(msg);
-}
-
-ssize_t recv_all(int sockfd, void *buffer, size_t len) {
-    char *buf = buffer;
-    size_t total = 0;
-    while (total < len) {
-        ssize_t n = recv(sockfd, buf + total, len - total, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
-        }
-        if (n == 0) return total;
-        total += n;
-    }
-    return total;
-}
-
-ssize_t send_all(int sockfd, const void *buffer, size_t len) {
-    const char *buf = buffer;
-    size_t total = 0;
-    while (total < len) {
-        ssize_t n = send(sockfd, buf + total, len - total, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
-            return -1;
-        }
-        total += n;
-    }
-    return total;
-}
+#include "MT25074_Part_A_Common.h"
+#include "MT25074_Part_A_Histogram.h"
 
 int main(int argc, char *argv[]) {
     
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <field_size>\n", argv[0]);
+    struct client_config cfg;
+    if (parse_client_args(argc, argv, &cfg) < 0) {
         exit(1);
     }
 
-    size_t field_size = atoi(argv[1]);
+    size_t field_size = cfg.field_size;
     int port = SERVER_PORT;
-    int duration = DURATION_SECONDS;
+    int duration = cfg.duration;
     
     
-    printf("Client: Server=%s:%d, field_size=%zu, duration=%ds\n", SERVER_IP, port, field_size, duration);
+    printf("Client: Server=%s:%d, field_size=%zu, duration=%ds, depth=%d\n", SERVER_IP, port, field_size, duration, cfg.depth);
   
 
     int sock_fd;
@@ -143,8 +84,8 @@ int main(int argc, char *argv[]) {
 
     //STEP 5: SEND AND RECIEVE DATA
 
-    struct message *send_msg = create_message(field_size);
-    struct message *recv_msg = create_message(field_size);
+    struct message *send_msg = create_message(field_size, 'C');  // Client pattern
+    struct message *recv_msg = create_message(field_size, 'C');  // Client pattern
     
     if (!send_msg || !recv_msg) {
         perror("Failed to allocate messages");
@@ -152,41 +93,102 @@ int main(int argc, char *argv[]) {
     }
     
     // ==================== FIXED DURATION TRANSFER ====================
-    // CLIENT controls the duration - sends continuously for fixed time
+    // CLIENT controls the duration - sends continuously for fixed time.
+    // A timerfd thread flips the run phase; only the MEASURE window is counted.
     
-    time_t start_time = time(NULL);
-    time_t end_time = start_time + duration;
-    uint64_t messages_sent = 0;
+    uint64_t messages_sent = 0;      // every round trip, warm-up included (matches the server)
+    uint64_t messages_measured = 0;  // round trips completed inside the measured window
     uint64_t total_bytes = 0;
+    size_t msg_bytes = NUM_FIELDS * field_size;
+    
+    // Round-trip latency histogram (fixed size, static so it is off the stack)
+    static struct latency_hist hist;
+    hist_init(&hist);
+    
+    printf("Starting transfer: %ds warm-up + %d measured seconds...\n", cfg.warmup, duration);
     
-    printf("Starting transfer for %d seconds...\n", duration);
+    // --zc-recv: responses are mapped out of the socket where the kernel can, copied otherwise
+    struct zc_recv zr;
+    if (cfg.zc_recv) zc_recv_init(&zr, sock_fd, msg_bytes);
     
-    // Send continuously until time expires
-    while (time(NULL) < end_time) {
-        // Send request: all 8 fields
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            if (send_all(sock_fd, send_msg->fields[i], field_size) != field_size) {
-                perror("Send failed");
-                
-            }
+    // This thread's counters, switched on only inside the measured window
+    struct perf_counters perf;
+    perf_counters_open(&perf);
+    
+    struct run_deadline dl;
+    if (run_deadline_start(&dl, cfg.warmup, duration) < 0) {
+        exit(1);
+    }
+    
+    // Framed runs always take this path: it is the one that writes headers
+    int pipelined = cfg.depth > 1 || cfg.framed;
+    if (pipelined) {
+        // Pipelined: keep cfg.depth requests in flight, drain them at the deadline
+        struct pipeline_conn pc;
+        pipeline_conn_init(&pc, sock_fd, cfg.depth, &hist);
+        pc.zc = cfg.zc_recv ? &zr : NULL;
+        pc.sizes = cfg.framed ? &cfg.sizes : NULL;
+        pc.perf = &perf;
+        int64_t done = run_pipelined_exchange(&pc, send_msg, recv_msg, &dl);
+        if (done > 0) {
+            messages_sent = done;
+            messages_measured = pc.measured;
+            total_bytes = pc.measured_bytes;
         }
+    }
+
+    // Stop-and-wait: send continuously until time expires
+    while (!pipelined && run_phase(&dl) != RUN_STOP) {
+        perf_counters_track(&perf, run_phase(&dl) == RUN_MEASURE);
+        uint64_t t0 = hist_now_ns();
         
-        // Receive response: all 8 fields (server's repeated transfer)
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            if (recv_all(sock_fd, recv_msg->fields[i], field_size) != field_size) {
-                printf("Server closed connection unexpectedly\n");
-                
-            }
+        // Send request: all 8 fields in one vectored writev()
+        struct iovec iov[NUM_FIELDS];
+        int cnt = message_iov(send_msg, 0, iov);
+        if (iov_transfer_all(sock_fd, iov, cnt, writev_some) != (ssize_t)msg_bytes) {
+            perror("Send failed");
+            break;
+        }
+        
+        // Receive response: all 8 fields (server's repeated transfer) with readv()
+        cnt = message_iov(recv_msg, 0, iov);
+        ssize_t got = cfg.zc_recv ? zc_recv_all(&zr, sock_fd, recv_msg)
+                                  : iov_transfer_all(sock_fd, iov, cnt, readv_some);
+        if (got != (ssize_t)msg_bytes) {
+            printf("Server closed connection unexpectedly\n");
+            break;
         }
         
         messages_sent++;
-        total_bytes += (NUM_FIELDS * field_size * 2);  // Request + response
+        if (run_phase(&dl) == RUN_MEASURE) {
+            hist_record(&hist, hist_now_ns() - t0);
+            messages_measured++;
+            total_bytes += (msg_bytes * 2);  // Request + response
+        }
     }
+    perf_counters_track(&perf, 0);
+    double elapsed = run_deadline_finish(&dl);
     
     // Time's up - client initiates close
-    printf("Time limit reached (%d seconds)\n", DURATION_SECONDS);
+    printf("Time limit reached (%d seconds, %.6f s measured)\n", duration, elapsed);
     printf("Messages exchanged: %lu\n", messages_sent);
-    //printf("Throughput: %.2f Mbps\n", (total_bytes * 8.0) / (DURATION_SECONDS * 1000000.0));
+    printf("Messages measured: %lu (warm-up excluded)\n", messages_measured);
+    if (elapsed > 0) {
+        printf("Throughput: %.2f Mbps (%.0f msgs/s)\n",
+               (total_bytes * 8.0) / (elapsed * 1000000.0), messages_measured / elapsed);
+    }
+    hist_print_summary(&hist);
+    uint64_t counts[PERF_NUM_EVENTS] = {0};
+    perf_counters_read(&perf, counts);
+    perf_counters_close(&perf);
+    char perf_line[256];
+    perf_format_line("client", "A1", counts, messages_measured, perf_line, sizeof(perf_line));
+    fputs(perf_line, stdout);
+    if (cfg.zc_recv) {
+        zc_recv_report(zr.zc_bytes, zr.copied_bytes);
+        zc_recv_free(&zr);
+    }
+    if (cfg.latency_csv) hist_write_csv(&hist, cfg.latency_csv, "A1");
     
 
     free_message(send_msg);
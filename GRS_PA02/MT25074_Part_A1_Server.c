@@ -14,69 +14,23 @@
 #include <errno.h>
 #include <time.h>
 #include <pthread.h>
+#include "MT25074_Part_A_Common.h"
 
 
-#define SERVER_IP "10.0.0.1"
-#define SERVER_PORT 8080
-#define BACKLOG 5
-#define NUM_FIELDS 8
-
-struct message {
-    char *fields[NUM_FIELDS];
+/*
+ * Two-copy baseline: plain readv()/writev() over the 8 field iovecs.
+ * The kernel copies user buffer -> socket buffer on send and back on receive.
+ */
+static const struct server_ops a1_ops = {
+    .name = "A1 Two-Copy",
+    .setup_conn = NULL,
+    .teardown_conn = NULL,
+    .conn_errqueue = NULL,
+    .create_response = NULL,
+    .recv_some = readv_some,
+    .send_some = writev_some
 };
 
-struct message* create_message(size_t field_size) {
-    struct message *msg = malloc(sizeof(struct message)); //memory for struct message which holds pointers to 8 string data
-    if (!msg) return NULL;
-    
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        msg->fields[i] = malloc(field_size); //allocating heap memory and storing address in string pointer field
-        if (!msg->fields[i]) {
-            for (int j = 0; j < i; j++) free(msg->fields[j]);
-            free(msg);
-            return NULL;
-        }
-        memset(msg->fields[i], 'S' + i, field_size);  // Server pattern
-    }
-    return msg;
-}
-
-void free_message(struct message *msg) {
-    if (!msg) return;
-    for (int i = 0; i < NUM_FIELDS; i++) free(msg->fields[i]);
-    free(msg);
-}
-
-ssize_t recv_all(int sockfd, void *buffer, size_t len) {
-    char *buf = buffer;
-    size_t total = 0;
-    while (total < len) {
-       ssize_t n = recv(sockfd, buf + total, len - total, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
-        }
-        if (n == 0) return total;  // Connection closed
-        total += n;
-    }
-    return total;
-}
-
-ssize_t send_all(int sockfd, const void *buffer, size_t len) {
-    const char *buf = buffer;
-    size_t total = 0;
-    while (total < len) {
-        ssize_t n = send(sockfd, buf + total, len - total, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
-        }
-        total += n;
-    }
-    return total;
-}
-
-
 
 /************************************************/
 
@@ -86,16 +40,27 @@ ssize_t send_all(int sockfd, const void *buffer, size_t len) {
 struct thread_args{
     int conn_fd;
     size_t field_size;
+    int slot;          // this thread's stats slot (server_slot_acquire)
+    int framed;        // --framed: length-prefixed messages of any size up to field_size
 };
 
 void* client_thread(void* arg) {
 
     struct thread_args *args = (struct thread_args*)arg;
+    server_stats_bind(args->slot);
+
+    if (args->framed) {
+        serve_framed_conn(args->conn_fd, args->field_size, &a1_ops);
+        server_stats_conn_closed(args->conn_fd);
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
 
     // Server's response message (created once, sent repeatedly)
-    struct message *response_msg = create_message(args->field_size);
+    struct message *response_msg = create_message(args->field_size, 'S');
     // Buffer to receive client request
-    struct message *request_buffer = create_message(args->field_size);
+    struct message *request_buffer = create_message(args->field_size, 'S');
     
     if (!response_msg || !request_buffer) {
         close(args->conn_fd);
@@ -104,6 +69,7 @@ void* client_thread(void* arg) {
     }
 
     uint64_t msg_count = 0; 
+    size_t msg_bytes = NUM_FIELDS * args->field_size;
     
     // ==================== REPEATED TRANSFERS ====================
     // Server transfers repeatedly until client closes connection
@@ -111,33 +77,33 @@ void* client_thread(void* arg) {
     
     while (1) {
         
-        // STEP 1: Receive all 8 fields from client (request)
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            ssize_t n = recv_all(args->conn_fd, request_buffer->fields[i], args->field_size);
-            
-            if (n == 0 && i == 0) {
-                // Client closed connection cleanly
-                printf("Server: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
-                goto cleanup;
-            }
-    
-            if (n != args->field_size) {
-                printf("Server: Receive error or partial (%zd/%zu)\n", n, args->field_size);
-                goto cleanup;
-            }
+        // STEP 1: Receive all 8 fields from client (request) - one vectored call per attempt
+        struct iovec iov[NUM_FIELDS];
+        int cnt = message_iov(request_buffer, 0, iov);
+        ssize_t n = iov_transfer_all(args->conn_fd, iov, cnt, a1_ops.recv_some);
+
+        if (n == 0) {
+            // Client closed connection cleanly
+            printf("Server: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
+            goto cleanup;
+        }
+
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Receive error or partial (%zd/%zu)\n", n, msg_bytes);
+            goto cleanup;
         }
         
         // STEP 2: Send all 8 fields back to client (response)
         // This is the "transfer" - server responds with fixed-size message
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            ssize_t n = send_all(args->conn_fd, response_msg->fields[i], args->field_size);
-            if (n != args->field_size) {
-                printf("Server: Send failed\n");
-                goto cleanup;
-            }
+        cnt = message_iov(response_msg, 0, iov);
+        n = iov_transfer_all(args->conn_fd, iov, cnt, a1_ops.send_some);
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Send failed\n");
+            goto cleanup;
         }
         
         msg_count++;
+        server_stats_message(2 * msg_bytes);  // request + response payload
         
 
     }
@@ -145,6 +111,7 @@ void* client_thread(void* arg) {
 cleanup:
     free_message(response_msg);
     free_message(request_buffer);
+    server_stats_conn_closed(args->conn_fd);
     close(args->conn_fd);
     free(args);
     return NULL;
@@ -155,18 +122,18 @@ cleanup:
 
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <field_size> <num_threads>\n", argv[0]);        exit(1);
-        fprintf(stderr, "Got %d arguments\n", argc-1);
-        for (int i = 1; i < argc; i++) {
-            fprintf(stderr, "  arg[%d]: %s\n", i, argv[i]);
-        }
-        
+    struct server_config cfg;
+    if (parse_server_args(argc, argv, &cfg) < 0) {
         exit(1);
     }
     
-    size_t field_size = atoi(argv[1]);
-    int num_threads = atoi(argv[2]);
+    size_t field_size = cfg.field_size;
+    int num_threads = cfg.num_clients;
+
+    // Event-loop mode: the reactor creates its own listeners, so hand over here
+    if (cfg.mode == SERVER_MODE_EPOLL) {
+        return run_epoll_server(&cfg, &a1_ops) == 0 ? 0 : 1;
+    }
 
     printf("Server: field_size=%zu, accepting %d clients\n", field_size, num_threads);
 
@@ -229,6 +196,7 @@ int main(int argc, char *argv[]) {
     }
 
     printf("Server Listening on %s:%d\n", SERVER_IP, SERVER_PORT);
+    fflush(stdout);  // the benchmark driver waits for this line before starting clients
 
 
 
@@ -239,10 +207,16 @@ int main(int argc, char *argv[]) {
     printf("Waiting for client connection...\n"); //Starting the accepting and handhaking connection process
 
 
-    pthread_t tids[num_threads];
+    // --persistent: block SIGTERM/SIGINT and open the control socket before any thread exists.
+    // One padded counter slot per client thread; prints STATS lines every interval
+    if (server_control_init(&cfg, a1_ops.name) < 0 ||
+        server_stats_init(num_threads, cfg.stats_interval_ms) < 0) {
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
 
-    //ACCEPT N CLIENTS
-    for (int i = 0; i < num_threads; i++) {
+    //ACCEPT N CLIENTS (--persistent: until SIGTERM or SHUTDOWN)
+    for (int i = 0; server_keep_accepting(&cfg, i, listen_fd); i++) {
 
         conn_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &addr_len);
         if (conn_fd < 0) {
@@ -256,11 +230,27 @@ int main(int argc, char *argv[]) {
         inet_ntop(AF_INET, &client_addr.sin_addr, ip, INET_ADDRSTRLEN);
         printf("Client %d/%d from %s:%d\n", i+1, num_threads, ip, ntohs(client_addr.sin_port));
 
+        int slot = server_slot_acquire();
+        if (slot < 0) {
+            fprintf(stderr, "All %d stats slots are in use, closing client %d\n", num_threads, i+1);
+            close(conn_fd);
+            continue;
+        }
+
         struct thread_args *args = malloc(sizeof(struct thread_args));
         args->conn_fd = conn_fd;
         args->field_size = field_size;
+        args->slot = slot;
+        args->framed = cfg.framed;
     
-        pthread_create(&tids[i], NULL, client_thread, args);
+        // --pin / --cpus spread client threads round-robin over the chosen cores
+        int cpu = server_worker_cpu(&cfg, i);
+        if (server_thread_start(&cpu, slot, client_thread, args) != 0) {
+            fprintf(stderr, "Failed to create client thread %d\n", i+1);
+            close(conn_fd);
+            free(args);
+            continue;
+        }
 
     }
 
@@ -268,9 +258,9 @@ int main(int argc, char *argv[]) {
     printf("All clients connected, waiting...\n");
 
     //waiting fro all threads to finish execution...
-    for (int i = 0; i < num_threads; i++) {
-        pthread_join(tids[i], NULL);
-    }
+    server_threads_wait();
+    server_stats_finish(a1_ops.name);
+    server_control_close();
 
     printf("All done. Server exiting.\n");
     return 0;
@@ -14,68 +14,166 @@
 #include <errno.h>
 #include <time.h>
 #include <pthread.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <linux/errqueue.h>
+#include "MT25074_Part_A_Common.h"
+
+
+/*
+ * MSG_ZEROCOPY pipeline
+ *
+ * Every successful sendmsg(MSG_ZEROCOPY) gets the next value of a per-socket
+ * 32-bit counter. The kernel pins the user pages and later queues a
+ * notification on the socket error queue (MSG_ERRQUEUE) with the inclusive
+ * range [ee_info, ee_data] of calls it has finished with. If it had to fall
+ * back to copying anyway (e.g. loopback/veth delivery to a local socket) the
+ * notification carries SO_EE_CODE_ZEROCOPY_COPIED.
+ *
+ * The thread model keeps a small ring of mlock()ed response buffers per
+ * connection and only hands a slot out again once every call that used it
+ * has been released, so a buffer is never rewritten while the kernel may
+ * still be reading it.
+ */
 
+#define ZC_RING_SLOTS 8
+#define ZC_WAIT_MS 100          // poll() step while waiting for completions
+#define ZC_CLOSE_WAIT_MS 1000   // max wait for outstanding completions at close
+
+/* Process-wide counters (thread and epoll mode) */
+static atomic_ulong zc_calls;        // sendmsg(MSG_ZEROCOPY) calls that succeeded
+static atomic_ulong zc_completed;    // calls the kernel has released
+static atomic_ulong zc_copied;       // ... of which it reported SO_EE_CODE_ZEROCOPY_COPIED
+static atomic_ulong zc_fallbacks;    // plain sendmsg() after ENOBUFS with nothing left to reap
+
+struct zc_slot {
+    struct message *msg;
+    uint32_t first_seq;   // counter value of the first call that sent this slot
+    uint32_t issued;      // calls used for this slot
+    uint32_t pending;     // calls not yet released by the kernel
+};
 
-#define SERVER_IP "10.0.0.1"
-#define SERVER_PORT 8080
-#define BACKLOG 5
-#define NUM_FIELDS 8
-
-struct message {
-    char *fields[NUM_FIELDS];
+struct zc_ring {
+    struct zc_slot slots[ZC_RING_SLOTS];
+    int head;             // next slot to send
+    int enabled;          // SO_ZEROCOPY accepted; if not, sends copy and nothing is tracked
+    uint32_t next_seq;    // mirrors the kernel's per-socket counter
+    uint32_t outstanding; // sum of slot pending counts
+    uint64_t completed;   // per-connection copies of the global counters
+    uint64_t copied;
+    uint64_t fallbacks;
 };
 
-struct message* create_message(size_t field_size) {
-    struct message *msg = malloc(sizeof(struct message)); //memory for struct message which holds pointers to 8 string data
-    if (!msg) return NULL;
-    
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        msg->fields[i] = malloc(field_size); //allocating heap memory and storing address in string pointer field
-        if (!msg->fields[i]) {
-            for (int j = 0; j < i; j++) free(msg->fields[j]);
-            free(msg);
+static struct zc_ring* zc_ring_create(size_t field_size) {
+    struct zc_ring *ring = calloc(1, sizeof(*ring));
+    if (!ring) return NULL;
+
+    int locked = 1;
+    for (int i = 0; i < ZC_RING_SLOTS; i++) {
+        ring->slots[i].msg = create_message(field_size, 'S');  // Server pattern
+        if (!ring->slots[i].msg) {
+            for (int j = 0; j < i; j++) free_message(ring->slots[j].msg);
+            free(ring);
             return NULL;
         }
-        memset(msg->fields[i], 'S' + i, field_size);  // Server pattern
+        // Pin the slab so the pages stay resident for the whole run (best effort)
+        if (mlock(ring->slots[i].msg->slab, NUM_FIELDS * field_size) < 0) locked = 0;
     }
-    return msg;
+    if (!locked) printf("Server[Zero-Copy]: mlock of response ring failed, continuing unpinned\n");
+    return ring;
 }
 
-void free_message(struct message *msg) {
-    if (!msg) return;
-    for (int i = 0; i < NUM_FIELDS; i++) free(msg->fields[i]);
-    free(msg);
+static void zc_ring_free(struct zc_ring *ring, size_t field_size) {
+    if (!ring) return;
+    for (int i = 0; i < ZC_RING_SLOTS; i++) {
+        munlock(ring->slots[i].msg->slab, NUM_FIELDS * field_size);
+        free_message(ring->slots[i].msg);
+    }
+    free(ring);
 }
 
-ssize_t recv_all(int sockfd, void *buffer, size_t len) {
-    char *buf = buffer;
-    size_t total = 0;
-    while (total < len) {
-       ssize_t n = recv(sockfd, buf + total, len - total, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
+/* Marks the calls [lo, hi] as released in whichever slots used them (wrap-safe) */
+static void zc_ring_release(struct zc_ring *ring, uint32_t lo, uint32_t hi) {
+    uint32_t span = hi - lo;
+    for (int i = 0; i < ZC_RING_SLOTS && ring->outstanding > 0; i++) {
+        struct zc_slot *slot = &ring->slots[i];
+        for (uint32_t k = 0; k < slot->issued && slot->pending > 0; k++) {
+            if ((uint32_t)(slot->first_seq + k - lo) <= span) {
+                slot->pending--;
+                ring->outstanding--;
+            }
         }
-        if (n == 0) return total;  // Connection closed
-        total += n;
     }
-    return total;
 }
 
+/*
+ * Reads every notification currently on the error queue without blocking.
+ * ring may be NULL (epoll mode only counts). Returns notifications read.
+ */
+static int zc_reap(int sockfd, struct zc_ring *ring) {
+    int reaped = 0;
+    while (1) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+        struct msghdr msg = {
+            .msg_control = control,
+            .msg_controllen = sizeof(control)
+        };
+
+        int rc = recvmsg(sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+        stats_syscall();
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            return reaped;   // EAGAIN: queue is empty
+        }
 
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) continue;
 
-/* Zero-copy send using sendmsg() with MSG_ZEROCOPY */
-ssize_t sendmsg_zerocopy(int sockfd, const void *buffer, size_t len) {
-    struct iovec iov = {
-        .iov_base = (void*)buffer,
-        .iov_len = len
-    };
-    
+            struct sock_extended_err *serr = (struct sock_extended_err*)CMSG_DATA(cm);
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+            uint32_t lo = serr->ee_info, hi = serr->ee_data;
+            uint64_t n = (uint64_t)(hi - lo) + 1;
+            int copied = (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+
+            atomic_fetch_add(&zc_completed, n);
+            if (copied) atomic_fetch_add(&zc_copied, n);
+            if (ring) {
+                ring->completed += n;
+                if (copied) ring->copied += n;
+                zc_ring_release(ring, lo, hi);
+            }
+            reaped++;
+        }
+    }
+}
+
+/* Blocks (in ZC_WAIT_MS steps, up to max_ms; -1 = forever) until something is reaped */
+static int zc_wait_and_reap(int sockfd, struct zc_ring *ring, int max_ms) {
+    int waited = 0;
+    while (max_ms < 0 || waited < max_ms) {
+        // POLLERR is reported whenever the error queue is non-empty
+        struct pollfd pfd = { .fd = sockfd, .events = 0 };
+        int r = poll(&pfd, 1, ZC_WAIT_MS);
+        stats_syscall();
+        if (r < 0 && errno != EINTR) return -1;
+        int reaped = zc_reap(sockfd, ring);
+        if (reaped > 0) return reaped;
+        waited += ZC_WAIT_MS;
+    }
+    return 0;
+}
+
+/* Zero-copy send using sendmsg() with MSG_ZEROCOPY over the 8 field iovecs */
+ssize_t sendmsg_zerocopy(int sockfd, struct iovec *iov, int iovcnt) {
     struct msghdr msg = {
         .msg_name = NULL,
         .msg_namelen = 0,
-        .msg_iov = &iov,
-        .msg_iovlen = 1,
+        .msg_iov = iov,
+        .msg_iovlen = iovcnt,
         .msg_control = NULL,
         .msg_controllen = 0,
         .msg_flags = 0
@@ -83,35 +181,149 @@ ssize_t sendmsg_zerocopy(int sockfd, const void *buffer, size_t len) {
     
     /* MSG_ZEROCOPY: Enable zero-copy mode */
     ssize_t n = sendmsg(sockfd, &msg, MSG_ZEROCOPY);
-    
-    if (n < 0) {
-        if (errno == ENOBUFS) {
-            /* Fallback to normal sendmsg if zerocopy buffers exhausted */
-            return sendmsg(sockfd, &msg, 0);
+    if (n >= 0) {
+        atomic_fetch_add(&zc_calls, 1);
+        return n;
+    }
+
+    if (errno == ENOBUFS) {
+        /* Notification memory (optmem) is full: reap completions first and retry */
+        if (zc_reap(sockfd, NULL) > 0) {
+            n = sendmsg(sockfd, &msg, MSG_ZEROCOPY);
+            if (n >= 0) {
+                atomic_fetch_add(&zc_calls, 1);
+                return n;
+            }
+            if (errno != ENOBUFS) return -1;
         }
-        return -1;
+        /* Still exhausted: copy this one and count it */
+        atomic_fetch_add(&zc_fallbacks, 1);
+        return sendmsg(sockfd, &msg, 0);
     }
-    
-    return n;
+    return -1;
 }
 
-/* Send all data with zero-copy */
-ssize_t sendmsg_zerocopy_all(int sockfd, const void *buffer, size_t len) {
-    const char *buf = buffer;
+/*
+ * Sends one whole response from the next ring slot, waiting for the kernel to
+ * release that slot first. Returns bytes sent or -1.
+ */
+static ssize_t zc_ring_send(int sockfd, struct zc_ring *ring) {
+
+    struct zc_slot *slot = &ring->slots[ring->head];
+
+    // Never reuse a buffer the kernel may still be reading
+    while (slot->pending > 0) {
+        if (zc_wait_and_reap(sockfd, ring, -1) < 0) return -1;
+    }
+
+    struct iovec iov_store[NUM_FIELDS];
+    struct iovec *iov = iov_store;
+    int iovcnt = message_iov(slot->msg, 0, iov);
     size_t total = 0;
-    
-    while (total < len) {
-        ssize_t n = sendmsg_zerocopy(sockfd, buf + total, len - total);
-        if (n < 0) {
+
+    slot->first_seq = ring->next_seq;
+    slot->issued = 0;
+
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iovcnt };
+    while (iovcnt > 0) {
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+
+        ssize_t n = sendmsg(sockfd, &msg, ring->enabled ? MSG_ZEROCOPY : 0);
+        stats_syscall();
+        if (n < 0 && !ring->enabled) {
             if (errno == EINTR) continue;
-            perror("sendmsg zerocopy failed");
             return -1;
         }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != ENOBUFS) return -1;
+            if (ring->outstanding > 0) {
+                // Out of notification memory: wait for completions, then retry
+                if (zc_wait_and_reap(sockfd, ring, -1) < 0) return -1;
+                continue;
+            }
+            // Nothing left to reap: copy this chunk and count it
+            n = sendmsg(sockfd, &msg, 0);
+            stats_syscall();
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            ring->fallbacks++;
+            atomic_fetch_add(&zc_fallbacks, 1);
+        } else if (ring->enabled) {
+            ring->next_seq++;
+            slot->issued++;
+            slot->pending++;
+            ring->outstanding++;
+            atomic_fetch_add(&zc_calls, 1);
+        }
+
         total += n;
+        size_t done = n;
+        while (iovcnt > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
     }
+
+    ring->head = (ring->head + 1) % ZC_RING_SLOTS;
+
+    // Opportunistically pick up whatever has completed so the queue stays short
+    if (ring->outstanding > 0) zc_reap(sockfd, ring);
     return total;
 }
 
+/*
+ * Enable SO_ZEROCOPY on socket for notification handling. Returns 0 if the
+ * kernel refused it: MSG_ZEROCOPY sends are then plain copies and no
+ * completion will ever be queued, so nothing may wait for one.
+ */
+static int enable_zerocopy(int sockfd) {
+    int enable = 1;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0) return 1;
+    printf("Server[Zero-Copy]: SO_ZEROCOPY refused (%s), sending with copies\n", strerror(errno));
+    return 0;
+}
+
+/* Epoll and framed mode never wait for completions, so a refusal only needs the message */
+static void setup_zerocopy_conn(int sockfd) {
+    enable_zerocopy(sockfd);
+}
+
+/* Epoll mode: EPOLLERR means notifications are waiting, just count them */
+static void drain_zerocopy(int sockfd) {
+    zc_reap(sockfd, NULL);
+}
+
+static void print_zerocopy_summary(const char *who, uint64_t calls, uint64_t completed,
+                                   uint64_t copied, uint64_t fallbacks) {
+    printf("%s: zerocopy calls=%lu released=%lu zero-copy=%lu kernel-copied=%lu "
+           "enobufs-fallback=%lu\n", who, calls, completed, completed - copied, copied, fallbacks);
+}
+
+/*
+ * Receive side is an ordinary copying readv(). In epoll mode the response slab
+ * is shared and never rewritten, so it needs no ring; completions are still
+ * drained (and counted) on every EPOLLERR.
+ */
+static const struct server_ops a3_ops = {
+    .name = "A3 Zero-Copy",
+    .setup_conn = setup_zerocopy_conn,
+    .teardown_conn = NULL,
+    .conn_errqueue = drain_zerocopy,
+    .create_response = NULL,
+    .recv_some = readv_some,
+    .send_some = sendmsg_zerocopy
+};
+
+
 /************************************************/
 
 //THREAD HANDLING FOR THE CLIENTS
@@ -120,29 +332,43 @@ ssize_t sendmsg_zerocopy_all(int sockfd, const void *buffer, size_t len) {
 struct thread_args{
     int conn_fd;
     size_t field_size;
+    int slot;          // this thread's stats slot (server_slot_acquire)
+    int framed;        // --framed: length-prefixed messages of any size up to field_size
 };
 
 void* client_thread(void* arg) {
 
     struct thread_args *args = (struct thread_args*)arg;
+    server_stats_bind(args->slot);
 
-    /* Enable SO_ZEROCOPY on socket for notification handling */
-    int enable = 1;
-    setsockopt(args->conn_fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable));
+    int zerocopy_on = enable_zerocopy(args->conn_fd);
+
+    if (args->framed) {
+        // Framed responses go out of one never-rewritten slab, as in epoll mode
+        serve_framed_conn(args->conn_fd, args->field_size, &a3_ops);
+        server_stats_conn_closed(args->conn_fd);
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
 
 
-    // Server's response message (created once, sent repeatedly)
-    struct message *response_msg = create_message(args->field_size);
+    // Server's response buffers: a ring of pinned slabs recycled only after completion
+    struct zc_ring *response_ring = zc_ring_create(args->field_size);
     // Buffer to receive client request
-    struct message *request_buffer = create_message(args->field_size);
+    struct message *request_buffer = create_message(args->field_size, 'S');
     
-    if (!response_msg || !request_buffer) {
+    if (!response_ring || !request_buffer) {
+        zc_ring_free(response_ring, args->field_size);
+        free_message(request_buffer);
         close(args->conn_fd);
         free(args);
         return NULL;
     }
+    response_ring->enabled = zerocopy_on;
 
     uint64_t msg_count = 0; 
+    size_t msg_bytes = NUM_FIELDS * args->field_size;
     
     // ==================== REPEATED TRANSFERS ====================
     // Server transfers repeatedly until client closes connection
@@ -152,40 +378,47 @@ void* client_thread(void* arg) {
     
     while (1) {
         
-        // STEP 1: Receive all 8 fields from client (request)
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            ssize_t n = recv_all(args->conn_fd, request_buffer->fields[i], args->field_size);
-            
-            if (n == 0 && i == 0) {
-                // Client closed connection cleanly
-                printf("Server[Zero-Copy]: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
-                goto cleanup;
-            }
-    
-            if (n != args->field_size) {
-                printf("Server[Zero-Copy]: Receive error or partial (%zd/%zu)\n", n, args->field_size);
-                goto cleanup;
-            }
+        // STEP 1: Receive all 8 fields from client (request) - one vectored call per attempt
+        struct iovec iov[NUM_FIELDS];
+        int cnt = message_iov(request_buffer, 0, iov);
+        ssize_t n = iov_transfer_all(args->conn_fd, iov, cnt, a3_ops.recv_some);
+
+        if (n == 0) {
+            // Client closed connection cleanly
+            printf("Server[Zero-Copy]: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
+            goto cleanup;
+        }
+
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server[Zero-Copy]: Receive error or partial (%zd/%zu)\n", n, msg_bytes);
+            goto cleanup;
         }
         
         // STEP 2: Send all 8 fields back to client (response)
         // This is the "transfer" - server responds with fixed-size message
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            ssize_t n = sendmsg_zerocopy_all(args->conn_fd, response_msg->fields[i], args->field_size);
-            if (n != args->field_size) {
-                printf("Server: Send failed\n");
-                goto cleanup;
-            }
+        n = zc_ring_send(args->conn_fd, response_ring);
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Send failed\n");
+            goto cleanup;
         }
         
         msg_count++;
+        server_stats_message(2 * msg_bytes);  // request + response payload
         
 
     }
     
 cleanup:
-    free_message(response_msg);
+    // Collect the remaining completions so the counters cover every call
+    while (response_ring->outstanding > 0) {
+        if (zc_wait_and_reap(args->conn_fd, response_ring, ZC_CLOSE_WAIT_MS) <= 0) break;
+    }
+    print_zerocopy_summary("Server[Zero-Copy]", response_ring->next_seq, response_ring->completed,
+                           response_ring->copied, response_ring->fallbacks);
+
+    zc_ring_free(response_ring, args->field_size);
     free_message(request_buffer);
+    server_stats_conn_closed(args->conn_fd);
     close(args->conn_fd);
     free(args);
     return NULL;
@@ -196,20 +429,22 @@ cleanup:
 
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <field_size> <num_threads>\n", argv[0]);        exit(1);
-        fprintf(stderr, "Got %d arguments\n", argc-1);
-        for (int i = 1; i < argc; i++) {
-            fprintf(stderr, "  arg[%d]: %s\n", i, argv[i]);
-        }
-        
+    struct server_config cfg;
+    if (parse_server_args(argc, argv, &cfg) < 0) {
         exit(1);
     }
     
-    size_t field_size = atoi(argv[1]);
-    int num_threads = atoi(argv[2]);
+    size_t field_size = cfg.field_size;
+    int num_threads = cfg.num_clients;
+
+    // Event-loop mode: the reactor creates its own listeners, so hand over here
+    if (cfg.mode == SERVER_MODE_EPOLL) {
+        int rc = run_epoll_server(&cfg, &a3_ops);
+        print_zerocopy_summary("Server[Zero-Copy] total", atomic_load(&zc_calls), atomic_load(&zc_completed),
+                               atomic_load(&zc_copied), atomic_load(&zc_fallbacks));
+        return rc == 0 ? 0 : 1;
+    }
 
- 
     printf("Server [ZERO-COPY with sendmsg()]: field_size=%zu, accepting %d clients\n", 
            field_size, num_threads);
     printf("Using sendmsg() with MSG_ZEROCOPY flag\n");
@@ -274,6 +509,7 @@ int main(int argc, char *argv[]) {
     }
 
     printf("Server Listening on %s:%d\n", SERVER_IP, SERVER_PORT);
+    fflush(stdout);  // the benchmark driver waits for this line before starting clients
 
 
 
@@ -284,10 +520,16 @@ int main(int argc, char *argv[]) {
     printf("Waiting for client connection...\n"); //Starting the accepting and handhaking connection process
 
 
-    pthread_t tids[num_threads];
+    // --persistent: block SIGTERM/SIGINT and open the control socket before any thread exists.
+    // One padded counter slot per client thread; prints STATS lines every interval
+    if (server_control_init(&cfg, a3_ops.name) < 0 ||
+        server_stats_init(num_threads, cfg.stats_interval_ms) < 0) {
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
 
-    //ACCEPT N CLIENTS
-    for (int i = 0; i < num_threads; i++) {
+    //ACCEPT N CLIENTS (--persistent: until SIGTERM or SHUTDOWN)
+    for (int i = 0; server_keep_accepting(&cfg, i, listen_fd); i++) {
 
         conn_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &addr_len);
         if (conn_fd < 0) {
@@ -301,11 +543,27 @@ int main(int argc, char *argv[]) {
         inet_ntop(AF_INET, &client_addr.sin_addr, ip, INET_ADDRSTRLEN);
         printf("Client %d/%d from %s:%d\n", i+1, num_threads, ip, ntohs(client_addr.sin_port));
 
+        int slot = server_slot_acquire();
+        if (slot < 0) {
+            fprintf(stderr, "All %d stats slots are in use, closing client %d\n", num_threads, i+1);
+            close(conn_fd);
+            continue;
+        }
+
         struct thread_args *args = malloc(sizeof(struct thread_args));
         args->conn_fd = conn_fd;
         args->field_size = field_size;
+        args->slot = slot;
+        args->framed = cfg.framed;
     
-        pthread_create(&tids[i], NULL, client_thread, args);
+        // --pin / --cpus spread client threads round-robin over the chosen cores
+        int cpu = server_worker_cpu(&cfg, i);
+        if (server_thread_start(&cpu, slot, client_thread, args) != 0) {
+            fprintf(stderr, "Failed to create client thread %d\n", i+1);
+            close(conn_fd);
+            free(args);
+            continue;
+        }
 
     }
 
@@ -313,10 +571,12 @@ int main(int argc, char *argv[]) {
     printf("All clients connected, waiting...\n");
 
     //waiting fro all threads to finish execution...
-    for (int i = 0; i < num_threads; i++) {
-        pthread_join(tids[i], NULL);
-    }
+    server_threads_wait();
+    server_stats_finish(a3_ops.name);
+    server_control_close();
 
+    print_zerocopy_summary("Server[Zero-Copy] total", atomic_load(&zc_calls), atomic_load(&zc_completed),
+                           atomic_load(&zc_copied), atomic_load(&zc_fallbacks));
     printf("All done. Server exiting.\n");
     return 0;
 
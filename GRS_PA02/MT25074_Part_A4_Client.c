@@ -0,0 +1,207 @@
+/* 
+ * Roll Number: MT25074
+ * MT25074_Part_A4_Client.c
+ * io_uring TCP Client - registered buffers, fixed files, batched field sends
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <time.h>
+#include "MT25074_Part_A_Common.h"
+#include "MT25074_Part_A_Uring.h"
+#include "MT25074_Part_A_Histogram.h"
+
+int main(int argc, char *argv[]) {
+    
+    // --send-zc switches requests to IORING_OP_SEND_ZC
+    struct client_config cfg;
+    if (parse_client_args(argc, argv, &cfg) < 0) {
+        exit(1);
+    }
+    // The uring path submits one request batch and waits for its response
+    if (cfg.depth != 1) {
+        fprintf(stderr, "A4 client supports only --depth 1\n");
+        exit(1);
+    }
+    if (cfg.zc_recv) {
+        fprintf(stderr, "A4 client receives through io_uring; --zc-recv is not supported\n");
+        exit(1);
+    }
+    if (cfg.framed) {
+        fprintf(stderr, "A4 client sends fixed-size messages; --framed/--sizes are not supported\n");
+        exit(1);
+    }
+
+    int send_zc = cfg.send_zc;
+    size_t field_size = cfg.field_size;
+    int port = SERVER_PORT;
+    int duration = cfg.duration;
+    
+    
+    printf("Client: Server=%s:%d, field_size=%zu, duration=%ds\n", SERVER_IP, port, field_size, duration);
+  
+
+    int sock_fd;
+    struct sockaddr_in server_addr; 
+
+    /************************************************/
+
+    //STEP 1: CREATE A CLIENT SOCKET
+    sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock_fd < 0) {
+        perror("Socket creation failed");
+        exit(EXIT_FAILURE);
+    }
+    printf("Socket created successfully (fd: %d)\n", sock_fd);
+
+
+    /************************************************/
+
+    //STEP 2: PREPARE SERVER ADDRESS
+
+    memset(&server_addr, 0, sizeof(server_addr)); //intialise struct to zeroes
+    server_addr.sin_family = AF_INET; //set address family type as IP NET
+    server_addr.sin_port = htons(port);
+
+    //convert IP string to binary form
+    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+        perror("Inet_pton function failed");
+        close(sock_fd);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /************************************************/
+
+    //STEP 3: CONNECT TO OUR SERVER BY BLOCKING THE PROGRAM UNTIL CONNECTION ESTABLISH/FAILS
+
+    printf("Attempting to connect to %s:%d...\n", SERVER_IP, SERVER_PORT);
+    if (connect(sock_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("Connect function failed at client side");
+        close(sock_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    // Connection Established Successfully !!
+    printf("Connected to server successfully!\n");
+    printf("  Server IP: %s\n", SERVER_IP);
+    printf("  Seerver Poort: %d\n", SERVER_PORT);
+    printf("  Client socket fd: %d\n", sock_fd);
+
+
+    
+    /************************************************/
+
+    //STEP 5: SEND AND RECIEVE DATA
+
+    struct message *send_msg = create_message(field_size, 'C');  // Client pattern
+    struct message *recv_msg = create_message(field_size, 'C');  // Client pattern
+    
+    if (!send_msg || !recv_msg) {
+        perror("Failed to allocate messages");
+        exit(1);
+    }
+
+    struct uring_conn uc;
+    if (uring_conn_init(&uc, sock_fd, send_msg, recv_msg, send_zc) < 0) {
+        perror("io_uring setup failed");
+        exit(1);
+    }
+    
+    // ==================== FIXED DURATION TRANSFER ====================
+    // CLIENT controls the duration - sends continuously for fixed time.
+    // A timerfd thread flips the run phase; only the MEASURE window is counted.
+    
+    uint64_t messages_sent = 0;      // every round trip, warm-up included (matches the server)
+    uint64_t messages_measured = 0;  // round trips completed inside the measured window
+    uint64_t total_bytes = 0;
+    size_t msg_bytes = NUM_FIELDS * field_size;
+    
+    // Round-trip latency histogram (fixed size, static so it is off the stack)
+    static struct latency_hist hist;
+    hist_init(&hist);
+    
+    printf("Starting transfer: %ds warm-up + %d measured seconds...\n", cfg.warmup, duration);
+    
+    // This thread's counters, switched on only inside the measured window
+    struct perf_counters perf;
+    perf_counters_open(&perf);
+    
+    struct run_deadline dl;
+    if (run_deadline_start(&dl, cfg.warmup, duration) < 0) {
+        exit(1);
+    }
+    
+    // Send continuously until time expires
+    while (run_phase(&dl) != RUN_STOP) {
+        perf_counters_track(&perf, run_phase(&dl) == RUN_MEASURE);
+        uint64_t t0 = hist_now_ns();
+        
+        // Send request: all 8 fields as one linked batch of SQEs
+        if (uring_send_message(&uc) != (ssize_t)msg_bytes) {
+            perror("Send failed");
+            break;
+        }
+        
+        // Receive response: all 8 fields (server's repeated transfer) via registered buffer
+        if (uring_recv_message(&uc) != (ssize_t)msg_bytes) {
+            printf("Server closed connection unexpectedly\n");
+            break;
+        }
+        
+        messages_sent++;
+        if (run_phase(&dl) == RUN_MEASURE) {
+            hist_record(&hist, hist_now_ns() - t0);
+            messages_measured++;
+            total_bytes += (msg_bytes * 2);  // Request + response
+        }
+    }
+    perf_counters_track(&perf, 0);
+    double elapsed = run_deadline_finish(&dl);
+    
+    // Time's up - client initiates close
+    printf("Time limit reached (%d seconds, %.6f s measured)\n", duration, elapsed);
+    printf("Messages exchanged: %lu\n", messages_sent);
+    printf("Messages measured: %lu (warm-up excluded)\n", messages_measured);
+    if (elapsed > 0) {
+        printf("Throughput: %.2f Mbps (%.0f msgs/s)\n",
+               (total_bytes * 8.0) / (elapsed * 1000000.0), messages_measured / elapsed);
+    }
+    hist_print_summary(&hist);
+    uint64_t counts[PERF_NUM_EVENTS] = {0};
+    perf_counters_read(&perf, counts);
+    perf_counters_close(&perf);
+    char perf_line[256];
+    perf_format_line("client", send_zc ? "A4ZC" : "A4", counts, messages_measured, perf_line, sizeof(perf_line));
+    fputs(perf_line, stdout);
+    if (cfg.latency_csv) hist_write_csv(&hist, cfg.latency_csv, send_zc ? "A4ZC" : "A4");
+    
+
+    uring_conn_destroy(&uc);
+    printf("io_uring_enter calls: %lu\n", uc.submits);
+    if (send_zc) printf("send_zc zero-copy=%lu kernel-copied=%lu\n", uc.zc_sends, uc.zc_copied);
+
+    free_message(send_msg);
+    free_message(recv_msg);
+    
+    // CLIENT closes connection - this signals server to stop
+    printf("Closing connection...\n");
+
+
+
+    /************************************************/
+
+    //STEP 6: CLEAN UP / CLOSE THE SOCKETS FILES / FREE UP BUFFERS ETC..
+    close(sock_fd);
+    printf("Client shutting down...\n");
+    
+    return 0;
+    
+
+}
\ No newline at end of file
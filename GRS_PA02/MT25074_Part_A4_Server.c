@@ -0,0 +1,269 @@
+/* 
+ * Roll Number: MT25074
+ * MT25074_Part_A4_Server.c
+ * io_uring TCP Server - registered buffers, fixed files, batched field sends
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "MT25074_Part_A_Common.h"
+#include "MT25074_Part_A_Uring.h"
+
+
+/************************************************/
+
+//THREAD HANDLING FOR THE CLIENTS
+
+
+struct thread_args{
+    int conn_fd;
+    size_t field_size;
+    int slot;          // this thread's stats slot (server_slot_acquire)
+    int send_zc;
+};
+
+void* client_thread(void* arg) {
+
+    struct thread_args *args = (struct thread_args*)arg;
+    server_stats_bind(args->slot);
+
+    // Server's response message (created once, sent repeatedly)
+    struct message *response_msg = create_message(args->field_size, 'S');
+    // Buffer to receive client request
+    struct message *request_buffer = create_message(args->field_size, 'S');
+    
+    // Each connection gets its own ring; the socket and both slabs are registered with it
+    struct uring_conn uc;
+    if (!response_msg || !request_buffer ||
+        uring_conn_init(&uc, args->conn_fd, response_msg, request_buffer, args->send_zc) < 0) {
+        if (response_msg && request_buffer) perror("io_uring setup failed");
+        free_message(response_msg);
+        free_message(request_buffer);
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
+
+    uint64_t msg_count = 0; 
+    uint64_t counted_submits = uc.submits;   // setup submits are not per-message cost
+    size_t msg_bytes = NUM_FIELDS * args->field_size;
+    
+    // ==================== REPEATED TRANSFERS ====================
+    // Server transfers repeatedly until client closes connection
+    // NO TIME LIMIT on server side - just responds to each client message
+    
+    while (1) {
+        
+        // STEP 1: Receive all 8 fields from client (request) - registered-buffer reads
+        ssize_t n = uring_recv_message(&uc);
+
+        if (n == 0) {
+            // Client closed connection cleanly
+            printf("Server[io_uring]: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
+            goto cleanup;
+        }
+
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server[io_uring]: Receive error or partial (%zd/%zu)\n", n, msg_bytes);
+            goto cleanup;
+        }
+        
+        // STEP 2: Send all 8 fields back to client (response)
+        // 8 linked SQEs, one io_uring_enter() for the whole batch
+        n = uring_send_message(&uc);
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server[io_uring]: Send failed\n");
+            goto cleanup;
+        }
+        
+        msg_count++;
+        server_stats_message(2 * msg_bytes);  // request + response payload
+        // Every io_uring_enter() this round trip took is this connection's syscall cost
+        struct stats_slot *slot = stats_owned_slot();
+        if (slot) stats_add(&slot->syscalls, uc.submits - counted_submits);
+        counted_submits = uc.submits;
+        
+
+    }
+    
+cleanup:
+    uring_conn_destroy(&uc);
+    printf("Server[io_uring]: io_uring_enter calls=%lu", uc.submits);
+    if (args->send_zc) {
+        printf(" send_zc zero-copy=%lu kernel-copied=%lu", uc.zc_sends, uc.zc_copied);
+    }
+    printf("\n");
+
+    free_message(response_msg);
+    free_message(request_buffer);
+    server_stats_conn_closed(args->conn_fd);
+    close(args->conn_fd);
+    free(args);
+    return NULL;
+}
+
+
+
+
+
+int main(int argc, char *argv[]) {
+    struct server_config cfg;
+    if (parse_server_args(argc, argv, &cfg) < 0) {
+        exit(1);
+    }
+    
+    size_t field_size = cfg.field_size;
+    int num_threads = cfg.num_clients;
+
+    // io_uring already batches and completes asynchronously; the epoll reactor has no A4 hooks
+    if (cfg.mode == SERVER_MODE_EPOLL) {
+        fprintf(stderr, "A4 (io_uring) supports --mode thread only\n");
+        exit(1);
+    }
+    // Fixed-size linked SQEs; there is no header stage to read the length from
+    if (cfg.framed) {
+        fprintf(stderr, "A4 (io_uring) does not support --framed\n");
+        exit(1);
+    }
+
+    printf("Server [io_uring]: field_size=%zu, accepting %d clients, send=%s\n", field_size, num_threads,
+           cfg.send_zc ? "IORING_OP_SEND_ZC" : "IORING_OP_WRITE_FIXED");
+
+
+
+    int listen_fd, conn_fd; //Listening socket file, Connection Established Socket file
+    struct sockaddr_in server_addr, client_addr; //structs holding server socket , client socket addresses
+    socklen_t addr_len  = sizeof(client_addr); //holds the size of (SockAddress Struct) which is the maximum client address size possible
+
+
+    /************************************************/
+
+    //STEP 1: CREATE A LISTENING SOCKET
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if(listen_fd < 0){
+        perror("server socket creation failed "); //creation failed
+    }
+    printf("Socket created successfully (fd: %d)\n", listen_fd); //Success Heres the socket fd 
+
+
+
+    /************************************************/
+
+    //STEP 2: BIND THE LISTENING SOCKET TO ADDRESS AND PORT
+
+    //Create the IP address structure
+    memset(&server_addr, 0, sizeof(server_addr)); //initialise the address structure to zeroes for safety
+    server_addr.sin_family = AF_INET; //address family domain is IP internet
+    server_addr.sin_port = htons(SERVER_PORT); // host byte order to network byte order
+
+    //Convert IP address string to Binary form
+    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+        perror("inet_pton failed to convert server IP structure to Binary form");
+        close(listen_fd);   //close if pton function fails and exit the program
+        exit(EXIT_FAILURE);
+    }
+
+    //Bind our listening socket to this binary form address   
+    if (bind(listen_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("BInd failed to listening socket");
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Socket bound to %s:%d\n", SERVER_IP, SERVER_PORT);
+
+
+
+    /************************************************/
+
+    //STEP 3: LISTEN FOR INCOMING CONNECTIONS FROM OUR LISTENING SOCKET
+
+    if (listen(listen_fd, BACKLOG)) {   //backlog is a limit number for pending connection requests
+        perror("Listening function failed for the server listening socket");
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Server Listening on %s:%d\n", SERVER_IP, SERVER_PORT);
+    fflush(stdout);  // the benchmark driver waits for this line before starting clients
+
+
+
+    /************************************************/
+
+    //STEP 4: ACCEPT AN INCOMING CONNECTION IF AVAIALABLE BY BLOCKING EVERYTHING AND TCP CONNECT
+
+    printf("Waiting for client connection...\n"); //Starting the accepting and handhaking connection process
+
+
+    // --persistent: block SIGTERM/SIGINT and open the control socket before any thread exists.
+    // One padded counter slot per client thread; prints STATS lines every interval
+    if (server_control_init(&cfg, cfg.send_zc ? "A4 io_uring send_zc" : "A4 io_uring") < 0 ||
+        server_stats_init(num_threads, cfg.stats_interval_ms) < 0) {
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    //ACCEPT N CLIENTS (--persistent: until SIGTERM or SHUTDOWN)
+    for (int i = 0; server_keep_accepting(&cfg, i, listen_fd); i++) {
+
+        conn_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &addr_len);
+        if (conn_fd < 0) {
+            perror("Accept failed");
+            continue; //Try next client on the queue
+            // close(listen_fd);
+            // exit(EXIT_FAILURE);
+        }
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, ip, INET_ADDRSTRLEN);
+        printf("Client %d/%d from %s:%d\n", i+1, num_threads, ip, ntohs(client_addr.sin_port));
+
+        int slot = server_slot_acquire();
+        if (slot < 0) {
+            fprintf(stderr, "All %d stats slots are in use, closing client %d\n", num_threads, i+1);
+            close(conn_fd);
+            continue;
+        }
+
+        struct thread_args *args = malloc(sizeof(struct thread_args));
+        args->conn_fd = conn_fd;
+        args->field_size = field_size;
+        args->slot = slot;
+        args->send_zc = cfg.send_zc;
+    
+        // --pin / --cpus spread client threads round-robin over the chosen cores
+        int cpu = server_worker_cpu(&cfg, i);
+        if (server_thread_start(&cpu, slot, client_thread, args) != 0) {
+            fprintf(stderr, "Failed to create client thread %d\n", i+1);
+            close(conn_fd);
+            free(args);
+            continue;
+        }
+
+    }
+
+    close(listen_fd);
+    printf("All clients connected, waiting...\n");
+
+    //waiting fro all threads to finish execution...
+    server_threads_wait();
+    server_stats_finish(cfg.send_zc ? "A4 io_uring send_zc" : "A4 io_uring");
+    server_control_close();
+
+    printf("All done. Server exiting.\n");
+    return 0;
+
+    
+}
\ No newline at end of file
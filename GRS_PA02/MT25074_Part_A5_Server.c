@@ -0,0 +1,338 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A5_Server.c
+ * sendfile() server: responses served from a page-cache backed file
+ */
+
+#define _GNU_SOURCE  // memfd_create
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "MT25074_Part_A_Common.h"
+
+
+/*
+ * The response is written once at startup into a memfd (shmem, i.e. page
+ * cache pages) and sent with sendfile(): the kernel attaches those pages to
+ * the socket buffers instead of copying from a user buffer. The file is also
+ * mapped read-only and the response message's fields point into the mapping,
+ * so an iovec base handed to send_some maps straight back to a file offset.
+ * Requests are still received with readv().
+ */
+static int response_fd = -1;
+static char *response_map;      // MAP_SHARED view of response_fd
+static size_t response_len;     // NUM_FIELDS * field_size
+
+static int response_file_init(size_t field_size) {
+
+    struct message *src = create_message(field_size, 'S');  // Server pattern
+    if (!src) return -1;
+    response_len = NUM_FIELDS * field_size;
+
+    response_fd = memfd_create("a5_response", MFD_CLOEXEC);
+    if (response_fd < 0) {
+        perror("memfd_create failed");
+        free_message(src);
+        return -1;
+    }
+    size_t done = 0;
+    while (done < response_len) {
+        ssize_t n = write(response_fd, src->slab + done, response_len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            perror("Writing the response file failed");
+            free_message(src);
+            return -1;
+        }
+        done += n;
+    }
+    free_message(src);
+
+    response_map = mmap(NULL, response_len, PROT_READ, MAP_SHARED, response_fd, 0);
+    if (response_map == MAP_FAILED) {
+        perror("mmap of the response file failed");
+        return -1;
+    }
+    return 0;
+}
+
+// Response message whose fields are views into the file mapping. Only the
+// header is allocated, so free_message() leaves the mapping alone.
+static struct message* file_response(size_t field_size) {
+    struct message *msg = malloc(sizeof(*msg));
+    if (!msg) return NULL;
+    msg->mapped = 0;
+    msg->field_size = field_size;
+    msg->slab = response_map;
+    for (int i = 0; i < NUM_FIELDS; i++) msg->fields[i] = response_map + i * field_size;
+    return msg;
+}
+
+static ssize_t sendfile_some(int sockfd, struct iovec *iov, int iovcnt) {
+    // The fields are back to back in the file, so the rest of the response is one range
+    off_t offset = (char*)iov[0].iov_base - response_map;
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    return sendfile(sockfd, response_fd, &offset, len);
+}
+
+static const struct server_ops a5_ops = {
+    .name = "A5 Sendfile",
+    .setup_conn = NULL,
+    .teardown_conn = NULL,
+    .conn_errqueue = NULL,
+    .create_response = file_response,
+    .recv_some = readv_some,
+    .send_some = sendfile_some
+};
+
+
+/************************************************/
+
+//THREAD HANDLING FOR THE CLIENTS
+
+
+struct thread_args{
+    int conn_fd;
+    size_t field_size;
+    int slot;          // this thread's stats slot (server_slot_acquire)
+    int framed;        // --framed: length-prefixed messages of any size up to field_size
+};
+
+void* client_thread(void* arg) {
+
+    struct thread_args *args = (struct thread_args*)arg;
+    server_stats_bind(args->slot);
+
+    if (args->framed) {
+        serve_framed_conn(args->conn_fd, args->field_size, &a5_ops);
+        server_stats_conn_closed(args->conn_fd);
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
+
+    // Server's response message (created once, sent repeatedly)
+    struct message *response_msg = file_response(args->field_size);
+    // Buffer to receive client request
+    struct message *request_buffer = create_message(args->field_size, 'S');
+    
+    if (!response_msg || !request_buffer) {
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
+
+    uint64_t msg_count = 0; 
+    size_t msg_bytes = NUM_FIELDS * args->field_size;
+    
+    // ==================== REPEATED TRANSFERS ====================
+    // Server transfers repeatedly until client closes connection
+    // NO TIME LIMIT on server side - just responds to each client message
+    
+    while (1) {
+        
+        // STEP 1: Receive all 8 fields from client (request) - one vectored call per attempt
+        struct iovec iov[NUM_FIELDS];
+        int cnt = message_iov(request_buffer, 0, iov);
+        ssize_t n = iov_transfer_all(args->conn_fd, iov, cnt, a5_ops.recv_some);
+
+        if (n == 0) {
+            // Client closed connection cleanly
+            printf("Server: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
+            goto cleanup;
+        }
+
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Receive error or partial (%zd/%zu)\n", n, msg_bytes);
+            goto cleanup;
+        }
+        
+        // STEP 2: Send all 8 fields back to client (response)
+        // This is the "transfer" - server responds with fixed-size message
+        cnt = message_iov(response_msg, 0, iov);
+        n = iov_transfer_all(args->conn_fd, iov, cnt, a5_ops.send_some);
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Send failed\n");
+            goto cleanup;
+        }
+        
+        msg_count++;
+        server_stats_message(2 * msg_bytes);  // request + response payload
+        
+
+    }
+    
+cleanup:
+    free_message(response_msg);
+    free_message(request_buffer);
+    server_stats_conn_closed(args->conn_fd);
+    close(args->conn_fd);
+    free(args);
+    return NULL;
+}
+
+
+
+
+
+int main(int argc, char *argv[]) {
+    struct server_config cfg;
+    if (parse_server_args(argc, argv, &cfg) < 0) {
+        exit(1);
+    }
+    
+    size_t field_size = cfg.field_size;
+    int num_threads = cfg.num_clients;
+
+    // One response file for the whole server, shared read-only by every connection
+    if (response_file_init(cfg.field_size) < 0) {
+        exit(1);
+    }
+
+    // Event-loop mode: the reactor creates its own listeners, so hand over here
+    if (cfg.mode == SERVER_MODE_EPOLL) {
+        return run_epoll_server(&cfg, &a5_ops) == 0 ? 0 : 1;
+    }
+
+    printf("Server: field_size=%zu, accepting %d clients\n", field_size, num_threads);
+
+
+
+    int listen_fd, conn_fd; //Listening socket file, Connection Established Socket file
+    struct sockaddr_in server_addr, client_addr; //structs holding server socket , client socket addresses
+    socklen_t addr_len  = sizeof(client_addr); //holds the size of (SockAddress Struct) which is the maximum client address size possible
+
+
+    /************************************************/
+
+    //STEP 1: CREATE A LISTENING SOCKET
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if(listen_fd < 0){
+        perror("server socket creation failed "); //creation failed
+    }
+    printf("Socket created successfully (fd: %d)\n", listen_fd); //Success Heres the socket fd 
+
+
+
+    /************************************************/
+
+    //STEP 2: BIND THE LISTENING SOCKET TO ADDRESS AND PORT
+
+    //Create the IP address structure
+    memset(&server_addr, 0, sizeof(server_addr)); //initialise the address structure to zeroes for safety
+    server_addr.sin_family = AF_INET; //address family domain is IP internet
+    server_addr.sin_port = htons(SERVER_PORT); // host byte order to network byte order
+
+    //Convert IP address string to Binary form
+    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+        perror("inet_pton failed to convert server IP structure to Binary form");
+        close(listen_fd);   //close if pton function fails and exit the program
+        exit(EXIT_FAILURE);
+    }
+
+    //Bind our listening socket to this binary form address   
+    if (bind(listen_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("BInd failed to listening socket");
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Socket bound to %s:%d\n", SERVER_IP, SERVER_PORT);
+
+
+
+    /************************************************/
+
+    //STEP 3: LISTEN FOR INCOMING CONNECTIONS FROM OUR LISTENING SOCKET
+
+    if (listen(listen_fd, BACKLOG)) {   //backlog is a limit number for pending connection requests
+        perror("Listening function failed for the server listening socket");
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Server Listening on %s:%d\n", SERVER_IP, SERVER_PORT);
+    fflush(stdout);  // the benchmark driver waits for this line before starting clients
+
+
+
+    /************************************************/
+
+    //STEP 4: ACCEPT AN INCOMING CONNECTION IF AVAIALABLE BY BLOCKING EVERYTHING AND TCP CONNECT
+
+    printf("Waiting for client connection...\n"); //Starting the accepting and handhaking connection process
+
+
+    // --persistent: block SIGTERM/SIGINT and open the control socket before any thread exists.
+    // One padded counter slot per client thread; prints STATS lines every interval
+    if (server_control_init(&cfg, a5_ops.name) < 0 ||
+        server_stats_init(num_threads, cfg.stats_interval_ms) < 0) {
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    //ACCEPT N CLIENTS (--persistent: until SIGTERM or SHUTDOWN)
+    for (int i = 0; server_keep_accepting(&cfg, i, listen_fd); i++) {
+
+        conn_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &addr_len);
+        if (conn_fd < 0) {
+            perror("Accept failed");
+            continue; //Try next client on the queue
+            // close(listen_fd);
+            // exit(EXIT_FAILURE);
+        }
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, ip, INET_ADDRSTRLEN);
+        printf("Client %d/%d from %s:%d\n", i+1, num_threads, ip, ntohs(client_addr.sin_port));
+
+        int slot = server_slot_acquire();
+        if (slot < 0) {
+            fprintf(stderr, "All %d stats slots are in use, closing client %d\n", num_threads, i+1);
+            close(conn_fd);
+            continue;
+        }
+
+        struct thread_args *args = malloc(sizeof(struct thread_args));
+        args->conn_fd = conn_fd;
+        args->field_size = field_size;
+        args->slot = slot;
+        args->framed = cfg.framed;
+    
+        // --pin / --cpus spread client threads round-robin over the chosen cores
+        int cpu = server_worker_cpu(&cfg, i);
+        if (server_thread_start(&cpu, slot, client_thread, args) != 0) {
+            fprintf(stderr, "Failed to create client thread %d\n", i+1);
+            close(conn_fd);
+            free(args);
+            continue;
+        }
+
+    }
+
+    close(listen_fd);
+    printf("All clients connected, waiting...\n");
+
+    //waiting fro all threads to finish execution...
+    server_threads_wait();
+    server_stats_finish(a5_ops.name);
+    server_control_close();
+
+    printf("All done. Server exiting.\n");
+    return 0;
+
+    
+}
\ No newline at end of file
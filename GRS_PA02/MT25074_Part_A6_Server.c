@@ -0,0 +1,371 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A6_Server.c
+ * vmsplice() + splice() server: response pages moved into the socket through a pipe
+ */
+
+#define _GNU_SOURCE  // vmsplice, splice, pipe2, F_SETPIPE_SZ
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "MT25074_Part_A_Common.h"
+
+
+/*
+ * Every connection owns a pipe. send_some vmsplice()s the response's user
+ * pages into the pipe (page references, no copy) and splice()s the pipe into
+ * the socket, so the payload reaches the socket buffers without a copy. This
+ * is only safe because the response is never written after it is created:
+ * the kernel may still be reading those pages after the call returns.
+ *
+ * When the socket would block, bytes can stay behind in the pipe. They are
+ * already committed to that connection, so the next call skips them when
+ * topping the pipe up and only bytes that reached the socket are reported.
+ * Requests are still received with readv().
+ */
+struct splice_pipe {
+    int rd;            // -1 = no pipe, send with writev()
+    int wr;
+    size_t queued;     // response bytes sitting in the pipe
+};
+
+static struct splice_pipe *pipes;   // indexed by socket fd
+static int max_pipes;
+static int pipe_size;               // requested capacity: one field, within pipe-max-size
+
+static int splice_pipes_init(size_t field_size) {
+
+    struct rlimit rl;
+    max_pipes = 65536;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)max_pipes) max_pipes = rl.rlim_cur;
+
+    pipes = malloc(max_pipes * sizeof(*pipes));
+    if (!pipes) {
+        perror("Failed to allocate the pipe table");
+        return -1;
+    }
+    for (int i = 0; i < max_pipes; i++) {
+        pipes[i].rd = pipes[i].wr = -1;
+        pipes[i].queued = 0;
+    }
+    // The default pipe holds 64 KB; a bigger one means fewer rounds per large field
+    pipe_size = field_size < (1u << 20) ? (int)field_size : (1 << 20);
+    return 0;
+}
+
+static void open_splice_pipe(int conn_fd) {
+    if (conn_fd >= max_pipes) return;
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        perror("pipe2 failed, connection falls back to writev");
+        return;
+    }
+    if (pipe_size > 65536) fcntl(fds[1], F_SETPIPE_SZ, pipe_size);  // best effort
+    pipes[conn_fd].rd = fds[0];
+    pipes[conn_fd].wr = fds[1];
+    pipes[conn_fd].queued = 0;
+}
+
+static void close_splice_pipe(int conn_fd) {
+    if (conn_fd >= max_pipes || pipes[conn_fd].rd < 0) return;
+    close(pipes[conn_fd].rd);
+    close(pipes[conn_fd].wr);
+    pipes[conn_fd].rd = pipes[conn_fd].wr = -1;
+    pipes[conn_fd].queued = 0;
+}
+
+static ssize_t vmsplice_some(int sockfd, struct iovec *iov, int iovcnt) {
+
+    struct splice_pipe *p = sockfd < max_pipes ? &pipes[sockfd] : NULL;
+    if (!p || p->rd < 0) return writev(sockfd, iov, iovcnt);
+
+    // Top the pipe up with the part of iov it does not hold yet
+    struct iovec rest[NUM_FIELDS];
+    int cnt = 0;
+    size_t skip = p->queued;
+    for (int i = 0; i < iovcnt; i++) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        rest[cnt].iov_base = (char*)iov[i].iov_base + skip;
+        rest[cnt].iov_len = iov[i].iov_len - skip;
+        skip = 0;
+        cnt++;
+    }
+    if (cnt > 0) {
+        ssize_t v = vmsplice(p->wr, rest, cnt, SPLICE_F_NONBLOCK);
+        stats_syscall();   // the caller counts the splice() below
+        if (v > 0) p->queued += v;
+        else if (v < 0 && errno != EAGAIN) return -1;   // EAGAIN: pipe full, drain what it holds
+    }
+
+    ssize_t n = splice(p->rd, NULL, sockfd, NULL, p->queued, SPLICE_F_MOVE);
+    if (n > 0) p->queued -= n;
+    return n;
+}
+
+static const struct server_ops a6_ops = {
+    .name = "A6 Vmsplice",
+    .setup_conn = open_splice_pipe,
+    .teardown_conn = close_splice_pipe,
+    .conn_errqueue = NULL,
+    .create_response = NULL,
+    .recv_some = readv_some,
+    .send_some = vmsplice_some
+};
+
+
+/************************************************/
+
+//THREAD HANDLING FOR THE CLIENTS
+
+
+struct thread_args{
+    int conn_fd;
+    size_t field_size;
+    int slot;          // this thread's stats slot (server_slot_acquire)
+    int framed;        // --framed: length-prefixed messages of any size up to field_size
+};
+
+void* client_thread(void* arg) {
+
+    struct thread_args *args = (struct thread_args*)arg;
+    server_stats_bind(args->slot);
+    open_splice_pipe(args->conn_fd);
+
+    if (args->framed) {
+        serve_framed_conn(args->conn_fd, args->field_size, &a6_ops);
+        server_stats_conn_closed(args->conn_fd);
+        close_splice_pipe(args->conn_fd);
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
+
+    // Server's response message (created once, sent repeatedly)
+    struct message *response_msg = create_message(args->field_size, 'S');
+    // Buffer to receive client request
+    struct message *request_buffer = create_message(args->field_size, 'S');
+    
+    if (!response_msg || !request_buffer) {
+        close_splice_pipe(args->conn_fd);
+        close(args->conn_fd);
+        free(args);
+        return NULL;
+    }
+
+    uint64_t msg_count = 0; 
+    size_t msg_bytes = NUM_FIELDS * args->field_size;
+    
+    // ==================== REPEATED TRANSFERS ====================
+    // Server transfers repeatedly until client closes connection
+    // NO TIME LIMIT on server side - just responds to each client message
+    
+    while (1) {
+        
+        // STEP 1: Receive all 8 fields from client (request) - one vectored call per attempt
+        struct iovec iov[NUM_FIELDS];
+        int cnt = message_iov(request_buffer, 0, iov);
+        ssize_t n = iov_transfer_all(args->conn_fd, iov, cnt, a6_ops.recv_some);
+
+        if (n == 0) {
+            // Client closed connection cleanly
+            printf("Server: Client closed connection. Thread handled - Total messages: %lu\n", msg_count);
+            goto cleanup;
+        }
+
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Receive error or partial (%zd/%zu)\n", n, msg_bytes);
+            goto cleanup;
+        }
+        
+        // STEP 2: Send all 8 fields back to client (response)
+        // This is the "transfer" - server responds with fixed-size message
+        cnt = message_iov(response_msg, 0, iov);
+        n = iov_transfer_all(args->conn_fd, iov, cnt, a6_ops.send_some);
+        if (n != (ssize_t)msg_bytes) {
+            printf("Server: Send failed\n");
+            goto cleanup;
+        }
+        
+        msg_count++;
+        server_stats_message(2 * msg_bytes);  // request + response payload
+        
+
+    }
+    
+cleanup:
+    free_message(response_msg);
+    free_message(request_buffer);
+    server_stats_conn_closed(args->conn_fd);
+    close_splice_pipe(args->conn_fd);
+    close(args->conn_fd);
+    free(args);
+    return NULL;
+}
+
+
+
+
+
+int main(int argc, char *argv[]) {
+    struct server_config cfg;
+    if (parse_server_args(argc, argv, &cfg) < 0) {
+        exit(1);
+    }
+    
+    size_t field_size = cfg.field_size;
+    int num_threads = cfg.num_clients;
+
+    // Pipe table is indexed by fd, so it must exist before the first accept
+    if (splice_pipes_init(cfg.field_size) < 0) {
+        exit(1);
+    }
+
+    // Event-loop mode: the reactor creates its own listeners, so hand over here
+    if (cfg.mode == SERVER_MODE_EPOLL) {
+        return run_epoll_server(&cfg, &a6_ops) == 0 ? 0 : 1;
+    }
+
+    printf("Server: field_size=%zu, accepting %d clients\n", field_size, num_threads);
+
+
+
+    int listen_fd, conn_fd; //Listening socket file, Connection Established Socket file
+    struct sockaddr_in server_addr, client_addr; //structs holding server socket , client socket addresses
+    socklen_t addr_len  = sizeof(client_addr); //holds the size of (SockAddress Struct) which is the maximum client address size possible
+
+
+    /************************************************/
+
+    //STEP 1: CREATE A LISTENING SOCKET
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if(listen_fd < 0){
+        perror("server socket creation failed "); //creation failed
+    }
+    printf("Socket created successfully (fd: %d)\n", listen_fd); //Success Heres the socket fd 
+
+
+
+    /************************************************/
+
+    //STEP 2: BIND THE LISTENING SOCKET TO ADDRESS AND PORT
+
+    //Create the IP address structure
+    memset(&server_addr, 0, sizeof(server_addr)); //initialise the address structure to zeroes for safety
+    server_addr.sin_family = AF_INET; //address family domain is IP internet
+    server_addr.sin_port = htons(SERVER_PORT); // host byte order to network byte order
+
+    //Convert IP address string to Binary form
+    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+        perror("inet_pton failed to convert server IP structure to Binary form");
+        close(listen_fd);   //close if pton function fails and exit the program
+        exit(EXIT_FAILURE);
+    }
+
+    //Bind our listening socket to this binary form address   
+    if (bind(listen_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("BInd failed to listening socket");
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Socket bound to %s:%d\n", SERVER_IP, SERVER_PORT);
+
+
+
+    /************************************************/
+
+    //STEP 3: LISTEN FOR INCOMING CONNECTIONS FROM OUR LISTENING SOCKET
+
+    if (listen(listen_fd, BACKLOG)) {   //backlog is a limit number for pending connection requests
+        perror("Listening function failed for the server listening socket");
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Server Listening on %s:%d\n", SERVER_IP, SERVER_PORT);
+    fflush(stdout);  // the benchmark driver waits for this line before starting clients
+
+
+
+    /************************************************/
+
+    //STEP 4: ACCEPT AN INCOMING CONNECTION IF AVAIALABLE BY BLOCKING EVERYTHING AND TCP CONNECT
+
+    printf("Waiting for client connection...\n"); //Starting the accepting and handhaking connection process
+
+
+    // --persistent: block SIGTERM/SIGINT and open the control socket before any thread exists.
+    // One padded counter slot per client thread; prints STATS lines every interval
+    if (server_control_init(&cfg, a6_ops.name) < 0 ||
+        server_stats_init(num_threads, cfg.stats_interval_ms) < 0) {
+        close(listen_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    //ACCEPT N CLIENTS (--persistent: until SIGTERM or SHUTDOWN)
+    for (int i = 0; server_keep_accepting(&cfg, i, listen_fd); i++) {
+
+        conn_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &addr_len);
+        if (conn_fd < 0) {
+            perror("Accept failed");
+            continue; //Try next client on the queue
+            // close(listen_fd);
+            // exit(EXIT_FAILURE);
+        }
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, ip, INET_ADDRSTRLEN);
+        printf("Client %d/%d from %s:%d\n", i+1, num_threads, ip, ntohs(client_addr.sin_port));
+
+        int slot = server_slot_acquire();
+        if (slot < 0) {
+            fprintf(stderr, "All %d stats slots are in use, closing client %d\n", num_threads, i+1);
+            close(conn_fd);
+            continue;
+        }
+
+        struct thread_args *args = malloc(sizeof(struct thread_args));
+        args->conn_fd = conn_fd;
+        args->field_size = field_size;
+        args->slot = slot;
+        args->framed = cfg.framed;
+    
+        // --pin / --cpus spread client threads round-robin over the chosen cores
+        int cpu = server_worker_cpu(&cfg, i);
+        if (server_thread_start(&cpu, slot, client_thread, args) != 0) {
+            fprintf(stderr, "Failed to create client thread %d\n", i+1);
+            close(conn_fd);
+            free(args);
+            continue;
+        }
+
+    }
+
+    close(listen_fd);
+    printf("All clients connected, waiting...\n");
+
+    //waiting fro all threads to finish execution...
+    server_threads_wait();
+    server_stats_finish(a6_ops.name);
+    server_control_close();
+
+    printf("All done. Server exiting.\n");
+    return 0;
+
+    
+}
\ No newline at end of file
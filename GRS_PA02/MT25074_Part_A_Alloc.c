@@ -0,0 +1,154 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Alloc.c
+ * Message buffer backing: huge pages, NUMA binding and pre-faulting
+ *
+ * By default a message is one aligned_alloc() block on 4 KB pages, placed
+ * wherever the first memset touches it. With --pages thp|hugetlb the block
+ * is an anonymous mapping backed by 2 MB pages instead (MADV_HUGEPAGE, or
+ * MAP_HUGETLB from the reserved pool), so a multi-megabyte slab needs a
+ * handful of TLB entries rather than hundreds; slabs under 1 MB stay on
+ * 4 KB pages. With --numa-local the mapping
+ * is bound (MPOL_BIND) to the NUMA node of the CPU the calling thread runs on;
+ * messages are created by the pinned worker that uses them (in epoll mode each
+ * loop thread builds its shared response after it is pinned), so that is the
+ * worker's node. Mapped buffers are always populated before they are
+ * returned, so no page fault lands inside the measured transfer loop.
+ */
+
+#define _GNU_SOURCE  // MAP_HUGETLB, MADV_HUGEPAGE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "MT25074_Part_A_Common.h"
+
+#define HUGE_PAGE_SIZE (2UL << 20)
+#define MAX_NUMA_NODES 1024
+
+static struct buffer_policy policy = { BUFFER_PAGES_DEFAULT, 0 };
+
+static atomic_int hugetlb_warned;  // one "pool empty" message per process
+static atomic_int numa_warned;     // one "mbind failed" message per process
+
+int parse_buffer_pages(const char *name) {
+    if (strcmp(name, "default") == 0) return BUFFER_PAGES_DEFAULT;
+    if (strcmp(name, "thp") == 0) return BUFFER_PAGES_THP;
+    if (strcmp(name, "hugetlb") == 0) return BUFFER_PAGES_HUGETLB;
+    fprintf(stderr, "Unknown page backing '%s' (default, thp or hugetlb)\n", name);
+    return -1;
+}
+
+void buffer_policy_set(const struct buffer_policy *p) {
+    policy = *p;
+}
+
+static size_t round_up_to(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+// Node of the CPU this thread is on right now (pinned workers stay there)
+static int current_node(void) {
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) < 0) return -1;
+    return (int)node;
+}
+
+static void bind_to_local_node(void *addr, size_t len) {
+    int node = current_node();
+    unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {0};
+    if (node < 0 || node >= MAX_NUMA_NODES) return;
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+
+    // maxnode counts one past the last bit the kernel should read
+    if (syscall(SYS_mbind, addr, len, MPOL_BIND, mask, MAX_NUMA_NODES + 1, 0) < 0 &&
+        !atomic_exchange(&numa_warned, 1)) {
+        fprintf(stderr, "mbind to node %d failed: %s; first-touch placement\n", node, strerror(errno));
+    }
+}
+
+// Faults every page in now. The policy has to be in place first, which is
+// why MAP_POPULATE is only used when there is no binding to apply.
+static void populate(void *addr, size_t len, size_t page) {
+    if (madvise(addr, len, MADV_POPULATE_WRITE) == 0) return;
+    for (size_t off = 0; off < len; off += page) ((volatile char *)addr)[off] = 0;  // pre-5.14 kernels
+}
+
+static void *map_hugetlb(size_t len) {
+    int populate_now = policy.numa_local ? 0 : MAP_POPULATE;
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate_now, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+    if (policy.numa_local) {
+        bind_to_local_node(p, len);
+        populate(p, len, HUGE_PAGE_SIZE);
+    }
+    return p;
+}
+
+// THP only backs 2 MB-aligned ranges, so over-map and trim to an aligned window
+static void *map_thp(size_t len) {
+    size_t span = len + HUGE_PAGE_SIZE;
+    char *raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    char *p = (char *)round_up_to((uintptr_t)raw, HUGE_PAGE_SIZE);
+    if (p > raw) munmap(raw, p - raw);
+    if (raw + span > p + len) munmap(p + len, raw + span - (p + len));
+
+    madvise(p, len, MADV_HUGEPAGE);
+    if (policy.numa_local) bind_to_local_node(p, len);
+    populate(p, len, HUGE_PAGE_SIZE);
+    return p;
+}
+
+static void *map_small_pages(size_t len) {
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+    bind_to_local_node(p, len);
+    populate(p, len, (size_t)sysconf(_SC_PAGESIZE));
+    return p;
+}
+
+void *buffer_alloc(size_t len, size_t *mapped) {
+    // Below half a huge page there is no TLB reach to gain, only memory to waste
+    int pages = len >= HUGE_PAGE_SIZE / 2 ? policy.pages : BUFFER_PAGES_DEFAULT;
+
+    *mapped = 0;
+    if (pages == BUFFER_PAGES_DEFAULT && !policy.numa_local) {
+        return aligned_alloc(CACHE_LINE_SIZE, round_up_to(len, CACHE_LINE_SIZE));
+    }
+
+    void *p = NULL;
+    size_t map_len = round_up_to(len, HUGE_PAGE_SIZE);
+    switch (pages) {
+    case BUFFER_PAGES_HUGETLB:
+        if ((p = map_hugetlb(map_len)) != NULL) break;
+        if (!atomic_exchange(&hugetlb_warned, 1)) {
+            // Nothing reserved in /proc/sys/vm/nr_hugepages (or the pool ran dry)
+            fprintf(stderr, "MAP_HUGETLB failed: %s; falling back to THP\n", strerror(errno));
+        }
+        // fall through
+    case BUFFER_PAGES_THP:
+        p = map_thp(map_len);
+        break;
+    default:
+        // 4 KB pages, mapped only so they can be bound to the local node
+        map_len = round_up_to(len, (size_t)sysconf(_SC_PAGESIZE));
+        p = map_small_pages(map_len);
+        break;
+    }
+    if (p) *mapped = map_len;
+    return p;
+}
+
+void buffer_free(void *p, size_t mapped) {
+    if (!p) return;
+    if (mapped) munmap(p, mapped);
+    else free(p);
+}
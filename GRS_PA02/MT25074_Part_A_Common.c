@@ -0,0 +1,478 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Common.c
+ * Helpers shared by the A1/A2/A3 servers and clients
+ */
+
+#define _GNU_SOURCE  // pthread_attr_setaffinity_np, cpu_set_t
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <sys/uio.h>
+#include "MT25074_Part_A_Common.h"
+
+
+/************************************************/
+
+//MESSAGE LAYOUT: ONE SLAB PER MESSAGE
+
+static size_t round_up(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+struct message* create_message(size_t field_size, char pattern) {
+
+    // Struct header and field slab share one allocation; the slab starts on its own cache line
+    size_t header = round_up(sizeof(struct message), CACHE_LINE_SIZE);
+    size_t total = round_up(header + NUM_FIELDS * field_size, CACHE_LINE_SIZE);
+
+    size_t mapped;
+    struct message *msg = buffer_alloc(total, &mapped);
+    if (!msg) return NULL;
+
+    msg->mapped = mapped;
+    msg->field_size = field_size;
+    msg->slab = (char*)msg + header;
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        msg->fields[i] = msg->slab + i * field_size;
+        memset(msg->fields[i], pattern + i, field_size);
+    }
+    return msg;
+}
+
+void free_message(struct message *msg) {
+    if (!msg) return;
+    buffer_free(msg, msg->mapped);  // fields live inside the same allocation
+}
+
+int message_iov(const struct message *msg, size_t offset, struct iovec iov[NUM_FIELDS]) {
+    return message_iov_range(msg, offset, NUM_FIELDS * msg->field_size, iov);
+}
+
+int message_iov_range(const struct message *msg, size_t offset, size_t end, struct iovec iov[NUM_FIELDS]) {
+    int cnt = 0;
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        size_t start = i * msg->field_size;
+        size_t stop = start + msg->field_size;
+        if (start >= end) break;
+        if (stop > end) stop = end;
+        if (offset >= stop) continue;
+        size_t skip = offset > start ? offset - start : 0;
+        iov[cnt].iov_base = msg->fields[i] + skip;
+        iov[cnt].iov_len = stop - start - skip;
+        cnt++;
+    }
+    return cnt;
+}
+
+
+/************************************************/
+
+//VECTORED SEND / RECEIVE
+
+ssize_t readv_some(int sockfd, struct iovec *iov, int iovcnt) {
+    return readv(sockfd, iov, iovcnt);
+}
+
+ssize_t writev_some(int sockfd, struct iovec *iov, int iovcnt) {
+    return writev(sockfd, iov, iovcnt);
+}
+
+// Defined here rather than in the stats module because the helpers below count into them
+__thread struct stats_slot *stats_tls = NULL;
+atomic_uint stats_epoch;
+
+void stats_slot_restart(struct stats_slot *s) {
+    atomic_store_explicit(&s->bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->messages, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->syscalls, 0, memory_order_relaxed);
+    s->tcp_bytes = 0;
+    s->first_ns = 0;
+    s->last_ns = 0;
+    atomic_store_explicit(&s->epoch, atomic_load_explicit(&stats_epoch, memory_order_relaxed),
+                          memory_order_release);
+}
+
+ssize_t iov_transfer_all(int sockfd, struct iovec *iov, int iovcnt, iov_io_fn io) {
+    size_t total = 0;
+    while (iovcnt > 0) {
+        ssize_t n = io(sockfd, iov, iovcnt);
+        stats_syscall();
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return total;  // Connection closed
+        total += n;
+
+        // Skip fully transferred iovecs, then trim the partially transferred one
+        size_t done = n;
+        while (iovcnt > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+    return total;
+}
+
+
+/************************************************/
+
+//CPU AFFINITY
+
+int parse_cpu_list(const char *list, int **out) {
+    int count = 1;
+    for (const char *p = list; *p; p++) {
+        if (*p == ',') count++;
+    }
+    int *cpus = malloc(count * sizeof(int));
+    if (!cpus) return -1;
+
+    const char *p = list;
+    for (int i = 0; i < count; i++) {
+        char *end;
+        long v = strtol(p, &end, 10);
+        if (end == p || v < 0 || (*end != ',' && *end != '\0')) {
+            free(cpus);
+            return -1;
+        }
+        cpus[i] = (int)v;
+        p = end + 1;
+    }
+    *out = cpus;
+    return count;
+}
+
+int pinned_thread_create(pthread_t *tid, int *cpu, void *(*fn)(void *), void *arg) {
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (*cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(*cpu, &set);
+        // Pin before the thread runs so it never touches another core's caches
+        if (pthread_attr_setaffinity_np(&attr, sizeof(set), &set) != 0) {
+            fprintf(stderr, "Cannot pin thread to cpu %d, running unpinned\n", *cpu);
+            *cpu = -1;
+        }
+    }
+    int rc = pthread_create(tid, &attr, fn, arg);
+    if (rc != 0 && *cpu >= 0) {
+        // e.g. cpu not in our allowed set: fall back to an unpinned thread
+        fprintf(stderr, "Cannot start thread on cpu %d, running unpinned\n", *cpu);
+        *cpu = -1;
+        rc = pthread_create(tid, NULL, fn, arg);
+    }
+    pthread_attr_destroy(&attr);
+    return rc;
+}
+
+
+/************************************************/
+
+//CLIENT ARGUMENTS
+
+static void print_client_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--depth N] [--send-zc] [--zc-recv] [--framed] [--sizes SPEC]\n"
+                    "          [--latency-csv FILE] [--duration S] [--warmup S]\n"
+                    "          [--pages default|thp|hugetlb] [--numa-local] <field_size>\n", prog);
+    fprintf(stderr, "  --depth N           keep N requests in flight (default 1 = stop-and-wait, max %d)\n",
+            PIPELINE_MAX_DEPTH);
+    fprintf(stderr, "  --send-zc           A4 only: io_uring IORING_OP_SEND_ZC sends\n");
+    fprintf(stderr, "  --zc-recv           A1-A3: receive with TCP_ZEROCOPY_RECEIVE (mmap), copy the rest\n");
+    fprintf(stderr, "  --framed            length-prefixed messages (server needs --framed too)\n");
+    fprintf(stderr, "  --sizes SPEC        framed field sizes: fixed:N, uniform:MIN:MAX,\n");
+    fprintf(stderr, "                      bimodal:SMALL:LARGE:PCT_SMALL or file:PATH (implies --framed;\n");
+    fprintf(stderr, "                      every size <= field_size)\n");
+    fprintf(stderr, "  --latency-csv FILE  write round-trip latency percentiles to FILE\n");
+    fprintf(stderr, "  --duration S        measured seconds (default %d)\n", DEFAULT_DURATION_SECONDS);
+    fprintf(stderr, "  --warmup S          unmeasured seconds before that (default %d)\n", DEFAULT_WARMUP_SECONDS);
+    fprintf(stderr, "  --pages P           message buffers on default (4 KB), thp or hugetlb pages\n");
+    fprintf(stderr, "  --numa-local        bind message buffers to the NUMA node of their thread\n");
+}
+
+int parse_client_args(int argc, char *argv[], struct client_config *cfg) {
+
+    static const struct option long_opts[] = {
+        {"depth",   required_argument, NULL, 'd'},
+        {"send-zc", no_argument,       NULL, 'z'},
+        {"latency-csv", required_argument, NULL, 'l'},
+        {"duration", required_argument, NULL, 't'},
+        {"warmup",   required_argument, NULL, 'w'},
+        {"zc-recv",  no_argument,       NULL, 'r'},
+        {"framed",   no_argument,       NULL, 'f'},
+        {"sizes",    required_argument, NULL, 'S'},
+        {"pages",    required_argument, NULL, 'H'},
+        {"numa-local", no_argument,     NULL, 'N'},
+        {NULL, 0, NULL, 0}
+    };
+    const char *sizes = NULL;
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->depth = 1;
+    cfg->duration = DEFAULT_DURATION_SECONDS;
+    cfg->warmup = DEFAULT_WARMUP_SECONDS;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:zl:t:w:rfS:H:N", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'd':
+            cfg->depth = atoi(optarg);
+            if (cfg->depth < 1 || cfg->depth > PIPELINE_MAX_DEPTH) {
+                fprintf(stderr, "--depth must be between 1 and %d\n", PIPELINE_MAX_DEPTH);
+                return -1;
+            }
+            break;
+        case 'z':
+            cfg->send_zc = 1;
+            break;
+        case 'r':
+            cfg->zc_recv = 1;
+            break;
+        case 'f':
+            cfg->framed = 1;
+            break;
+        case 'S':
+            sizes = optarg;
+            cfg->framed = 1;
+            break;
+        case 'l':
+            cfg->latency_csv = optarg;
+            break;
+        case 'H':
+            cfg->buffers.pages = parse_buffer_pages(optarg);
+            if (cfg->buffers.pages < 0) return -1;
+            break;
+        case 'N':
+            cfg->buffers.numa_local = 1;
+            break;
+        case 't':
+            cfg->duration = atoi(optarg);
+            if (cfg->duration < 1) {
+                fprintf(stderr, "--duration must be at least 1 second\n");
+                return -1;
+            }
+            break;
+        case 'w':
+            cfg->warmup = atoi(optarg);
+            if (cfg->warmup < 0) {
+                fprintf(stderr, "--warmup cannot be negative\n");
+                return -1;
+            }
+            break;
+        default:
+            print_client_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (argc - optind != 1) {
+        print_client_usage(argv[0]);
+        return -1;
+    }
+
+    cfg->field_size = atoi(argv[optind]);
+    if (cfg->field_size == 0) {
+        print_client_usage(argv[0]);
+        return -1;
+    }
+    if (cfg->framed) {
+        // Default distribution: every request uses the full field_size
+        char fixed[32];
+        snprintf(fixed, sizeof(fixed), "fixed:%zu", cfg->field_size);
+        if (parse_size_dist(sizes ? sizes : fixed, cfg->field_size, &cfg->sizes) < 0) return -1;
+    }
+    buffer_policy_set(&cfg->buffers);
+    return 0;
+}
+
+
+/************************************************/
+
+//SERVER ARGUMENTS
+
+static void print_server_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--mode thread|epoll] [--loops N] [--dispatch reuseport|rr|least]\n"
+                    "          [--pin | --cpus LIST] [--irq-cpu N] [--send-zc] [--stats-interval MS]\n"
+                    "          [--framed] [--persistent [--control PATH]] [--pages P] [--numa-local]\n"
+                    "          <field_size> <num_threads>\n", prog);
+    fprintf(stderr, "  --mode thread  one pthread per client connection (default)\n");
+    fprintf(stderr, "  --mode epoll   fixed pool of non-blocking edge-triggered epoll loops\n");
+    fprintf(stderr, "  --loops N      number of epoll loops (default: one per worker core)\n");
+    fprintf(stderr, "  --dispatch D   epoll: reuseport (kernel, default), rr (round-robin) or\n");
+    fprintf(stderr, "                 least (fewest open connections) from one acceptor\n");
+    fprintf(stderr, "  --pin          pin workers round-robin over all online cores\n");
+    fprintf(stderr, "  --cpus LIST    pin workers round-robin over LIST (e.g. 1,2,3)\n");
+    fprintf(stderr, "  --irq-cpu N    keep core N free for IRQ/softirq work (implies --pin)\n");
+    fprintf(stderr, "  --send-zc      A4 only: io_uring IORING_OP_SEND_ZC sends\n");
+    fprintf(stderr, "  --stats-interval MS  periodic throughput line (default 1000, 0 = final only)\n");
+    fprintf(stderr, "  --framed       length-prefixed messages of any size up to field_size per field\n");
+    fprintf(stderr, "  --persistent   keep accepting until SIGTERM/SIGINT or SHUTDOWN; num_threads is\n"
+                    "                 then the most connections open at once\n");
+    fprintf(stderr, "  --control PATH Unix control socket (default %s)\n", DEFAULT_CONTROL_PATH);
+    fprintf(stderr, "  --pages P      message buffers on default (4 KB), thp or hugetlb pages\n");
+    fprintf(stderr, "  --numa-local   bind each worker's message buffers to its NUMA node\n");
+}
+
+int parse_server_args(int argc, char *argv[], struct server_config *cfg) {
+
+    static const struct option long_opts[] = {
+        {"mode",  required_argument, NULL, 'm'},
+        {"loops", required_argument, NULL, 'l'},
+        {"send-zc", no_argument, NULL, 'z'},
+        {"stats-interval", required_argument, NULL, 's'},
+        {"dispatch", required_argument, NULL, 'D'},
+        {"pin",      no_argument,       NULL, 'P'},
+        {"cpus",     required_argument, NULL, 'c'},
+        {"irq-cpu",  required_argument, NULL, 'i'},
+        {"framed",   no_argument,       NULL, 'f'},
+        {"persistent", no_argument,     NULL, 'p'},
+        {"control",  required_argument, NULL, 'C'},
+        {"pages",    required_argument, NULL, 'H'},
+        {"numa-local", no_argument,     NULL, 'N'},
+        {NULL, 0, NULL, 0}
+    };
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->control_path = DEFAULT_CONTROL_PATH;
+    cfg->mode = SERVER_MODE_THREAD;
+    cfg->stats_interval_ms = 1000;
+    cfg->dispatch = DISPATCH_REUSEPORT;
+    cfg->irq_cpu = -1;
+    int online = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) online = 1;
+    int pin = 0;
+    int loops_set = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:l:zs:D:Pc:i:fpC:H:N", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'm':
+            if (strcmp(optarg, "thread") == 0) cfg->mode = SERVER_MODE_THREAD;
+            else if (strcmp(optarg, "epoll") == 0) cfg->mode = SERVER_MODE_EPOLL;
+            else {
+                fprintf(stderr, "Unknown mode '%s'\n", optarg);
+                print_server_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 'l':
+            cfg->num_loops = atoi(optarg);
+            if (cfg->num_loops < 1) {
+                fprintf(stderr, "--loops must be at least 1\n");
+                return -1;
+            }
+            loops_set = 1;
+            break;
+        case 'D':
+            if (strcmp(optarg, "reuseport") == 0) cfg->dispatch = DISPATCH_REUSEPORT;
+            else if (strcmp(optarg, "rr") == 0) cfg->dispatch = DISPATCH_ROUND_ROBIN;
+            else if (strcmp(optarg, "least") == 0) cfg->dispatch = DISPATCH_LEAST_LOADED;
+            else {
+                fprintf(stderr, "Unknown dispatch policy '%s'\n", optarg);
+                print_server_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 'P':
+            pin = 1;
+            break;
+        case 'c':
+            free(cfg->cpus);
+            cfg->num_cpus = parse_cpu_list(optarg, &cfg->cpus);
+            if (cfg->num_cpus < 0) {
+                fprintf(stderr, "Bad --cpus list: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'i':
+            cfg->irq_cpu = atoi(optarg);
+            pin = 1;
+            break;
+        case 'z':
+            cfg->send_zc = 1;
+            break;
+        case 'f':
+            cfg->framed = 1;
+            break;
+        case 'p':
+            cfg->persistent = 1;
+            break;
+        case 'C':
+            cfg->control_path = optarg;
+            break;
+        case 'H':
+            cfg->buffers.pages = parse_buffer_pages(optarg);
+            if (cfg->buffers.pages < 0) return -1;
+            break;
+        case 'N':
+            cfg->buffers.numa_local = 1;
+            break;
+        case 's':
+            cfg->stats_interval_ms = atoi(optarg);
+            if (cfg->stats_interval_ms < 0) {
+                fprintf(stderr, "--stats-interval cannot be negative\n");
+                return -1;
+            }
+            break;
+        default:
+            print_server_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    // Positional arguments stay the same as before so the Part B/C scripts keep working
+    if (argc - optind != 2) {
+        print_server_usage(argv[0]);
+        fprintf(stderr, "Got %d positional arguments\n", argc - optind);
+        return -1;
+    }
+
+    cfg->field_size = atoi(argv[optind]);
+    cfg->num_clients = atoi(argv[optind + 1]);
+    if (cfg->field_size == 0 || cfg->num_clients < 1) {
+        print_server_usage(argv[0]);
+        return -1;
+    }
+
+    // --pin / --irq-cpu without a list: every online core
+    if (pin && cfg->num_cpus == 0) {
+        cfg->cpus = malloc(online * sizeof(int));
+        if (!cfg->cpus) return -1;
+        for (int i = 0; i < online; i++) cfg->cpus[i] = i;
+        cfg->num_cpus = online;
+    }
+
+    // Keep the IRQ core out of the worker set so softirq processing never
+    // competes with a worker for that core
+    if (cfg->irq_cpu >= 0) {
+        int kept = 0;
+        for (int i = 0; i < cfg->num_cpus; i++) {
+            if (cfg->cpus[i] != cfg->irq_cpu) cfg->cpus[kept++] = cfg->cpus[i];
+        }
+        cfg->num_cpus = kept;
+        if (kept == 0) {
+            fprintf(stderr, "--irq-cpu %d leaves no worker cores\n", cfg->irq_cpu);
+            return -1;
+        }
+    }
+
+    // Pool size follows the worker cores unless set explicitly
+    if (!loops_set) cfg->num_loops = cfg->num_cpus > 0 ? cfg->num_cpus : online;
+
+    // No point running more loops than there will ever be connections
+    if (cfg->num_loops > cfg->num_clients) cfg->num_loops = cfg->num_clients;
+
+    buffer_policy_set(&cfg->buffers);
+    return 0;
+}
@@ -0,0 +1,458 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Common.h
+ * Shared definitions for the A1/A2/A3 servers and clients
+ * (message layout, vectored I/O helpers, argument parsing, epoll reactor)
+ */
+
+#ifndef MT25074_PART_A_COMMON_H
+#define MT25074_PART_A_COMMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#define SERVER_IP "10.0.0.1"
+#define SERVER_PORT 8080
+#define BACKLOG 5
+#define NUM_FIELDS 8
+#define CACHE_LINE_SIZE 64
+
+/*
+ * All 8 fields live back to back in one cache-line aligned slab that is
+ * allocated together with the struct itself (a single allocation per message).
+ * fields[i] points into the slab, so a whole message maps onto 8 iovecs and
+ * goes out with one writev/sendmsg instead of 8 separate send calls.
+ */
+struct message {
+    size_t field_size;
+    char *slab;                  // NUM_FIELDS * field_size bytes, CACHE_LINE_SIZE aligned
+    char *fields[NUM_FIELDS];    // fields[i] == slab + i * field_size
+    size_t mapped;               // length of the mmap() backing the message, 0 = aligned_alloc()
+};
+
+// pattern is the fill byte of field 0; field i is filled with pattern + i
+struct message* create_message(size_t field_size, char pattern);
+void free_message(struct message *msg);
+
+/*
+ * Message buffer backing (MT25074_Part_A_Alloc.c). --pages picks 4 KB pages
+ * (default), transparent huge pages or the MAP_HUGETLB pool for slabs of
+ * 1 MB and up; --numa-local binds every buffer to the NUMA node of the thread
+ * that creates it. Mapped buffers are pre-faulted before they are returned.
+ */
+#define BUFFER_PAGES_DEFAULT 0
+#define BUFFER_PAGES_THP     1
+#define BUFFER_PAGES_HUGETLB 2
+
+struct buffer_policy {
+    int pages;         // BUFFER_PAGES_*
+    int numa_local;    // mbind(MPOL_BIND) to the creating thread's node
+};
+
+// Returns BUFFER_PAGES_* for "default", "thp" or "hugetlb", or -1 (after a message)
+int parse_buffer_pages(const char *name);
+// Process-wide; the argument parsers install the --pages / --numa-local choice
+void buffer_policy_set(const struct buffer_policy *p);
+// *mapped is what buffer_free() needs back: the mapping length, or 0 for the heap
+void *buffer_alloc(size_t len, size_t *mapped);
+void buffer_free(void *p, size_t mapped);
+
+// Fills iov with the part of msg starting at byte offset (0 = whole message).
+// Returns the number of iovecs used (0 when offset is past the end).
+int message_iov(const struct message *msg, size_t offset, struct iovec iov[NUM_FIELDS]);
+// Same, but stops at byte end (framed messages shorter than the slab)
+int message_iov_range(const struct message *msg, size_t offset, size_t end, struct iovec iov[NUM_FIELDS]);
+
+// One vectored syscall attempt: returns bytes moved, 0 on EOF, -1 with errno set
+typedef ssize_t (*iov_io_fn)(int sockfd, struct iovec *iov, int iovcnt);
+
+// Plain readv()/writev() single attempts (the copying path)
+ssize_t readv_some(int sockfd, struct iovec *iov, int iovcnt);
+ssize_t writev_some(int sockfd, struct iovec *iov, int iovcnt);
+
+// Repeats io until every byte described by iov has moved. iov is consumed.
+// Returns the byte count moved (short only if the peer closed), or -1 on error.
+ssize_t iov_transfer_all(int sockfd, struct iovec *iov, int iovcnt, iov_io_fn io);
+
+// How the server handles its accepted connections
+#define SERVER_MODE_THREAD 0   // one pthread per connection (original model)
+#define SERVER_MODE_EPOLL  1   // N edge-triggered epoll loops, non-blocking sockets
+
+// How epoll mode hands new connections to its loops
+#define DISPATCH_REUSEPORT    0   // every loop has its own SO_REUSEPORT listener (kernel hash)
+#define DISPATCH_ROUND_ROBIN  1   // one acceptor thread, loop i % N
+#define DISPATCH_LEAST_LOADED 2   // one acceptor thread, loop with the fewest open connections
+
+struct server_config {
+    size_t field_size;
+    int num_clients;   // server exits after this many clients have come and gone
+                       // (--persistent: stats slots / the most concurrent connections)
+    int mode;          // SERVER_MODE_THREAD or SERVER_MODE_EPOLL
+    int num_loops;     // epoll worker loops (default: one per worker core)
+    int send_zc;       // A4 only: send with IORING_OP_SEND_ZC instead of WRITE_FIXED
+    int stats_interval_ms; // periodic STATS line every N ms (0 = final line only)
+    int dispatch;      // DISPATCH_* (epoll mode only)
+    int *cpus;         // worker cores; NULL = no pinning
+    int num_cpus;
+    int irq_cpu;       // core left to IRQ/softirq work and kept out of cpus (-1 = none)
+    int framed;        // length-prefixed messages; field_size is then the per-field limit
+    int persistent;    // accept until SIGTERM / SHUTDOWN instead of num_clients connections
+    const char *control_path; // --persistent: Unix control socket
+    struct buffer_policy buffers; // --pages / --numa-local
+};
+
+// Core for server worker i (thread or epoll loop), or -1 when not pinning
+static inline int server_worker_cpu(const struct server_config *cfg, int i) {
+    return cfg->num_cpus > 0 ? cfg->cpus[i % cfg->num_cpus] : -1;
+}
+
+// "0,2,4" -> {0,2,4} (malloc'd). Returns the count, or -1 on a malformed list.
+int parse_cpu_list(const char *list, int **out);
+
+// pthread_create() pinned to *cpu (-1 = unpinned). If pinning is refused the
+// thread still starts unpinned and *cpu is set to -1. Returns pthread_create's rc.
+int pinned_thread_create(pthread_t *tid, int *cpu, void *(*fn)(void *), void *arg);
+
+/*
+ * Framed protocol (--framed, MT25074_Part_A_Framing.c). Every message is a
+ * 16-byte header in network byte order followed by 'length' payload bytes,
+ * laid out over the message slab from field 0 on. Responses echo the
+ * request's length, field count and id. field_size on the command line
+ * becomes the largest field either side will accept.
+ */
+#define FRAME_MAGIC 0x4652u   // "FR"
+
+struct frame_hdr {
+    uint16_t magic;
+    uint16_t num_fields;      // 1 .. NUM_FIELDS (informational; payload is contiguous)
+    uint32_t length;          // payload bytes after the header
+    uint64_t request_id;
+};
+
+void frame_encode(struct frame_hdr *wire, uint32_t length, uint16_t num_fields, uint64_t request_id);
+// Converts to host order and validates magic and length. Returns 0 or -1 (after a message).
+int frame_decode(const struct frame_hdr *wire, struct frame_hdr *out, size_t max_length);
+// sendmsg(MSG_MORE) single attempt for headers, so they never go through a zero-copy path
+ssize_t frame_header_send_some(int sockfd, struct iovec *iov, int iovcnt);
+
+// Client size distributions over the field size (payload = NUM_FIELDS * size)
+enum size_dist_kind { SIZE_FIXED, SIZE_UNIFORM, SIZE_BIMODAL, SIZE_REPLAY };
+
+struct size_dist {
+    int kind;
+    size_t a, b;       // fixed: a; uniform: [a, b]; bimodal: a or b
+    int pct_a;         // bimodal: percent of messages of size a
+    size_t *replay;    // replay: sizes read from a file, cycled
+    size_t replay_len;
+};
+
+// "fixed:N", "uniform:MIN:MAX", "bimodal:SMALL:LARGE:PCT_SMALL", "file:PATH"
+// (one size per line). Every size must be 1..max_field. Returns 0 or -1.
+int parse_size_dist(const char *spec, size_t max_field, struct size_dist *d);
+// Field size of request k; rng is the caller's per-connection PRNG state (non-zero)
+size_t size_dist_next(const struct size_dist *d, uint64_t *rng, uint64_t k);
+
+struct server_ops;
+// Thread-mode framed loop (MT25074_Part_A_Framed_Conn.c): serves conn_fd until
+// the client closes. Returns messages served.
+uint64_t serve_framed_conn(int conn_fd, size_t field_size, const struct server_ops *ops);
+
+/*
+ * Per-thread hardware counters (MT25074_Part_A_Perf.c), opened with
+ * perf_event_open() for the calling thread and enabled only around
+ * steady-state transfer. Events that cannot be opened (no PMU in a VM,
+ * perf_event_paranoid) are skipped and read as 0.
+ */
+enum perf_event_id {
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_REFS, PERF_CACHE_MISSES,
+    PERF_CTX_SWITCHES, PERF_NUM_EVENTS
+};
+
+struct perf_counters {
+    int fd[PERF_NUM_EVENTS];   // -1 = not open
+    int running;
+};
+
+// Opens every event for the calling thread, disabled. Returns how many opened.
+int perf_counters_open(struct perf_counters *pc);
+void perf_counters_enable(struct perf_counters *pc);
+void perf_counters_disable(struct perf_counters *pc);
+void perf_counters_reset(struct perf_counters *pc);
+// Adds the current (multiplex-scaled) values into out; any thread may read
+void perf_counters_read(const struct perf_counters *pc, uint64_t out[PERF_NUM_EVENTS]);
+void perf_counters_close(struct perf_counters *pc);
+
+// Enables the counters while on is set, disables them otherwise (call per loop pass)
+static inline void perf_counters_track(struct perf_counters *pc, int on) {
+    if (pc && on != pc->running) {
+        if (on) perf_counters_enable(pc);
+        else perf_counters_disable(pc);
+    }
+}
+
+// "PERF,<kind>,<label>,<cycles>,<instructions>,<ipc>,<cache_refs>,<cache_misses>,
+//  <context_switches>,<cycles_per_msg>\n"
+void perf_format_line(const char *kind, const char *label, const uint64_t v[PERF_NUM_EVENTS],
+                      uint64_t messages, char *buf, size_t len);
+
+/*
+ * Server throughput counters (MT25074_Part_A_Stats.c). Every serving thread
+ * (thread mode: one per connection, epoll mode: one per loop) owns one slot,
+ * padded to a cache line so counting never bounces lines between cores. The
+ * owner updates with relaxed load+store (no locked instruction); a reporter
+ * thread only reads. Output lines start with "STATS," for the scripts.
+ * A --persistent RESET never stores into a slot's counters, since a live
+ * owner's load+store would overwrite it: it bumps stats_epoch, readers count
+ * a slot from an older epoch as zero, and the owner zeroes its own counters
+ * the next time it counts (stats_owned_slot).
+ */
+struct stats_slot {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_fast64_t bytes;  // payload moved, request + response
+    atomic_uint_fast64_t messages;     // completed request/response round trips
+    atomic_uint_fast64_t syscalls;     // data-path syscalls (send/recv, epoll_wait, errqueue, io_uring_enter)
+    uint64_t tcp_bytes;                // TCP_INFO bytes sent + received, added at connection close
+    uint64_t first_ns;                 // CLOCK_MONOTONIC of the slot's first message
+    uint64_t last_ns;                  // CLOCK_MONOTONIC of the slot's last connection close
+    struct perf_counters perf;         // the bound thread's counters, on while it moves messages
+    uint64_t perf_done[PERF_NUM_EVENTS];   // counts of earlier threads bound to this slot
+    atomic_uint epoch;                 // stats_epoch the counters above belong to
+};
+
+// The calling thread's slot; NULL (nothing counted) in clients and unbound threads
+extern __thread struct stats_slot *stats_tls;
+// Bumped by each RESET; a slot whose epoch lags is stale
+extern atomic_uint stats_epoch;
+
+// Owner side of a RESET: zeroes the slot and moves it to the current epoch
+void stats_slot_restart(struct stats_slot *s);
+
+// The calling thread's slot, restarted first if a RESET happened since it last counted
+static inline struct stats_slot *stats_owned_slot(void) {
+    struct stats_slot *s = stats_tls;
+    if (s && atomic_load_explicit(&s->epoch, memory_order_relaxed) !=
+             atomic_load_explicit(&stats_epoch, memory_order_relaxed)) {
+        stats_slot_restart(s);
+    }
+    return s;
+}
+
+static inline void stats_add(atomic_uint_fast64_t *c, uint64_t n) {
+    // Single writer: a plain read-modify-write is enough, readers may see a stale value
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline void stats_syscall(void) {
+    struct stats_slot *s = stats_owned_slot();
+    if (s) stats_add(&s->syscalls, 1);
+}
+
+// Returns 0 or -1. Starts the periodic reporter when interval_ms > 0.
+int server_stats_init(int num_slots, int interval_ms);
+// Binds slot i to the calling thread (stats_tls)
+void server_stats_bind(int i);
+// Counts one finished round trip of 'bytes' payload on the calling thread's slot
+void server_stats_message(size_t bytes);
+// Adds the connection's TCP_INFO byte counts and stamps the slot's end time
+void server_stats_conn_closed(int conn_fd);
+// Stops the reporter and prints the final "STATS,final,..." and "PERF,final,..." lines
+void server_stats_finish(const char *label);
+// --persistent, between runs: zero every slot and restart the window
+void server_stats_reset(void);
+// Prints the "STATS,final,..." and "PERF,final,..." lines for everything since
+// the last reset and copies them (newlines included) into buf
+void server_stats_dump(const char *label, char *buf, size_t len);
+
+/*
+ * Server lifetime (MT25074_Part_A_Control.c). server_control_init() must run
+ * before any thread is created; with --persistent it blocks SIGTERM/SIGINT
+ * and opens the control socket, otherwise it only records label.
+ */
+#define DEFAULT_CONTROL_PATH "/tmp/MT25074_server.sock"
+
+int server_control_init(const struct server_config *cfg, const char *label);
+// Waits for fd (-1 = none) to become readable while serving control requests.
+// Returns 1 when it is, 0 once shutdown has been requested.
+int server_control_wait(int fd);
+// Non-zero once SIGTERM/SIGINT or SHUTDOWN has arrived
+int server_shutting_down(void);
+// Same as receiving SIGTERM; why is logged
+void server_request_shutdown(const char *why);
+// Thread-mode accept loop condition: i < num_clients, or server_control_wait()
+// on the listener when persistent
+int server_keep_accepting(const struct server_config *cfg, int i, int listen_fd);
+void server_control_close(void);
+// Thread mode: a free stats slot for the next client thread, or -1 when all
+// <num_threads> are held by live threads
+int server_slot_acquire(void);
+// Starts a detached, counted client thread pinned to *cpu (see pinned_thread_create)
+// that owns stats slot 'slot'; the slot is released when the thread returns, or
+// right away if it cannot be started
+int server_thread_start(int *cpu, int slot, void *(*fn)(void *), void *arg);
+// Blocks until every thread started above has returned
+void server_threads_wait(void);
+
+/*
+ * Per-variant transport hooks. Each call is a single vectored attempt (no retry
+ * loop), so the same functions work on blocking sockets and on the non-blocking
+ * sockets of the epoll reactor, where they return -1 with errno == EAGAIN.
+ */
+struct server_ops {
+    const char *name;                  // printed in log lines
+    void (*setup_conn)(int conn_fd);   // optional, may be NULL
+    void (*teardown_conn)(int conn_fd); // optional: undoes setup_conn, called just before close()
+    void (*conn_errqueue)(int conn_fd); // optional: epoll mode calls it on EPOLLERR (MSG_ERRQUEUE)
+    // optional: builds the read-only response message when send_some needs to
+    // know where its bytes live (e.g. a file mapping); NULL = create_message()
+    struct message* (*create_response)(size_t field_size);
+    iov_io_fn recv_some;
+    iov_io_fn send_some;
+};
+
+// Upper bound for --depth: sizes the per-connection send timestamp ring
+#define PIPELINE_MAX_DEPTH 256
+
+// Client run length: DEFAULT_WARMUP_SECONDS of unmeasured traffic, then the
+// measured DEFAULT_DURATION_SECONDS window
+#define DEFAULT_DURATION_SECONDS 10
+#define DEFAULT_WARMUP_SECONDS 1
+
+struct latency_hist;   // MT25074_Part_A_Histogram.h
+
+struct client_config {
+    size_t field_size;
+    int depth;               // requests kept in flight per connection (1 = stop-and-wait)
+    int send_zc;             // A4 only: send with IORING_OP_SEND_ZC
+    const char *latency_csv; // optional: write the latency percentiles here
+    int duration;            // measured seconds
+    int warmup;              // seconds of traffic before measuring starts
+    int zc_recv;             // receive with TCP_ZEROCOPY_RECEIVE (A1-A3)
+    int framed;              // length-prefixed messages (--framed / --sizes)
+    struct size_dist sizes;  // framed only: per-request field size (default fixed:field_size)
+    struct buffer_policy buffers; // --pages / --numa-local
+};
+
+// Parses "[--depth N] [--send-zc] [--zc-recv] [--framed] [--sizes SPEC] [--latency-csv FILE]
+// [--duration S] [--warmup S] [--pages P] [--numa-local] <field_size>". Returns 0 or -1 (after usage).
+int parse_client_args(int argc, char *argv[], struct client_config *cfg);
+
+/*
+ * Run clock (MT25074_Part_A_Deadline.c). A helper thread sleeps on a
+ * CLOCK_MONOTONIC timerfd and moves phase WARMUP -> MEASURE -> STOP; hot
+ * loops only load the atomic. measure_*_ns bracket the measured window.
+ */
+enum run_phase { RUN_WARMUP, RUN_MEASURE, RUN_STOP };
+
+struct run_deadline {
+    atomic_int phase;
+    int timer_fd;
+    pthread_t thread;
+    int warmup_s;
+    int duration_s;
+    uint64_t measure_start_ns;   // CLOCK_MONOTONIC, set just before phase -> MEASURE
+    uint64_t measure_end_ns;     // CLOCK_MONOTONIC, set just before phase -> STOP
+};
+
+// Returns 0 or -1 (timerfd or thread creation failed)
+int run_deadline_start(struct run_deadline *dl, int warmup_s, int duration_s);
+// Waits for the deadline thread (cancelling it if the run ended early) and
+// returns the exact length of the measured window in seconds.
+double run_deadline_finish(struct run_deadline *dl);
+
+static inline int run_phase(const struct run_deadline *dl) {
+    return atomic_load_explicit(&dl->phase, memory_order_relaxed);
+}
+
+/*
+ * Receive-side zero copy (MT25074_Part_A_ZcRecv.c). The socket is mmap()ed and
+ * TCP_ZEROCOPY_RECEIVE remaps page-aligned payload pages into that window;
+ * unaligned bytes are copied into the message as usual. The response bytes
+ * that were mapped are consumed from the stream but never land in msg.
+ */
+struct zc_recv {
+    char *map;               // PROT_READ mapping of the socket; NULL = copy everything
+    size_t map_len;          // multiple of the page size
+    size_t page;
+    uint64_t zc_bytes;       // received by remapping pages
+    uint64_t copied_bytes;   // received by recvmsg() copies
+};
+
+// Maps the receive window for fd. Returns 0, or -1 if mmap() is refused (zr
+// then still works and copies every byte).
+int zc_recv_init(struct zc_recv *zr, int fd, size_t msg_bytes);
+void zc_recv_free(struct zc_recv *zr);
+// One non-blocking attempt at bytes [offset, end) of msg: returns bytes
+// consumed (mapped or copied), 0 on EOF, -1 with errno (EAGAIN = no data yet).
+ssize_t zc_recv_some(struct zc_recv *zr, int fd, struct message *msg, size_t offset, size_t end);
+// Receives one whole message, waiting in poll() when nothing has arrived.
+// Returns like iov_transfer_all().
+ssize_t zc_recv_all(struct zc_recv *zr, int fd, struct message *msg);
+// "Zero-copy receive: X of Y bytes mapped (Z%), W copied"
+void zc_recv_report(uint64_t zc_bytes, uint64_t copied_bytes);
+
+// Per-connection window state of the pipelined request/response loop
+// (MT25074_Part_A_Pipeline.c). Exposed so a caller driving many sockets from
+// one thread (the load generator) can step each connection itself and poll()
+// them together.
+struct pipeline_conn {
+    int fd;                   // must already be O_NONBLOCK
+    int depth;
+    size_t send_off;          // progress inside the request being written (header included)
+    size_t recv_off;          // progress inside the response being read (header included)
+    size_t send_len;          // payload bytes of the request being written
+    size_t recv_len;          // payload bytes of the response being read
+    uint64_t issued;          // requests fully written
+    uint64_t completed;       // responses fully read (answers requests in order)
+    uint64_t measured;        // the subset of completed that finished during RUN_MEASURE
+    uint64_t measured_bytes;  // request + response payload of those round trips
+    struct latency_hist *hist;               // NULL = do not time round trips
+    struct zc_recv *zc;                      // NULL = receive with readv()
+    const struct size_dist *sizes;           // NULL = unframed, every message full size
+    struct perf_counters *perf;              // NULL = not counted; on only during RUN_MEASURE
+    uint64_t rng;                            // size_dist_next() state
+    struct frame_hdr send_hdr;               // framed: header of the request being written
+    struct frame_hdr recv_hdr;               // framed: header of the response being read
+    uint64_t sent_ns[PIPELINE_MAX_DEPTH];    // start time of request k at [k % PIPELINE_MAX_DEPTH]
+};
+
+// hist may be NULL; otherwise every measured round trip (first byte of the
+// request written -> last byte of its response read) is recorded into it.
+void pipeline_conn_init(struct pipeline_conn *pc, int fd, int depth, struct latency_hist *hist);
+// Each step runs until the socket would block. Returns 1 if any bytes moved,
+// 0 if none, -1 on error (or, for recv, the server closing the connection).
+int pipeline_send_step(struct pipeline_conn *pc, const struct message *msg, int stopping);
+int pipeline_recv_step(struct pipeline_conn *pc, struct message *msg, int measuring);
+// poll() events the connection is waiting for; 0 once it has fully drained
+short pipeline_poll_events(const struct pipeline_conn *pc, int stopping);
+
+/*
+ * Runs one initialised connection until dl is over. Keeps up to pc->depth
+ * requests in flight: the send path issues requests while the window has
+ * room, the receive path reads responses, which TCP delivers in request
+ * order. Once dl reaches RUN_STOP no new requests are issued and the
+ * outstanding responses are drained, so the server always sees the close on
+ * a message boundary. With pc->sizes set every request is framed and sized
+ * from that distribution, even at depth 1. Measured round trips and bytes
+ * are left in pc. Returns the number of completed round trips (warm-up
+ * included), or -1.
+ */
+int64_t run_pipelined_exchange(struct pipeline_conn *pc, struct message *send_msg,
+                               struct message *recv_msg, const struct run_deadline *dl);
+
+// Parses "[--mode thread|epoll] [--loops N] [--dispatch reuseport|rr|least]
+// [--pin | --cpus LIST] [--irq-cpu N] [--send-zc] [--stats-interval MS] [--framed]
+// [--persistent [--control PATH]]
+// <field_size> <num_threads>".
+// Returns 0 on success, -1 (after printing usage) on bad input.
+int parse_server_args(int argc, char *argv[], struct server_config *cfg);
+
+// Runs the epoll reactor until cfg->num_clients connections have been served
+// (--persistent: until shutdown is requested and the open connections close).
+// Returns 0 on success, -1 if the listeners or loops could not be set up.
+int run_epoll_server(const struct server_config *cfg, const struct server_ops *ops);
+
+#endif
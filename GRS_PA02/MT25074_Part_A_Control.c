@@ -0,0 +1,288 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Control.c
+ * Persistent server mode (--persistent): open-ended accept loop, control
+ * socket and SIGTERM shutdown, plus the client-thread bookkeeping both
+ * thread-mode lifetimes share
+ *
+ * Normally a server accepts <num_threads> clients and exits, so a sweep pays
+ * for a fresh process for every run. With --persistent the accept loop only
+ * ends on SIGTERM/SIGINT or a SHUTDOWN command, and a Unix socket
+ * (--control PATH) takes one-line commands between runs:
+ *   RESET          zero the throughput counters
+ *   DUMP [label]   reply with (and print) the STATS,final and PERF,final lines
+ *                  since the last RESET
+ *   PID            reply with the server's pid, for perf stat -p
+ *   SHUTDOWN       same as SIGTERM
+ * The signals are blocked in every thread and read through a signalfd by the
+ * thread waiting in server_control_wait(), so no handler ever interrupts a
+ * send. Shutdown is graceful: no new connections, open ones run to the end.
+ *
+ * Client threads take their stats slot from a free list and give it back when
+ * they return. Connections do not finish in accept order, so "accept index mod
+ * slots" could hand a live thread's slot (and perf fds) to a second writer.
+ */
+
+#define _GNU_SOURCE  // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include "MT25074_Part_A_Common.h"
+
+#define CONTROL_LINE_MAX 256
+#define CONTROL_REPLY_MAX 1024   // DUMP: STATS,final + PERF,final
+#define CONTROL_RECV_TIMEOUT_S 1   // a silent control client cannot stall the acceptor
+
+static struct {
+    int sig_fd;
+    int ctl_fd;
+    const char *path;
+    const char *label;       // default DUMP label
+    atomic_int stop;
+    // Client threads still running and the stats slots they hold (thread mode)
+    pthread_mutex_t lock;
+    pthread_cond_t idle;
+    int live_threads;
+    char *slot_busy;
+    int num_slots;
+} control = {
+    .sig_fd = -1,
+    .ctl_fd = -1,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER
+};
+
+
+/************************************************/
+
+//CLIENT THREADS (DETACHED, COUNTED)
+
+struct thread_start {
+    void *(*fn)(void *);
+    void *arg;
+    int slot;
+};
+
+int server_slot_acquire(void) {
+    int slot = -1;
+    pthread_mutex_lock(&control.lock);
+    for (int i = 0; i < control.num_slots && slot < 0; i++) {
+        if (!control.slot_busy[i]) slot = i;
+    }
+    if (slot >= 0) control.slot_busy[slot] = 1;
+    pthread_mutex_unlock(&control.lock);
+    return slot;
+}
+
+// Caller holds control.lock
+static void slot_release_locked(int slot) {
+    if (slot >= 0 && slot < control.num_slots) control.slot_busy[slot] = 0;
+}
+
+static void* counted_thread(void *p) {
+    struct thread_start start = *(struct thread_start*)p;
+    free(p);
+    start.fn(start.arg);
+
+    // The slot is free only once its owner has made its last update
+    pthread_mutex_lock(&control.lock);
+    slot_release_locked(start.slot);
+    if (--control.live_threads == 0) pthread_cond_broadcast(&control.idle);
+    pthread_mutex_unlock(&control.lock);
+    return NULL;
+}
+
+int server_thread_start(int *cpu, int slot, void *(*fn)(void *), void *arg) {
+
+    struct thread_start *start = malloc(sizeof(*start));
+    if (!start) {
+        pthread_mutex_lock(&control.lock);
+        slot_release_locked(slot);
+        pthread_mutex_unlock(&control.lock);
+        return ENOMEM;
+    }
+    start->fn = fn;
+    start->arg = arg;
+    start->slot = slot;
+
+    pthread_mutex_lock(&control.lock);
+    control.live_threads++;
+    pthread_mutex_unlock(&control.lock);
+
+    pthread_t tid;
+    int rc = pinned_thread_create(&tid, cpu, counted_thread, start);
+    if (rc != 0) {
+        free(start);
+        pthread_mutex_lock(&control.lock);
+        slot_release_locked(slot);
+        control.live_threads--;
+        pthread_mutex_unlock(&control.lock);
+        return rc;
+    }
+    // Never joined: an open-ended server would otherwise keep every finished stack
+    pthread_detach(tid);
+    return 0;
+}
+
+void server_threads_wait(void) {
+    pthread_mutex_lock(&control.lock);
+    while (control.live_threads > 0) pthread_cond_wait(&control.idle, &control.lock);
+    pthread_mutex_unlock(&control.lock);
+}
+
+
+/************************************************/
+
+//CONTROL SOCKET
+
+int server_control_init(const struct server_config *cfg, const char *label) {
+
+    control.label = label;
+    control.num_slots = cfg->num_clients;
+    control.slot_busy = calloc(cfg->num_clients, 1);
+    if (!control.slot_busy) {
+        perror("Failed to allocate the stats slot list");
+        return -1;
+    }
+    if (!cfg->persistent) return 0;
+
+    // Blocked here, before any worker exists, so every thread inherits the mask
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+    control.sig_fd = signalfd(-1, &mask, SFD_CLOEXEC);
+    if (control.sig_fd < 0) {
+        perror("signalfd failed");
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(cfg->control_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Control socket path too long: %s\n", cfg->control_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, cfg->control_path);
+    unlink(cfg->control_path);   // left behind by a server that was killed
+
+    control.ctl_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (control.ctl_fd < 0 || bind(control.ctl_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(control.ctl_fd, 4) < 0) {
+        perror("Control socket setup failed");
+        return -1;
+    }
+    control.path = cfg->control_path;
+
+    printf("Persistent server: pid %d, control socket %s (RESET, DUMP [label], PID, SHUTDOWN)\n",
+           (int)getpid(), control.path);
+    fflush(stdout);
+    return 0;
+}
+
+void server_request_shutdown(const char *why) {
+    if (atomic_exchange(&control.stop, 1)) return;
+    printf("%s: no new connections, waiting for the open ones to finish\n", why);
+    fflush(stdout);
+}
+
+// One command per connection: read a line, write the reply, close
+static void serve_control_client(void) {
+
+    int fd = accept4(control.ctl_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) return;
+    struct timeval tv = { .tv_sec = CONTROL_RECV_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char line[CONTROL_LINE_MAX];
+    size_t len = 0;
+    while (len < sizeof(line) - 1) {
+        ssize_t n = read(fd, line + len, sizeof(line) - 1 - len);
+        if (n <= 0) break;
+        len += n;
+        if (memchr(line, '\n', len)) break;
+    }
+    line[len] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+
+    char reply[CONTROL_REPLY_MAX];
+    char *arg = strchr(line, ' ');
+    if (arg) *arg++ = '\0';
+
+    if (strcmp(line, "RESET") == 0) {
+        server_stats_reset();
+        snprintf(reply, sizeof(reply), "OK\n");
+    } else if (strcmp(line, "DUMP") == 0) {
+        server_stats_dump(arg && *arg ? arg : control.label, reply, sizeof(reply));
+    } else if (strcmp(line, "PID") == 0) {
+        snprintf(reply, sizeof(reply), "%d\n", (int)getpid());
+    } else if (strcmp(line, "SHUTDOWN") == 0) {
+        server_request_shutdown("SHUTDOWN requested");
+        snprintf(reply, sizeof(reply), "OK\n");
+    } else {
+        snprintf(reply, sizeof(reply), "ERR unknown command '%s'\n", line);
+    }
+
+    ssize_t w = write(fd, reply, strlen(reply));
+    (void)w;
+    close(fd);
+}
+
+int server_control_wait(int fd) {
+
+    while (!atomic_load(&control.stop)) {
+        struct pollfd pfds[3] = {
+            { .fd = control.sig_fd, .events = POLLIN },
+            { .fd = control.ctl_fd, .events = POLLIN },
+            { .fd = fd, .events = POLLIN },          // -1: only serve control requests
+        };
+        if (poll(pfds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll failed");
+            server_request_shutdown("poll failed");
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            struct signalfd_siginfo si;
+            if (read(control.sig_fd, &si, sizeof(si)) == sizeof(si)) {
+                server_request_shutdown(strsignal(si.ssi_signo));
+            }
+            continue;
+        }
+        if (pfds[1].revents & POLLIN) serve_control_client();
+        if (pfds[2].revents & POLLIN) return 1;
+    }
+    return 0;
+}
+
+int server_shutting_down(void) {
+    return atomic_load(&control.stop);
+}
+
+int server_keep_accepting(const struct server_config *cfg, int i, int listen_fd) {
+    return cfg->persistent ? server_control_wait(listen_fd) : i < cfg->num_clients;
+}
+
+void server_control_close(void) {
+    if (control.ctl_fd >= 0) close(control.ctl_fd);
+    if (control.sig_fd >= 0) close(control.sig_fd);
+    if (control.path) unlink(control.path);
+    control.ctl_fd = control.sig_fd = -1;
+    control.path = NULL;
+    free(control.slot_busy);   // every client thread has returned by now
+    control.slot_busy = NULL;
+    control.num_slots = 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Ctl.c
+ * Sends one command to a --persistent server's control socket and prints the reply
+ *
+ *   ./MT25074_Part_A_Ctl [--control PATH] RESET | DUMP [label] | PID | SHUTDOWN
+ *
+ * The socket is a path in the filesystem, so this works from outside the
+ * server's network namespace (Part B talks to a server running in ns1).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "MT25074_Part_A_Common.h"
+
+int main(int argc, char *argv[]) {
+
+    const char *path = DEFAULT_CONTROL_PATH;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--control") == 0) {
+        path = argv[2];
+        first = 3;
+    }
+    if (argc - first < 1) {
+        fprintf(stderr, "Usage: %s [--control PATH] RESET | DUMP [label] | PID | SHUTDOWN\n", argv[0]);
+        return 1;
+    }
+
+    // Command line: the remaining words joined by spaces
+    char cmd[256] = "";
+    for (int i = first; i < argc; i++) {
+        if (strlen(cmd) + strlen(argv[i]) + 2 >= sizeof(cmd)) {
+            fprintf(stderr, "Command too long\n");
+            return 1;
+        }
+        if (i > first) strcat(cmd, " ");
+        strcat(cmd, argv[i]);
+    }
+    strcat(cmd, "\n");
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Control socket path too long: %s\n", path);
+        return 1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("Cannot reach the server's control socket");
+        return 1;
+    }
+    if (write(fd, cmd, strlen(cmd)) != (ssize_t)strlen(cmd)) {
+        perror("Control write failed");
+        close(fd);
+        return 1;
+    }
+
+    // The server writes one reply and closes
+    char reply[512];
+    ssize_t n;
+    int failed = 0;
+    while ((n = read(fd, reply, sizeof(reply))) > 0) {
+        if (strncmp(reply, "ERR", 3) == 0) failed = 1;
+        fwrite(reply, 1, n, stdout);
+    }
+    close(fd);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Deadline.c
+ * Client run clock: warm-up, measured window and stop, driven by a timerfd
+ *
+ * The hot loops used to call time(NULL) on every message and could only see
+ * whole seconds. Here one helper thread sleeps on a CLOCK_MONOTONIC timerfd
+ * armed with absolute expiry times and publishes the phase through an atomic;
+ * the senders only do a relaxed load per message. The exact start and end of
+ * the measured window are taken from CLOCK_MONOTONIC by the same thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/timerfd.h>
+#include "MT25074_Part_A_Common.h"
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Blocks until the timerfd reaches the absolute CLOCK_MONOTONIC time at_ns
+static int sleep_until(int tfd, uint64_t at_ns) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = at_ns / 1000000000ull;
+    its.it_value.tv_nsec = at_ns % 1000000000ull;
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) < 0) return -1;
+
+    uint64_t expirations;
+    while (read(tfd, &expirations, sizeof(expirations)) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return 0;
+}
+
+static void* deadline_thread(void *arg) {
+
+    struct run_deadline *dl = (struct run_deadline*)arg;
+    uint64_t t0 = monotonic_ns();
+    uint64_t measure_at = t0 + (uint64_t)dl->warmup_s * 1000000000ull;
+
+    if (dl->warmup_s > 0 && sleep_until(dl->timer_fd, measure_at) < 0) {
+        perror("timerfd warm-up wait failed");
+    }
+    // Take the timestamp first, then publish: a reader that sees the phase sees the time
+    dl->measure_start_ns = monotonic_ns();
+    atomic_store_explicit(&dl->phase, RUN_MEASURE, memory_order_release);
+
+    uint64_t stop_at = dl->measure_start_ns + (uint64_t)dl->duration_s * 1000000000ull;
+    if (sleep_until(dl->timer_fd, stop_at) < 0) {
+        perror("timerfd deadline wait failed");
+    }
+    dl->measure_end_ns = monotonic_ns();
+    atomic_store_explicit(&dl->phase, RUN_STOP, memory_order_release);
+    return NULL;
+}
+
+int run_deadline_start(struct run_deadline *dl, int warmup_s, int duration_s) {
+
+    memset(dl, 0, sizeof(*dl));
+    dl->warmup_s = warmup_s;
+    dl->duration_s = duration_s;
+    atomic_init(&dl->phase, warmup_s > 0 ? RUN_WARMUP : RUN_MEASURE);
+
+    dl->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (dl->timer_fd < 0) {
+        perror("timerfd_create failed");
+        return -1;
+    }
+    int rc = pthread_create(&dl->thread, NULL, deadline_thread, dl);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to create deadline thread: %s\n", strerror(rc));
+        close(dl->timer_fd);
+        return -1;
+    }
+    return 0;
+}
+
+double run_deadline_finish(struct run_deadline *dl) {
+
+    // A client that bailed out early (e.g. server gone) should not sit out the timer
+    if (atomic_load(&dl->phase) != RUN_STOP) pthread_cancel(dl->thread);  // read() is a cancellation point
+    pthread_join(dl->thread, NULL);
+    close(dl->timer_fd);
+
+    if (dl->measure_start_ns == 0) return 0.0;          // stopped during warm-up
+    uint64_t end = dl->measure_end_ns ? dl->measure_end_ns : monotonic_ns();
+    return (end - dl->measure_start_ns) / 1e9;
+}
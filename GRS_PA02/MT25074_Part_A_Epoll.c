@@ -0,0 +1,634 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Epoll.c
+ * Event-loop server mode: N epoll loops instead of one thread per connection
+ *
+ * The loops are a fixed worker pool (default: one per worker core, each loop
+ * optionally pinned). Connections reach them in one of two ways:
+ *   - reuseport: every loop owns its own SO_REUSEPORT listening socket bound to
+ *     the same address, so the kernel spreads connections and no accept lock
+ *     is needed
+ *   - rr / least: the main thread accepts on one listener and hands each fd to
+ *     a loop (round-robin or fewest open connections) through a small inbox
+ *     plus an eventfd wake-up
+ * With --persistent the loops keep accepting until shutdown is requested
+ * (MT25074_Part_A_Control.c) and then finish their open connections.
+ * Accepted sockets are non-blocking and registered edge-triggered; each one
+ * carries a tiny state machine for the 8-field request/response exchange
+ * (receive whole request -> send whole response). With --framed each of the
+ * two steps is preceded by its 16-byte frame header.
+ */
+
+#define _GNU_SOURCE  // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "MT25074_Part_A_Common.h"
+
+#define MAX_EVENTS 64
+#define EPOLL_TIMEOUT_MS 100   // loops wake up this often to notice global shutdown
+
+// Per-connection state machine (the header states are used only with --framed)
+enum conn_state {
+    CONN_RECV_HEADER,
+    CONN_RECV_REQUEST,
+    CONN_SEND_HEADER,
+    CONN_SEND_RESPONSE
+};
+
+// Result of driving a connection as far as the socket allows
+enum conn_result {
+    CONN_WAIT,     // socket would block, wait for the next edge
+    CONN_CLOSED,   // peer closed cleanly between messages
+    CONN_ERROR     // I/O error or peer closed mid-message
+};
+
+struct epoll_conn {
+    int fd;
+    enum conn_state state;
+    size_t offset;              // bytes done in the current phase (0 .. length, or the header size)
+    size_t length;              // payload bytes of the current message (always full when unframed)
+    struct frame_hdr hdr;       // --framed: header being received, then the one being sent back
+    struct message *request;    // receive buffer for one whole request
+    uint64_t msg_count;
+};
+
+// State shared by all loops (accept/finish accounting)
+struct reactor_shared {
+    const struct server_config *cfg;
+    const struct server_ops *ops;
+    atomic_int accepted;
+    atomic_int finished;
+};
+
+// An fd the acceptor has handed to a loop but the loop has not registered yet
+struct pending_conn {
+    int fd;
+    int slot;                   // 0-based accept order (log line only)
+    struct sockaddr_in addr;
+};
+
+struct epoll_loop {
+    int id;
+    int cpu;                // core this loop is pinned to, -1 = unpinned
+    int epoll_fd;
+    int listen_fd;          // reuseport only; -1 once all clients have been accepted
+    int wake_fd;            // rr / least only: eventfd signalled when the inbox has fds
+    pthread_mutex_t inbox_lock;
+    struct pending_conn *inbox;   // accepted fds waiting to be registered by this loop
+    int inbox_len;
+    atomic_int load;        // open connections, read by the least-loaded acceptor
+    int live_conns;
+    struct message *response;   // read-only response, shared by this loop's connections
+                                // (built by the loop thread itself, after pinning)
+    int failed;                 // the loop could not build its response
+    struct reactor_shared *shared;
+    pthread_t tid;
+};
+
+
+/************************************************/
+
+//LISTENING SOCKETS (ONE PER LOOP, SO_REUSEPORT)
+
+static int create_reuseport_listener(void) {
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("server socket creation failed");
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        perror("SO_REUSEPORT failed");
+        close(fd);
+        return -1;
+    }
+
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(SERVER_PORT);
+    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+        perror("inet_pton failed to convert server IP structure to Binary form");
+        close(fd);
+        return -1;
+    }
+
+    if (bind(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("Bind failed to listening socket");
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, BACKLOG) < 0) {
+        perror("Listening function failed for the server listening socket");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/************************************************/
+
+//CONNECTION STATE MACHINE
+
+static void close_conn(struct epoll_loop *loop, struct epoll_conn *conn) {
+    if (loop->shared->ops->conn_errqueue) loop->shared->ops->conn_errqueue(conn->fd);
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    server_stats_conn_closed(conn->fd);
+    if (loop->shared->ops->teardown_conn) loop->shared->ops->teardown_conn(conn->fd);
+    close(conn->fd);
+    free_message(conn->request);
+    free(conn);
+    loop->live_conns--;
+    atomic_fetch_sub(&loop->load, 1);
+    atomic_fetch_add(&loop->shared->finished, 1);
+}
+
+// Next message: framed connections start with its header, unframed ones
+// always carry a full-size payload
+static void conn_next_message(struct epoll_loop *loop, struct epoll_conn *conn) {
+    conn->state = loop->shared->cfg->framed ? CONN_RECV_HEADER : CONN_RECV_REQUEST;
+    conn->length = NUM_FIELDS * loop->shared->cfg->field_size;
+    conn->offset = 0;
+}
+
+// Drives one connection until the socket would block. Each attempt covers the
+// rest of the current header or message as one vectored call (up to
+// NUM_FIELDS iovecs).
+static enum conn_result conn_progress(struct epoll_loop *loop, struct epoll_conn *conn) {
+
+    const struct server_ops *ops = loop->shared->ops;
+    size_t max_length = NUM_FIELDS * loop->shared->cfg->field_size;
+    struct iovec iov[NUM_FIELDS];
+
+    while (1) {
+        int sending = conn->state == CONN_SEND_HEADER || conn->state == CONN_SEND_RESPONSE;
+        int cnt;
+        if (conn->state == CONN_RECV_HEADER || conn->state == CONN_SEND_HEADER) {
+            iov[0].iov_base = (char*)&conn->hdr + conn->offset;
+            iov[0].iov_len = sizeof(conn->hdr) - conn->offset;
+            cnt = 1;
+        } else {
+            cnt = message_iov_range(sending ? loop->response : conn->request,
+                                    conn->offset, conn->length, iov);
+        }
+
+        ssize_t n;
+        if (conn->state == CONN_SEND_HEADER) n = frame_header_send_some(conn->fd, iov, cnt);
+        else if (sending) n = ops->send_some(conn->fd, iov, cnt);
+        else n = ops->recv_some(conn->fd, iov, cnt);
+        stats_syscall();
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return CONN_WAIT;
+            if (sending) printf("Server [%s epoll]: Send failed\n", ops->name);
+            return CONN_ERROR;
+        }
+        if (n == 0 && !sending) {
+            // Clean close only on a message boundary
+            enum conn_state first = loop->shared->cfg->framed ? CONN_RECV_HEADER : CONN_RECV_REQUEST;
+            if (conn->offset == 0 && conn->state == first) return CONN_CLOSED;
+            printf("Server [%s epoll]: Receive error or partial (%zu/%zu)\n",
+                   ops->name, conn->offset, conn->length);
+            return CONN_ERROR;
+        }
+        conn->offset += n;
+
+        switch (conn->state) {
+        case CONN_RECV_HEADER: {
+            if (conn->offset < sizeof(conn->hdr)) break;
+            struct frame_hdr h;
+            if (frame_decode(&conn->hdr, &h, max_length) < 0) {
+                printf("Server [%s epoll]: Bad header, closing\n", ops->name);
+                return CONN_ERROR;
+            }
+            // Echo the size back: same length, field count and request id
+            frame_encode(&conn->hdr, h.length, h.num_fields, h.request_id);
+            conn->length = h.length;
+            conn->state = CONN_RECV_REQUEST;
+            conn->offset = 0;
+            break;
+        }
+        case CONN_RECV_REQUEST:
+            if (conn->offset < conn->length) break;
+            conn->state = loop->shared->cfg->framed ? CONN_SEND_HEADER : CONN_SEND_RESPONSE;
+            conn->offset = 0;
+            break;
+        case CONN_SEND_HEADER:
+            if (conn->offset < sizeof(conn->hdr)) break;
+            conn->state = CONN_SEND_RESPONSE;
+            conn->offset = 0;
+            break;
+        case CONN_SEND_RESPONSE:
+            if (conn->offset < conn->length) break;
+            conn->msg_count++;
+            server_stats_message(2 * conn->length);  // request + response payload
+            conn_next_message(loop, conn);
+            break;
+        }
+    }
+}
+
+// Registers an accepted (non-blocking) socket with this loop. slot is the
+// 0-based accept order, used only for the log line. loop->load already counts it.
+static void add_conn(struct epoll_loop *loop, int conn_fd, int slot, const struct sockaddr_in *client_addr) {
+
+    struct reactor_shared *shared = loop->shared;
+
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &client_addr->sin_addr, ip, INET_ADDRSTRLEN);
+    printf("Client %d/%d from %s:%d (loop %d)\n", slot + 1, shared->cfg->num_clients,
+           ip, ntohs(client_addr->sin_port), loop->id);
+
+    if (shared->ops->setup_conn) shared->ops->setup_conn(conn_fd);
+
+    struct epoll_conn *conn = calloc(1, sizeof(*conn));
+    struct message *request = conn ? create_message(shared->cfg->field_size, 'S') : NULL;
+    if (!conn || !request) {
+        free(conn);
+        if (shared->ops->teardown_conn) shared->ops->teardown_conn(conn_fd);
+        close(conn_fd);
+        atomic_fetch_sub(&loop->load, 1);
+        atomic_fetch_add(&shared->finished, 1);
+        return;
+    }
+    conn->fd = conn_fd;
+    conn->request = request;
+    conn_next_message(loop, conn);
+
+    struct epoll_event ev = {
+        .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+        .data.ptr = conn
+    };
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, conn_fd, &ev) < 0) {
+        perror("epoll_ctl ADD failed");
+        free_message(request);
+        free(conn);
+        close(conn_fd);
+        atomic_fetch_sub(&loop->load, 1);
+        atomic_fetch_add(&shared->finished, 1);
+        return;
+    }
+    loop->live_conns++;
+}
+
+// Accepts everything queued on this loop's listener (edge-triggered => drain)
+static void accept_pending(struct epoll_loop *loop) {
+
+    struct reactor_shared *shared = loop->shared;
+
+    while (loop->listen_fd >= 0) {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+
+        int conn_fd = accept4(loop->listen_fd, (struct sockaddr *)&client_addr, &addr_len, SOCK_NONBLOCK);
+        if (conn_fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("Accept failed");
+            return;
+        }
+
+        int slot = atomic_fetch_add(&shared->accepted, 1);
+        if (!shared->cfg->persistent && slot >= shared->cfg->num_clients) {
+            // More clients than requested: same as the thread model, they are not served
+            close(conn_fd);
+            continue;
+        }
+
+        atomic_fetch_add(&loop->load, 1);
+        add_conn(loop, conn_fd, slot, &client_addr);
+    }
+}
+
+// Registers the fds the acceptor queued for this loop (rr / least dispatch)
+static void drain_inbox(struct epoll_loop *loop) {
+
+    // Reset the eventfd counter; the inbox itself says how much work there is
+    uint64_t ignored;
+    ssize_t r = read(loop->wake_fd, &ignored, sizeof(ignored));
+    (void)r;
+
+    struct pending_conn batch[MAX_EVENTS];
+    while (1) {
+        pthread_mutex_lock(&loop->inbox_lock);
+        int n = loop->inbox_len < MAX_EVENTS ? loop->inbox_len : MAX_EVENTS;
+        loop->inbox_len -= n;
+        memcpy(batch, loop->inbox + loop->inbox_len, n * sizeof(batch[0]));
+        pthread_mutex_unlock(&loop->inbox_lock);
+        if (n == 0) return;
+
+        for (int i = 0; i < n; i++) add_conn(loop, batch[i].fd, batch[i].slot, &batch[i].addr);
+    }
+}
+
+
+/************************************************/
+
+//EVENT LOOP
+
+static int inbox_empty(struct epoll_loop *loop) {
+    pthread_mutex_lock(&loop->inbox_lock);
+    int empty = loop->inbox_len == 0;
+    pthread_mutex_unlock(&loop->inbox_lock);
+    return empty;
+}
+
+// Every client counts as seen, so the other loops and the acceptor wind down
+static void abandon_run(struct reactor_shared *shared, const char *why) {
+    atomic_store(&shared->accepted, shared->cfg->num_clients);
+    atomic_store(&shared->finished, shared->cfg->num_clients);
+    if (shared->cfg->persistent) server_request_shutdown(why);
+}
+
+static void* epoll_loop_thread(void *arg) {
+
+    struct epoll_loop *loop = (struct epoll_loop*)arg;
+    server_stats_bind(loop->id);   // one counter slot per loop
+    struct reactor_shared *shared = loop->shared;
+    int num_clients = shared->cfg->num_clients;
+    int persistent = shared->cfg->persistent;
+    struct epoll_event events[MAX_EVENTS];
+
+    // Created on this (already pinned) thread, so --numa-local binds it to the
+    // node of the loop that sends it rather than the main thread's node
+    size_t field_size = shared->cfg->field_size;
+    loop->response = shared->ops->create_response ? shared->ops->create_response(field_size)
+                                                  : create_message(field_size, 'S');  // Server pattern
+    if (!loop->response) {
+        fprintf(stderr, "Loop %d: cannot create the response message\n", loop->id);
+        loop->failed = 1;
+        abandon_run(shared, "Loop setup failed");
+        return NULL;
+    }
+
+    while (1) {
+        // Stop listening once every expected client has been accepted somewhere
+        // (--persistent: once shutdown has been requested)
+        int accepting = persistent ? !server_shutting_down()
+                                   : atomic_load(&shared->accepted) < num_clients;
+        if (loop->listen_fd >= 0 && !accepting) {
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, loop->listen_fd, NULL);
+            close(loop->listen_fd);
+            loop->listen_fd = -1;
+        }
+        // The acceptor stops before shutdown is flagged, so an empty inbox stays empty
+        int all_done = persistent ? server_shutting_down() && inbox_empty(loop)
+                                  : atomic_load(&shared->finished) >= num_clients;
+        if (loop->listen_fd < 0 && loop->live_conns == 0 && all_done) {
+            break;
+        }
+
+        int nready = epoll_wait(loop->epoll_fd, events, MAX_EVENTS, EPOLL_TIMEOUT_MS);
+        // Idle timeouts are not data-path work; counting them would keep an idle
+        // server's counters moving forever
+        if (nready != 0) stats_syscall();
+        if (nready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            break;
+        }
+
+        for (int i = 0; i < nready; i++) {
+            if (events[i].data.ptr == NULL) {
+                accept_pending(loop);
+                continue;
+            }
+            if (events[i].data.ptr == loop) {
+                drain_inbox(loop);
+                continue;
+            }
+
+            struct epoll_conn *conn = events[i].data.ptr;
+            if ((events[i].events & EPOLLERR) && shared->ops->conn_errqueue) {
+                shared->ops->conn_errqueue(conn->fd);
+            }
+            enum conn_result res = conn_progress(loop, conn);
+            if (res == CONN_CLOSED) {
+                printf("Server [%s epoll loop %d]: Client closed connection - Total messages: %lu\n",
+                       shared->ops->name, loop->id, conn->msg_count);
+                close_conn(loop, conn);
+            } else if (res == CONN_ERROR) {
+                close_conn(loop, conn);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/************************************************/
+
+//ACCEPTOR (RR / LEAST DISPATCH)
+
+static struct epoll_loop* pick_loop(struct epoll_loop *loops, int num_loops, int dispatch, int *next) {
+    if (dispatch == DISPATCH_ROUND_ROBIN) {
+        struct epoll_loop *loop = &loops[*next];
+        *next = (*next + 1) % num_loops;
+        return loop;
+    }
+    // Least loaded: fewest open connections, lowest id on ties
+    struct epoll_loop *best = &loops[0];
+    for (int i = 1; i < num_loops; i++) {
+        if (atomic_load(&loops[i].load) < atomic_load(&best->load)) best = &loops[i];
+    }
+    return best;
+}
+
+// Runs on the main thread: accepts every expected client (--persistent: until
+// shutdown) on one blocking listener and queues each fd on the loop chosen by
+// the dispatch policy
+static void run_acceptor(int listen_fd, struct epoll_loop *loops, struct reactor_shared *shared) {
+
+    const struct server_config *cfg = shared->cfg;
+    int next = 0;
+
+    while (cfg->persistent ? server_control_wait(listen_fd)
+                           : atomic_load(&shared->accepted) < cfg->num_clients) {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+
+        int conn_fd = accept4(listen_fd, (struct sockaddr *)&client_addr, &addr_len, SOCK_NONBLOCK);
+        if (conn_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("Accept failed");
+            if (cfg->persistent) {
+                server_request_shutdown("Acceptor stopped");
+                return;
+            }
+            // Count the clients that will never arrive as done so the loops can exit
+            int missing = cfg->num_clients - atomic_exchange(&shared->accepted, cfg->num_clients);
+            atomic_fetch_add(&shared->finished, missing);
+            return;
+        }
+
+        int slot = atomic_fetch_add(&shared->accepted, 1);
+        struct epoll_loop *loop = pick_loop(loops, cfg->num_loops, cfg->dispatch, &next);
+        atomic_fetch_add(&loop->load, 1);
+
+        // The inbox holds num_clients fds; only a persistent server can outrun its loop
+        pthread_mutex_lock(&loop->inbox_lock);
+        int queued = loop->inbox_len < cfg->num_clients;
+        if (queued) loop->inbox[loop->inbox_len++] = (struct pending_conn){ conn_fd, slot, client_addr };
+        pthread_mutex_unlock(&loop->inbox_lock);
+        if (!queued) {
+            fprintf(stderr, "Loop %d inbox full, dropping connection\n", loop->id);
+            close(conn_fd);
+            atomic_fetch_sub(&loop->load, 1);
+            continue;
+        }
+
+        uint64_t one = 1;
+        if (write(loop->wake_fd, &one, sizeof(one)) < 0) perror("eventfd write failed");
+    }
+}
+
+
+/************************************************/
+
+//REACTOR SETUP
+
+int run_epoll_server(const struct server_config *cfg, const struct server_ops *ops) {
+
+    struct reactor_shared shared = { .cfg = cfg, .ops = ops };
+    atomic_init(&shared.accepted, 0);
+    atomic_init(&shared.finished, 0);
+
+    struct epoll_loop *loops = calloc(cfg->num_loops, sizeof(*loops));
+    if (!loops) {
+        perror("Failed to allocate epoll loops");
+        return -1;
+    }
+
+    static const char *dispatch_names[] = { "reuseport", "rr", "least" };
+    printf("Server [%s epoll]: field_size=%zu, accepting %d clients on %d loops (dispatch %s, %s%s)\n",
+           ops->name, cfg->field_size, cfg->num_clients, cfg->num_loops,
+           dispatch_names[cfg->dispatch], cfg->num_cpus > 0 ? "pinned" : "unpinned",
+           cfg->framed ? ", framed" : "");
+
+    int use_acceptor = (cfg->dispatch != DISPATCH_REUSEPORT);
+    int acceptor_fd = -1;
+
+    for (int i = 0; i < cfg->num_loops; i++) {
+        loops[i].listen_fd = -1;
+        loops[i].epoll_fd = -1;
+        loops[i].wake_fd = -1;
+        pthread_mutex_init(&loops[i].inbox_lock, NULL);
+        atomic_init(&loops[i].load, 0);
+    }
+
+    // Set up every listener before any loop runs so clients never see a refused connect
+    int ready = 0;
+    if (use_acceptor) {
+        acceptor_fd = create_reuseport_listener();
+        int flags = acceptor_fd >= 0 ? fcntl(acceptor_fd, F_GETFL, 0) : -1;
+        if (flags < 0 || fcntl(acceptor_fd, F_SETFL, flags & ~O_NONBLOCK) < 0) ready = -1;
+    }
+    for (int i = 0; ready >= 0 && i < cfg->num_loops; i++) {
+        struct epoll_loop *loop = &loops[i];
+        loop->id = i;
+        loop->shared = &shared;
+        loop->epoll_fd = epoll_create1(0);
+        if (loop->epoll_fd < 0) {
+            perror("epoll_create1 failed");
+            break;
+        }
+
+        // The loop's wake-up source: its own listener, or the acceptor's eventfd
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLET, .data.ptr = NULL };
+        if (use_acceptor) {
+            loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            loop->inbox = calloc(cfg->num_clients, sizeof(*loop->inbox));
+            if (loop->wake_fd < 0 || !loop->inbox) {
+                perror("eventfd / inbox setup failed");
+                break;
+            }
+            ev.events = EPOLLIN;
+            ev.data.ptr = loop;
+            if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &ev) < 0) {
+                perror("epoll_ctl ADD eventfd failed");
+                break;
+            }
+        } else {
+            loop->listen_fd = create_reuseport_listener();
+            if (loop->listen_fd < 0) break;
+            if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->listen_fd, &ev) < 0) {
+                perror("epoll_ctl ADD listener failed");
+                break;
+            }
+        }
+        ready++;
+    }
+
+    int rc = 0;
+    if (ready != cfg->num_loops) {
+        rc = -1;
+    } else if (server_control_init(cfg, ops->name) < 0 ||   // before any loop thread exists
+               server_stats_init(cfg->num_loops, cfg->stats_interval_ms) < 0) {
+        rc = -1;
+    } else {
+        printf("Server Listening on %s:%d\n", SERVER_IP, SERVER_PORT);
+        fflush(stdout);  // the benchmark driver waits for this line before starting clients
+
+        int started = 0;
+        for (int i = 0; i < cfg->num_loops; i++) {
+            loops[i].cpu = server_worker_cpu(cfg, i);
+            if (pinned_thread_create(&loops[i].tid, &loops[i].cpu, epoll_loop_thread, &loops[i]) != 0) {
+                perror("Failed to create epoll loop thread");
+                rc = -1;
+                // Loops that did start still need every client to finish; let them
+                // see the target as reached so they wind down instead of hanging.
+                abandon_run(&shared, "Loop start failed");
+                break;
+            }
+            if (loops[i].cpu >= 0) printf("Loop %d pinned to cpu %d\n", i, loops[i].cpu);
+            started++;
+        }
+        if (use_acceptor && started == cfg->num_loops) {
+            run_acceptor(acceptor_fd, loops, &shared);
+        } else if (cfg->persistent && started == cfg->num_loops) {
+            // The loops accept for themselves; this thread only serves the control socket
+            server_control_wait(-1);
+        }
+        for (int i = 0; i < started; i++) {
+            pthread_join(loops[i].tid, NULL);
+            if (loops[i].failed) rc = -1;
+        }
+        server_stats_finish(ops->name);
+    }
+    server_control_close();
+
+    if (acceptor_fd >= 0) close(acceptor_fd);
+    for (int i = 0; i < cfg->num_loops; i++) {
+        if (loops[i].listen_fd >= 0) close(loops[i].listen_fd);
+        if (loops[i].epoll_fd >= 0) close(loops[i].epoll_fd);
+        if (loops[i].wake_fd >= 0) close(loops[i].wake_fd);
+        // Anything still queued was never registered with a loop
+        for (int j = 0; j < loops[i].inbox_len; j++) close(loops[i].inbox[j].fd);
+        free(loops[i].inbox);
+        pthread_mutex_destroy(&loops[i].inbox_lock);
+        free_message(loops[i].response);
+    }
+    free(loops);
+
+    if (rc == 0) printf("All done. Server exiting.\n");
+    return rc;
+}
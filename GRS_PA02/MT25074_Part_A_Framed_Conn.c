@@ -0,0 +1,66 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Framed_Conn.c
+ * Thread-mode server loop for --framed connections
+ *
+ * Kept apart from the codec (MT25074_Part_A_Framing.c) because it reports to
+ * the server throughput counters, which clients do not link.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+#include "MT25074_Part_A_Common.h"
+
+// Transfers the first end bytes of msg with io, like iov_transfer_all()
+static ssize_t message_transfer(int fd, struct message *msg, size_t end, iov_io_fn io) {
+    struct iovec iov[NUM_FIELDS];
+    int cnt = message_iov_range(msg, 0, end, iov);
+    return cnt ? iov_transfer_all(fd, iov, cnt, io) : 0;
+}
+
+uint64_t serve_framed_conn(int conn_fd, size_t field_size, const struct server_ops *ops) {
+
+    size_t max_length = NUM_FIELDS * field_size;
+    struct message *request = create_message(field_size, 'S');
+    struct message *response = ops->create_response ? ops->create_response(field_size)
+                                                    : create_message(field_size, 'S');  // Server pattern
+    uint64_t msg_count = 0;
+
+    while (request && response) {
+        struct frame_hdr wire, hdr;
+        struct iovec hiov = { .iov_base = &wire, .iov_len = sizeof(wire) };
+
+        ssize_t n = iov_transfer_all(conn_fd, &hiov, 1, ops->recv_some);
+        if (n == 0) {
+            printf("Server [%s framed]: Client closed connection - Total messages: %lu\n",
+                   ops->name, msg_count);
+            break;
+        }
+        if (n != (ssize_t)sizeof(wire) || frame_decode(&wire, &hdr, max_length) < 0) {
+            printf("Server [%s framed]: Bad or partial header, closing\n", ops->name);
+            break;
+        }
+        if (message_transfer(conn_fd, request, hdr.length, ops->recv_some) != (ssize_t)hdr.length) {
+            printf("Server [%s framed]: Receive error or partial payload\n", ops->name);
+            break;
+        }
+
+        // Echo the size back: same length, field count and request id
+        frame_encode(&wire, hdr.length, hdr.num_fields, hdr.request_id);
+        hiov.iov_base = &wire;
+        hiov.iov_len = sizeof(wire);
+        if (iov_transfer_all(conn_fd, &hiov, 1, frame_header_send_some) != (ssize_t)sizeof(wire) ||
+            message_transfer(conn_fd, response, hdr.length, ops->send_some) != (ssize_t)hdr.length) {
+            printf("Server [%s framed]: Send failed\n", ops->name);
+            break;
+        }
+
+        msg_count++;
+        server_stats_message(2 * (size_t)hdr.length);  // request + response payload
+    }
+
+    free_message(request);
+    free_message(response);
+    return msg_count;
+}
@@ -0,0 +1,167 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Framing.c
+ * Length-prefixed framed protocol (--framed): header codec and client size
+ * distributions. The thread-mode server loop is in MT25074_Part_A_Framed_Conn.c.
+ *
+ * Without framing both peers must be started with the same field_size, and a
+ * mismatch just leaves both sides waiting in recv. With --framed every
+ * message carries a 16-byte header (magic, field count, payload length,
+ * request id), so one connection can mix sizes up to the server's limit and
+ * a bad peer is reported and dropped instead of hanging.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <endian.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "MT25074_Part_A_Common.h"
+
+
+/************************************************/
+
+//HEADER CODEC
+
+void frame_encode(struct frame_hdr *wire, uint32_t length, uint16_t num_fields, uint64_t request_id) {
+    wire->magic = htons(FRAME_MAGIC);
+    wire->num_fields = htons(num_fields);
+    wire->length = htonl(length);
+    wire->request_id = htobe64(request_id);
+}
+
+int frame_decode(const struct frame_hdr *wire, struct frame_hdr *out, size_t max_length) {
+    out->magic = ntohs(wire->magic);
+    out->num_fields = ntohs(wire->num_fields);
+    out->length = ntohl(wire->length);
+    out->request_id = be64toh(wire->request_id);
+
+    if (out->magic != FRAME_MAGIC) {
+        fprintf(stderr, "Bad frame magic 0x%04x (peer not running --framed?)\n", out->magic);
+        return -1;
+    }
+    // Empty frames are refused too: every request carries at least one byte
+    if (out->length == 0 || out->length > max_length ||
+        out->num_fields == 0 || out->num_fields > NUM_FIELDS) {
+        fprintf(stderr, "Frame rejected: %u bytes in %u fields (limit 1..%zu bytes, %d fields)\n",
+                out->length, out->num_fields, max_length, NUM_FIELDS);
+        return -1;
+    }
+    return 0;
+}
+
+// Header send: a plain copy with MSG_MORE so TCP can merge it with the
+// payload that follows. The payload itself keeps the variant's own path
+// (sendfile, MSG_ZEROCOPY, ...), none of which can send a stack buffer.
+ssize_t frame_header_send_some(int sockfd, struct iovec *iov, int iovcnt) {
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iovcnt };
+    return sendmsg(sockfd, &msg, MSG_MORE);
+}
+
+
+/************************************************/
+
+//SIZE DISTRIBUTIONS (CLIENT)
+
+static int parse_size(const char *s, char **end, size_t max_field, size_t *out) {
+    errno = 0;
+    unsigned long v = strtoul(s, end, 10);
+    if (errno || *end == s || v == 0 || v > max_field) {
+        fprintf(stderr, "Field size must be between 1 and %zu (got \"%s\")\n", max_field, s);
+        return -1;
+    }
+    *out = v;
+    return 0;
+}
+
+static int load_replay_file(const char *path, size_t max_field, struct size_dist *d) {
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror("Cannot open size replay file");
+        return -1;
+    }
+    size_t cap = 64;
+    d->replay = malloc(cap * sizeof(*d->replay));
+    char line[64];
+    while (d->replay && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        char *end;
+        size_t v;
+        if (parse_size(line, &end, max_field, &v) < 0) {
+            fclose(f);
+            return -1;
+        }
+        if (d->replay_len == cap) {
+            cap *= 2;
+            size_t *grown = realloc(d->replay, cap * sizeof(*d->replay));
+            if (!grown) break;
+            d->replay = grown;
+        }
+        d->replay[d->replay_len++] = v;
+    }
+    fclose(f);
+    if (!d->replay || d->replay_len == 0) {
+        fprintf(stderr, "Size replay file %s has no sizes\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int parse_size_dist(const char *spec, size_t max_field, struct size_dist *d) {
+
+    memset(d, 0, sizeof(*d));
+    char *end;
+
+    if (strncmp(spec, "fixed:", 6) == 0) {
+        d->kind = SIZE_FIXED;
+        if (parse_size(spec + 6, &end, max_field, &d->a) < 0 || *end) goto bad;
+    } else if (strncmp(spec, "uniform:", 8) == 0) {
+        d->kind = SIZE_UNIFORM;
+        if (parse_size(spec + 8, &end, max_field, &d->a) < 0 || *end != ':') goto bad;
+        if (parse_size(end + 1, &end, max_field, &d->b) < 0 || *end || d->b < d->a) goto bad;
+    } else if (strncmp(spec, "bimodal:", 8) == 0) {
+        d->kind = SIZE_BIMODAL;
+        if (parse_size(spec + 8, &end, max_field, &d->a) < 0 || *end != ':') goto bad;
+        if (parse_size(end + 1, &end, max_field, &d->b) < 0 || *end != ':') goto bad;
+        d->pct_a = strtol(end + 1, &end, 10);
+        if (*end || d->pct_a < 0 || d->pct_a > 100) goto bad;
+    } else if (strncmp(spec, "file:", 5) == 0) {
+        d->kind = SIZE_REPLAY;
+        if (load_replay_file(spec + 5, max_field, d) < 0) return -1;
+    } else {
+        goto bad;
+    }
+    return 0;
+
+bad:
+    fprintf(stderr, "Bad size distribution \"%s\" (fixed:N, uniform:MIN:MAX, "
+                    "bimodal:SMALL:LARGE:PCT_SMALL or file:PATH)\n", spec);
+    return -1;
+}
+
+// xorshift64*: cheap, per-connection state, good enough for picking sizes
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+size_t size_dist_next(const struct size_dist *d, uint64_t *rng, uint64_t k) {
+    switch (d->kind) {
+    case SIZE_UNIFORM:
+        return d->a + next_random(rng) % (d->b - d->a + 1);
+    case SIZE_BIMODAL:
+        return (int)(next_random(rng) % 100) < d->pct_a ? d->a : d->b;
+    case SIZE_REPLAY:
+        return d->replay[k % d->replay_len];
+    default:
+        return d->a;
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Histogram.c
+ * Log-linear latency histogram: merge, percentiles, CSV dump
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "MT25074_Part_A_Histogram.h"
+
+void hist_init(struct latency_hist *h) {
+    memset(h, 0, sizeof(*h));
+    h->min_ns = UINT64_MAX;
+}
+
+void hist_merge(struct latency_hist *dst, const struct latency_hist *src) {
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    dst->sum_ns += src->sum_ns;
+    if (src->min_ns < dst->min_ns) dst->min_ns = src->min_ns;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+}
+
+// Inverse of hist_bucket(): the largest value that maps to bucket idx
+static uint64_t bucket_high(unsigned idx) {
+    if (idx < HIST_SUB_COUNT) return idx;
+    unsigned shift = idx / HIST_SUB_COUNT - 1;
+    uint64_t sub = idx % HIST_SUB_COUNT + HIST_SUB_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+uint64_t hist_percentile(const struct latency_hist *h, double p) {
+    if (h->total == 0) return 0;
+
+    // Rank of the sample we want, 1-based, rounded up
+    uint64_t rank = (uint64_t)(p / 100.0 * h->total + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > h->total) rank = h->total;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            // Never report beyond what was actually observed
+            uint64_t v = bucket_high(i);
+            return v > h->max_ns ? h->max_ns : v;
+        }
+    }
+    return h->max_ns;
+}
+
+void hist_print_summary(const struct latency_hist *h) {
+    if (h->total == 0) {
+        printf("Latency: no samples\n");
+        return;
+    }
+    printf("Latency (us): min=%.1f mean=%.1f p50=%.1f p99=%.1f p99.9=%.1f max=%.1f (n=%lu)\n",
+           h->min_ns / 1e3, h->sum_ns / h->total / 1e3,
+           hist_percentile(h, 50.0) / 1e3, hist_percentile(h, 99.0) / 1e3,
+           hist_percentile(h, 99.9) / 1e3, h->max_ns / 1e3, h->total);
+}
+
+int hist_write_csv(const struct latency_hist *h, const char *path, const char *label) {
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("Failed to open latency CSV");
+        return -1;
+    }
+
+    fprintf(f, "label,count,min_ns,mean_ns,p50_ns,p90_ns,p99_ns,p99_9_ns,p99_99_ns,max_ns\n");
+    fprintf(f, "%s,%lu,%lu,%.0f,%lu,%lu,%lu,%lu,%lu,%lu\n",
+            label, h->total,
+            h->total ? h->min_ns : 0,
+            h->total ? h->sum_ns / h->total : 0.0,
+            hist_percentile(h, 50.0), hist_percentile(h, 90.0),
+            hist_percentile(h, 99.0), hist_percentile(h, 99.9),
+            hist_percentile(h, 99.99), h->max_ns);
+
+    if (fclose(f) != 0) {
+        perror("Failed to write latency CSV");
+        return -1;
+    }
+    return 0;
+}
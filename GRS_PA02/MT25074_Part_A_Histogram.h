@@ -0,0 +1,69 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Histogram.h
+ * Log-linear latency histogram (HdrHistogram-style) for the clients
+ */
+
+#ifndef MT25074_PART_A_HISTOGRAM_H
+#define MT25074_PART_A_HISTOGRAM_H
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Values (nanoseconds) below 2^HIST_SUB_BITS get one exact bucket each. Above
+ * that, every power of two [2^m, 2^(m+1)) is split into 2^HIST_SUB_BITS equal
+ * sub-buckets, so the bucket width is always under 1/32 (~3%) of the value.
+ * Everything lives in a fixed array: recording is an index computation plus
+ * an increment, with no allocation on the hot path.
+ */
+#define HIST_SUB_BITS 5
+#define HIST_SUB_COUNT (1u << HIST_SUB_BITS)
+#define HIST_MAX_MAGNITUDE 40   // 2^40 ns ~ 18 minutes; larger values clamp to the last bucket
+#define HIST_BUCKETS ((HIST_MAX_MAGNITUDE - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+struct latency_hist {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    double sum_ns;            // for the mean only
+};
+
+static inline uint64_t hist_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline unsigned hist_bucket(uint64_t v) {
+    if (v < HIST_SUB_COUNT) return (unsigned)v;
+    unsigned m = 63 - __builtin_clzll(v);            // v in [2^m, 2^(m+1))
+    if (m >= HIST_MAX_MAGNITUDE) return HIST_BUCKETS - 1;
+    unsigned shift = m - HIST_SUB_BITS;
+    unsigned sub = (unsigned)(v >> shift) - HIST_SUB_COUNT;   // 0 .. HIST_SUB_COUNT-1
+    return (shift + 1) * HIST_SUB_COUNT + sub;
+}
+
+static inline void hist_record(struct latency_hist *h, uint64_t ns) {
+    h->counts[hist_bucket(ns)]++;
+    h->total++;
+    h->sum_ns += (double)ns;
+    if (ns < h->min_ns) h->min_ns = ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+void hist_init(struct latency_hist *h);
+void hist_merge(struct latency_hist *dst, const struct latency_hist *src);
+
+// Highest value that falls in the bucket holding the p-th percentile (0 < p <= 100)
+uint64_t hist_percentile(const struct latency_hist *h, double p);
+
+// One-line "latency: p50=... p99=... p99.9=..." summary on stdout
+void hist_print_summary(const struct latency_hist *h);
+
+// Writes a header plus one row: label,count,min,mean,p50,p90,p99,p99.9,p99.99,max (ns).
+// Returns 0 or -1.
+int hist_write_csv(const struct latency_hist *h, const char *path, const char *label);
+
+#endif
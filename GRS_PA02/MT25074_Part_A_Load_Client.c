@@ -0,0 +1,426 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Load_Client.c
+ * Load generator: C connections driven by T pinned worker threads from one process
+ *
+ * Replaces "one client process per connection" for the A1/A2/A3 servers (their
+ * clients are identical: writev request, readv response). All connections are
+ * opened first, then a barrier releases every worker at the same instant, so
+ * the run does not include the start-up skew of launching many processes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <time.h>
+#include "MT25074_Part_A_Common.h"
+#include "MT25074_Part_A_Histogram.h"
+
+#define LOAD_POLL_MS 100
+
+struct load_config {
+    size_t field_size;
+    int num_conns;
+    int num_workers;
+    int duration;       // measured seconds
+    int warmup;         // unmeasured seconds before that
+    int depth;
+    int *cpus;          // worker i is pinned to cpus[i % num_cpus]
+    int num_cpus;       // 0 = no pinning
+    const char *latency_csv;
+    int zc_recv;        // receive with TCP_ZEROCOPY_RECEIVE
+    int framed;         // length-prefixed messages drawn from sizes
+    struct size_dist sizes;
+    struct buffer_policy buffers;   // --pages / --numa-local
+};
+
+struct load_conn {
+    struct pipeline_conn pc;
+    struct zc_recv zr;  // used only with --zc-recv
+    int id;
+};
+
+struct load_worker {
+    pthread_t thread;
+    int id;
+    int cpu;                       // -1 = not pinned
+    struct load_conn *conns;       // this worker's slice of all connections
+    int num_conns;
+    const struct load_config *cfg;
+    pthread_barrier_t *start;
+    const struct run_deadline *dl; // started by main just before the barrier opens
+    int failed;
+    struct latency_hist hist;      // this worker's round trips; merged by main at exit
+    uint64_t perf[PERF_NUM_EVENTS];   // this worker's counters over RUN_MEASURE; summed by main
+};
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--connections C] [--threads T] [--duration S] [--warmup S] [--depth N]\n"
+                    "          [--cpus LIST | --no-pin] [--zc-recv] [--framed] [--sizes SPEC]\n"
+                    "          [--pages default|thp|hugetlb] [--numa-local] [--latency-csv FILE] <field_size>\n", prog);
+    fprintf(stderr, "  --connections C  sockets to open (default 1)\n");
+    fprintf(stderr, "  --threads T      worker threads, connections split evenly (default min(C, cores))\n");
+    fprintf(stderr, "  --duration S     measured seconds (default %d)\n", DEFAULT_DURATION_SECONDS);
+    fprintf(stderr, "  --warmup S       unmeasured seconds before that (default %d)\n", DEFAULT_WARMUP_SECONDS);
+    fprintf(stderr, "  --depth N        requests in flight per connection (default 1)\n");
+    fprintf(stderr, "  --cpus LIST      comma separated cores, worker i -> LIST[i %% len]\n");
+    fprintf(stderr, "                   (default: every online core in turn)\n");
+    fprintf(stderr, "  --no-pin         leave worker placement to the scheduler\n");
+    fprintf(stderr, "  --zc-recv        receive with TCP_ZEROCOPY_RECEIVE (mmap), copy the rest\n");
+    fprintf(stderr, "  --framed         length-prefixed messages (server needs --framed too)\n");
+    fprintf(stderr, "  --sizes SPEC     per-field sizes, implies --framed: fixed:N, uniform:MIN:MAX,\n"
+                    "                   bimodal:SMALL:LARGE:PCT_SMALL or file:PATH (max field_size)\n");
+    fprintf(stderr, "  --pages P        message buffers on default (4 KB), thp or hugetlb pages\n");
+    fprintf(stderr, "  --numa-local     bind each worker's message buffers to its NUMA node\n");
+    fprintf(stderr, "  --latency-csv F  write merged round-trip latency percentiles to F\n");
+}
+
+static int parse_load_args(int argc, char *argv[], struct load_config *cfg) {
+
+    static const struct option long_opts[] = {
+        {"connections", required_argument, NULL, 'c'},
+        {"threads",     required_argument, NULL, 't'},
+        {"duration",    required_argument, NULL, 'd'},
+        {"warmup",      required_argument, NULL, 'w'},
+        {"depth",       required_argument, NULL, 'q'},
+        {"cpus",        required_argument, NULL, 'p'},
+        {"no-pin",      no_argument,       NULL, 'n'},
+        {"latency-csv", required_argument, NULL, 'l'},
+        {"zc-recv",     no_argument,       NULL, 'r'},
+        {"framed",      no_argument,       NULL, 'f'},
+        {"sizes",       required_argument, NULL, 'S'},
+        {"pages",       required_argument, NULL, 'H'},
+        {"numa-local",  no_argument,       NULL, 'N'},
+        {NULL, 0, NULL, 0}
+    };
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_conns = 1;
+    cfg->duration = DEFAULT_DURATION_SECONDS;
+    cfg->warmup = DEFAULT_WARMUP_SECONDS;
+    cfg->depth = 1;
+    int no_pin = 0;
+    const char *sizes = NULL;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:t:d:w:q:p:nl:rfS:H:N", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'c': cfg->num_conns = atoi(optarg); break;
+        case 't': cfg->num_workers = atoi(optarg); break;
+        case 'd': cfg->duration = atoi(optarg); break;
+        case 'w': cfg->warmup = atoi(optarg); break;
+        case 'q': cfg->depth = atoi(optarg); break;
+        case 'p':
+            free(cfg->cpus);
+            cfg->num_cpus = parse_cpu_list(optarg, &cfg->cpus);
+            if (cfg->num_cpus < 0) {
+                fprintf(stderr, "Bad --cpus list: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'n': no_pin = 1; break;
+        case 'l': cfg->latency_csv = optarg; break;
+        case 'r': cfg->zc_recv = 1; break;
+        case 'f': cfg->framed = 1; break;
+        case 'S': sizes = optarg; cfg->framed = 1; break;
+        case 'H':
+            cfg->buffers.pages = parse_buffer_pages(optarg);
+            if (cfg->buffers.pages < 0) return -1;
+            break;
+        case 'N': cfg->buffers.numa_local = 1; break;
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    cfg->field_size = atoi(argv[optind]);
+
+    if (cfg->field_size == 0 || cfg->num_conns < 1 || cfg->num_workers < 0 ||
+        cfg->duration < 1 || cfg->warmup < 0 || cfg->depth < 1 || cfg->depth > PIPELINE_MAX_DEPTH) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    if (cfg->framed) {
+        char fixed[32];
+        snprintf(fixed, sizeof(fixed), "fixed:%zu", cfg->field_size);
+        if (parse_size_dist(sizes ? sizes : fixed, cfg->field_size, &cfg->sizes) < 0) return -1;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) online = 1;
+    if (cfg->num_workers == 0) cfg->num_workers = (int)online;
+    if (cfg->num_workers > cfg->num_conns) cfg->num_workers = cfg->num_conns;
+
+    if (no_pin) {
+        free(cfg->cpus);
+        cfg->cpus = NULL;
+        cfg->num_cpus = 0;
+    } else if (cfg->num_cpus == 0) {
+        cfg->cpus = malloc(online * sizeof(int));
+        if (!cfg->cpus) return -1;
+        for (int i = 0; i < online; i++) cfg->cpus[i] = i;
+        cfg->num_cpus = (int)online;
+    }
+    buffer_policy_set(&cfg->buffers);
+    return 0;
+}
+
+// Blocking connect, then switch to non-blocking for the pipeline engine
+static int open_connection(void) {
+
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(SERVER_PORT);
+    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+        perror("Inet_pton function failed");
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Socket creation failed");
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("Connect function failed at client side");
+        close(fd);
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl O_NONBLOCK failed");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void* load_worker_thread(void *arg) {
+
+    struct load_worker *w = (struct load_worker*)arg;
+    const struct load_config *cfg = w->cfg;
+    int n = w->num_conns;
+
+    // Each worker owns its messages: no sharing of buffers between cores
+    struct message *send_msg = create_message(cfg->field_size, 'C');
+    struct message *recv_msg = create_message(cfg->field_size, 'C');
+    struct pollfd *pfds = calloc(n, sizeof(*pfds));
+    if (!send_msg || !recv_msg || !pfds) {
+        perror("Failed to allocate worker buffers");
+        w->failed = 1;
+    }
+
+    // Opened by the worker itself: the counters follow the calling thread
+    struct perf_counters perf;
+    perf_counters_open(&perf);
+
+    pthread_barrier_wait(w->start);
+
+    int live = w->failed ? 0 : n;   // connections not yet drained or failed
+
+    while (live > 0) {
+        int phase = run_phase(w->dl);
+        int stopping = (phase == RUN_STOP);
+        perf_counters_track(&perf, phase == RUN_MEASURE);
+
+        int progressed = 0;
+        int npoll = 0;
+        live = 0;
+        for (int i = 0; i < n; i++) {
+            struct pipeline_conn *pc = &w->conns[i].pc;
+            if (pc->fd < 0) continue;
+
+            int sent = pipeline_send_step(pc, send_msg, stopping);
+            int received = pipeline_recv_step(pc, recv_msg, phase == RUN_MEASURE);
+            if (sent < 0 || received < 0) {
+                close(pc->fd);
+                pc->fd = -1;
+                w->failed = 1;
+                continue;
+            }
+            if (sent || received) progressed = 1;
+
+            short events = pipeline_poll_events(pc, stopping);
+            if (events == 0) continue;      // drained after the deadline
+            live++;
+            pfds[npoll].fd = pc->fd;
+            pfds[npoll].events = events;
+            npoll++;
+        }
+
+        if (live > 0 && !progressed) {
+            if (poll(pfds, npoll, LOAD_POLL_MS) < 0 && errno != EINTR) {
+                perror("poll failed");
+                break;
+            }
+        }
+    }
+
+    perf_counters_track(&perf, 0);
+    perf_counters_read(&perf, w->perf);
+    perf_counters_close(&perf);
+
+    free(pfds);
+    free_message(send_msg);
+    free_message(recv_msg);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+
+    struct load_config cfg;
+    if (parse_load_args(argc, argv, &cfg) < 0) {
+        exit(1);
+    }
+
+    printf("Load client: Server=%s:%d, field_size=%zu, connections=%d, threads=%d, depth=%d, warmup=%ds, duration=%ds%s\n",
+           SERVER_IP, SERVER_PORT, cfg.field_size, cfg.num_conns, cfg.num_workers, cfg.depth,
+           cfg.warmup, cfg.duration, cfg.framed ? ", framed" : "");
+
+    struct load_conn *conns = calloc(cfg.num_conns, sizeof(*conns));
+    struct load_worker *workers = calloc(cfg.num_workers, sizeof(*workers));
+    if (!conns || !workers) {
+        perror("Failed to allocate load client state");
+        exit(1);
+    }
+
+    /************************************************/
+
+    //STEP 1: OPEN EVERY CONNECTION BEFORE ANY TRAFFIC STARTS
+
+    for (int i = 0; i < cfg.num_conns; i++) {
+        int fd = open_connection();
+        if (fd < 0) {
+            fprintf(stderr, "Connection %d failed, aborting\n", i);
+            exit(EXIT_FAILURE);
+        }
+        pipeline_conn_init(&conns[i].pc, fd, cfg.depth, NULL);
+        if (cfg.zc_recv) {
+            zc_recv_init(&conns[i].zr, fd, NUM_FIELDS * cfg.field_size);
+            conns[i].pc.zc = &conns[i].zr;
+        }
+        if (cfg.framed) conns[i].pc.sizes = &cfg.sizes;
+        conns[i].id = i;
+    }
+    printf("All %d connections established\n", cfg.num_conns);
+
+
+    /************************************************/
+
+    //STEP 2: SPLIT CONNECTIONS ACROSS PINNED WORKERS
+
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, cfg.num_workers + 1);
+    struct run_deadline dl;
+
+    int base = cfg.num_conns / cfg.num_workers;
+    int extra = cfg.num_conns % cfg.num_workers;
+    int next = 0;
+    for (int i = 0; i < cfg.num_workers; i++) {
+        struct load_worker *w = &workers[i];
+        w->id = i;
+        w->cfg = &cfg;
+        w->start = &start;
+        w->dl = &dl;
+        w->conns = &conns[next];
+        w->num_conns = base + (i < extra ? 1 : 0);
+        w->cpu = cfg.num_cpus > 0 ? cfg.cpus[i % cfg.num_cpus] : -1;
+        next += w->num_conns;
+        // Per-worker histogram: no sharing (or atomics) between workers while recording
+        hist_init(&w->hist);
+        for (int c = 0; c < w->num_conns; c++) w->conns[c].pc.hist = &w->hist;
+
+        int rc = pinned_thread_create(&w->thread, &w->cpu, load_worker_thread, w);
+        if (rc != 0) {
+            fprintf(stderr, "Failed to create worker %d: %s\n", i, strerror(rc));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+
+    /************************************************/
+
+    //STEP 3: START EVERY WORKER AT ONCE AND WAIT FOR THE DRAIN
+
+    printf("Starting transfer: %ds warm-up + %d measured seconds...\n", cfg.warmup, cfg.duration);
+    if (run_deadline_start(&dl, cfg.warmup, cfg.duration) < 0) {
+        exit(EXIT_FAILURE);
+    }
+    pthread_barrier_wait(&start);
+
+    int failed = 0;
+    for (int i = 0; i < cfg.num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+        failed |= workers[i].failed;
+    }
+    double secs = run_deadline_finish(&dl);
+    pthread_barrier_destroy(&start);
+
+
+    /************************************************/
+
+    //STEP 4: REPORT PER-CONNECTION AND AGGREGATE THROUGHPUT
+
+    uint64_t total_msgs = 0;       // every round trip (matches the server's counts)
+    uint64_t measured_msgs = 0;    // warm-up excluded; throughput is based on these
+    uint64_t measured_bytes = 0;   // their payload both ways (sizes vary when framed)
+    uint64_t zc_bytes = 0, copied_bytes = 0;
+    uint64_t perf[PERF_NUM_EVENTS] = {0};
+    static struct latency_hist merged;
+    hist_init(&merged);
+    for (int w = 0; w < cfg.num_workers; w++) {
+        hist_merge(&merged, &workers[w].hist);
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) perf[e] += workers[w].perf[e];
+        for (int i = 0; i < workers[w].num_conns; i++) {
+            struct load_conn *c = &workers[w].conns[i];
+            double mbps = secs > 0 ? (c->pc.measured_bytes * 8.0) / (secs * 1000000.0) : 0.0;
+            printf("Conn %d (worker %d, cpu %d): messages=%lu measured=%lu throughput=%.2f Mbps\n",
+                   c->id, w, workers[w].cpu, c->pc.completed, c->pc.measured, mbps);
+            total_msgs += c->pc.completed;
+            measured_msgs += c->pc.measured;
+            measured_bytes += c->pc.measured_bytes;
+            if (cfg.zc_recv) {
+                zc_bytes += c->zr.zc_bytes;
+                copied_bytes += c->zr.copied_bytes;
+                zc_recv_free(&c->zr);
+            }
+            if (c->pc.fd >= 0) close(c->pc.fd);
+        }
+    }
+
+    printf("Time limit reached (%d seconds, %.6f s measured)\n", cfg.duration, secs);
+    printf("Messages exchanged: %lu\n", total_msgs);
+    printf("Messages measured: %lu (warm-up excluded)\n", measured_msgs);
+    if (secs > 0) {
+        printf("Aggregate throughput: %.2f Mbps (%.0f msgs/s)\n",
+               (measured_bytes * 8.0) / (secs * 1000000.0), measured_msgs / secs);
+    }
+    hist_print_summary(&merged);
+    char perf_line[256];
+    perf_format_line("client", "load", perf, measured_msgs, perf_line, sizeof(perf_line));
+    fputs(perf_line, stdout);
+    if (cfg.zc_recv) zc_recv_report(zc_bytes, copied_bytes);
+    if (cfg.latency_csv) hist_write_csv(&merged, cfg.latency_csv, "load");
+
+    free(conns);
+    free(workers);
+    free(cfg.cpus);
+    printf("Client shutting down...\n");
+    return failed ? EXIT_FAILURE : 0;
+}
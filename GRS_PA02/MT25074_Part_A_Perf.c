@@ -0,0 +1,157 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Perf.c
+ * In-process hardware counters: perf_event_open() per worker thread
+ *
+ * Wrapping the whole server in an external perf stat also counted start-up,
+ * the accept wait and teardown, and tied the scripts to one perf binary.
+ * Here every worker thread opens its own counters (pid = 0, cpu = -1: this
+ * thread on whatever CPU it runs), starts them disabled and switches them on
+ * only around steady-state transfer. Cycles, instructions and the two cache
+ * events form one group, so the kernel schedules them together and their
+ * ratios stay consistent; context switches are a software event in a group
+ * of their own, so they are still counted on machines (VMs) without a
+ * hardware PMU. Values are scaled by time_enabled / time_running when the
+ * kernel had to multiplex the PMU.
+ *
+ * Output (one line, after the matching STATS line):
+ *   PERF,<kind>,<label>,<cycles>,<instructions>,<ipc>,<cache_refs>,<cache_misses>,
+ *        <context_switches>,<cycles_per_msg>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "MT25074_Part_A_Common.h"
+
+static const struct {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+} perf_events[PERF_NUM_EVENTS] = {
+    [PERF_CYCLES]       = { "cycles",           PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_INSTRUCTIONS] = { "instructions",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_CACHE_REFS]   = { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+    [PERF_CACHE_MISSES] = { "cache-misses",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    [PERF_CTX_SWITCHES] = { "context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+};
+
+// Group leaders; every other event is a member of the hardware group
+static int perf_is_leader(int e) {
+    return e == PERF_CYCLES || e == PERF_CTX_SWITCHES;
+}
+
+static atomic_int perf_warned;     // one "not available" message per process
+static atomic_int perf_user_only;  // one "user space only" message per process
+
+static int perf_open_event(int e, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = perf_events[e].type;
+    attr.config = perf_events[e].config;
+    attr.disabled = perf_is_leader(e);     // members follow their leader
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+
+    // Kernel time is most of a network round trip, but perf_event_paranoid >= 2
+    // only lets unprivileged users count their own user space
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+        attr.exclude_kernel = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+        if (fd >= 0 && !atomic_exchange(&perf_user_only, 1)) {
+            fprintf(stderr, "perf_event_open: kernel not permitted, counting user space only\n");
+        }
+    }
+    return fd;
+}
+
+int perf_counters_open(struct perf_counters *pc) {
+
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) pc->fd[e] = -1;
+    pc->running = 0;
+
+    int opened = 0;
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        int leader = e == PERF_CTX_SWITCHES ? -1 : pc->fd[PERF_CYCLES];
+        if (!perf_is_leader(e) && leader < 0) continue;   // no hardware group
+        pc->fd[e] = perf_open_event(e, perf_is_leader(e) ? -1 : leader);
+        if (pc->fd[e] >= 0) {
+            opened++;
+        } else if (!atomic_exchange(&perf_warned, 1)) {
+            // A failed leader takes its whole group with it
+            fprintf(stderr, "perf_event_open(%s) failed: %s; %s counted as 0\n",
+                    perf_events[e].name, strerror(errno),
+                    e == PERF_CYCLES ? "all hardware events" : "it is");
+        }
+    }
+    return opened;
+}
+
+static void perf_ioctl_leaders(struct perf_counters *pc, unsigned long req) {
+    if (pc->fd[PERF_CYCLES] >= 0) ioctl(pc->fd[PERF_CYCLES], req, PERF_IOC_FLAG_GROUP);
+    if (pc->fd[PERF_CTX_SWITCHES] >= 0) ioctl(pc->fd[PERF_CTX_SWITCHES], req, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counters_enable(struct perf_counters *pc) {
+    perf_ioctl_leaders(pc, PERF_EVENT_IOC_ENABLE);
+    pc->running = 1;
+}
+
+void perf_counters_disable(struct perf_counters *pc) {
+    perf_ioctl_leaders(pc, PERF_EVENT_IOC_DISABLE);
+    pc->running = 0;
+}
+
+void perf_counters_reset(struct perf_counters *pc) {
+    perf_ioctl_leaders(pc, PERF_EVENT_IOC_RESET);
+}
+
+// Reads one group into out[first..], scaled for multiplexing
+static void perf_read_group(int fd, uint64_t *out) {
+    struct {
+        uint64_t nr;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[PERF_NUM_EVENTS];
+    } data;
+    if (fd < 0 || read(fd, &data, sizeof(data)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+
+    double scale = 1.0;
+    if (data.time_running > 0 && data.time_running < data.time_enabled) {
+        scale = (double)data.time_enabled / data.time_running;
+    }
+    for (uint64_t i = 0; i < data.nr && i < PERF_NUM_EVENTS; i++) {
+        out[i] += (uint64_t)(data.values[i] * scale);
+    }
+}
+
+void perf_counters_read(const struct perf_counters *pc, uint64_t out[PERF_NUM_EVENTS]) {
+    // The hardware group reads back in creation order: cycles, instructions, refs, misses
+    perf_read_group(pc->fd[PERF_CYCLES], &out[PERF_CYCLES]);
+    perf_read_group(pc->fd[PERF_CTX_SWITCHES], &out[PERF_CTX_SWITCHES]);
+}
+
+void perf_counters_close(struct perf_counters *pc) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (pc->fd[e] >= 0) close(pc->fd[e]);
+        pc->fd[e] = -1;
+    }
+    pc->running = 0;
+}
+
+void perf_format_line(const char *kind, const char *label, const uint64_t v[PERF_NUM_EVENTS],
+                      uint64_t messages, char *buf, size_t len) {
+    snprintf(buf, len, "PERF,%s,%s,%lu,%lu,%.4f,%lu,%lu,%lu,%.1f\n",
+             kind, label, v[PERF_CYCLES], v[PERF_INSTRUCTIONS],
+             v[PERF_CYCLES] ? (double)v[PERF_INSTRUCTIONS] / v[PERF_CYCLES] : 0.0,
+             v[PERF_CACHE_REFS], v[PERF_CACHE_MISSES], v[PERF_CTX_SWITCHES],
+             messages ? (double)v[PERF_CYCLES] / messages : 0.0);
+}
@@ -0,0 +1,190 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Pipeline.c
+ * Client side request pipelining: N requests in flight per connection
+ *
+ * Stop-and-wait caps a connection at one message per round trip. Here the
+ * socket is non-blocking and two independent paths share one thread:
+ *   - send path: writes requests while fewer than 'depth' are unanswered
+ *   - receive path: reads responses; TCP keeps them in request order, so
+ *     response k always answers request k
+ * Because the receive path never stops draining, neither side can end up
+ * blocked in send() waiting for a peer that is itself blocked in send().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include "MT25074_Part_A_Common.h"
+#include "MT25074_Part_A_Histogram.h"
+
+#define PIPELINE_POLL_MS 100   // idle wait; also bounds how late RUN_STOP is noticed
+
+void pipeline_conn_init(struct pipeline_conn *pc, int fd, int depth, struct latency_hist *hist) {
+    memset(pc, 0, sizeof(*pc));
+    pc->fd = fd;
+    pc->depth = depth;
+    pc->hist = hist;
+    pc->rng = 0x9E3779B97F4A7C15ull ^ ((uint64_t)fd << 32) ^ hist_now_ns();
+}
+
+// Room to start another request (a half-written one is always finished)
+static int pipeline_wants_send(const struct pipeline_conn *pc, int stopping) {
+    return pc->send_off > 0 || (!stopping && pc->issued - pc->completed < (uint64_t)pc->depth);
+}
+
+// iovecs for bytes [off, ...) of a message on the wire: the optional frame
+// header followed by the first len payload bytes of msg
+static int wire_iov(const struct message *msg, const struct frame_hdr *hdr, size_t len,
+                    size_t off, struct iovec iov[NUM_FIELDS + 1]) {
+    if (!hdr) return message_iov_range(msg, off, len, iov);
+    if (off >= sizeof(*hdr)) return message_iov_range(msg, off - sizeof(*hdr), len, iov);
+    iov[0].iov_base = (char*)hdr + off;
+    iov[0].iov_len = sizeof(*hdr) - off;
+    return 1 + message_iov_range(msg, 0, len, iov + 1);
+}
+
+// SEND PATH: finish a partial request, then fill the window
+int pipeline_send_step(struct pipeline_conn *pc, const struct message *msg, int stopping) {
+
+    const struct frame_hdr *hdr = pc->sizes ? &pc->send_hdr : NULL;
+    struct iovec iov[NUM_FIELDS + 1];
+    int progressed = 0;
+
+    while (pipeline_wants_send(pc, stopping)) {
+        if (pc->send_off == 0) {
+            // The window never exceeds PIPELINE_MAX_DEPTH, so this slot is free
+            if (pc->hist) pc->sent_ns[pc->issued % PIPELINE_MAX_DEPTH] = hist_now_ns();
+            pc->send_len = NUM_FIELDS * (pc->sizes ? size_dist_next(pc->sizes, &pc->rng, pc->issued)
+                                                   : msg->field_size);
+            if (hdr) frame_encode(&pc->send_hdr, pc->send_len, NUM_FIELDS, pc->issued);
+        }
+        int cnt = wire_iov(msg, hdr, pc->send_len, pc->send_off, iov);
+        ssize_t n = writev(pc->fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            perror("Send failed");
+            return -1;
+        }
+        progressed = 1;
+        pc->send_off += n;
+        if (pc->send_off == (hdr ? sizeof(*hdr) : 0) + pc->send_len) {
+            pc->send_off = 0;
+            pc->issued++;
+        }
+    }
+    return progressed;
+}
+
+// One read attempt for the response in progress; framed responses read the
+// header on its own so no bytes of the next response are consumed
+static ssize_t recv_some(struct pipeline_conn *pc, struct message *msg) {
+
+    size_t hdr_len = pc->sizes ? sizeof(pc->recv_hdr) : 0;
+    if (pc->recv_off < hdr_len) {
+        return read(pc->fd, (char*)&pc->recv_hdr + pc->recv_off, hdr_len - pc->recv_off);
+    }
+    size_t off = pc->recv_off - hdr_len;
+    if (pc->zc) return zc_recv_some(pc->zc, pc->fd, msg, off, pc->recv_len);
+
+    struct iovec iov[NUM_FIELDS];
+    int cnt = message_iov_range(msg, off, pc->recv_len, iov);
+    return readv(pc->fd, iov, cnt);
+}
+
+// RECEIVE PATH: read whatever responses have arrived
+int pipeline_recv_step(struct pipeline_conn *pc, struct message *msg, int measuring) {
+
+    size_t hdr_len = pc->sizes ? sizeof(pc->recv_hdr) : 0;
+    int progressed = 0;
+
+    while (pc->completed < pc->issued) {
+        if (pc->recv_off == 0) pc->recv_len = NUM_FIELDS * msg->field_size;  // unframed: always full
+
+        ssize_t n = recv_some(pc, msg);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            perror("Receive failed");
+            return -1;
+        }
+        if (n == 0 && pc->recv_off < hdr_len + pc->recv_len) {
+            printf("Server closed connection unexpectedly\n");
+            return -1;
+        }
+        progressed = 1;
+        pc->recv_off += n;
+
+        if (hdr_len && pc->recv_off == hdr_len && n > 0) {
+            struct frame_hdr h;
+            if (frame_decode(&pc->recv_hdr, &h, NUM_FIELDS * msg->field_size) < 0) return -1;
+            if (h.request_id != pc->completed) {
+                fprintf(stderr, "Response for request %lu arrived while expecting %lu\n",
+                        h.request_id, pc->completed);
+                return -1;
+            }
+            pc->recv_len = h.length;
+        }
+
+        if (pc->recv_off == hdr_len + pc->recv_len) {
+            if (measuring) {
+                pc->measured++;
+                pc->measured_bytes += 2 * pc->recv_len;   // responses echo the request size
+                if (pc->hist) {
+                    hist_record(pc->hist, hist_now_ns() - pc->sent_ns[pc->completed % PIPELINE_MAX_DEPTH]);
+                }
+            }
+            pc->recv_off = 0;
+            pc->completed++;
+        }
+    }
+    return progressed;
+}
+
+short pipeline_poll_events(const struct pipeline_conn *pc, int stopping) {
+    short events = 0;
+    if (pipeline_wants_send(pc, stopping)) events |= POLLOUT;
+    if (pc->completed < pc->issued) events |= POLLIN;
+    return events;
+}
+
+int64_t run_pipelined_exchange(struct pipeline_conn *pc, struct message *send_msg,
+                               struct message *recv_msg, const struct run_deadline *dl) {
+
+    int flags = fcntl(pc->fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(pc->fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl O_NONBLOCK failed");
+        return -1;
+    }
+
+    while (1) {
+        int phase = run_phase(dl);
+        int stopping = (phase == RUN_STOP);
+        perf_counters_track(pc->perf, phase == RUN_MEASURE);
+        // Done once nothing is half-written and every issued request has its answer
+        short events = pipeline_poll_events(pc, stopping);
+        if (events == 0) break;
+
+        int sent = pipeline_send_step(pc, send_msg, stopping);
+        int received = pipeline_recv_step(pc, recv_msg, phase == RUN_MEASURE);
+        if (sent < 0 || received < 0) return -1;
+
+        if (!sent && !received) {
+            struct pollfd pfd = { .fd = pc->fd, .events = pipeline_poll_events(pc, stopping) };
+            if (poll(&pfd, 1, PIPELINE_POLL_MS) < 0 && errno != EINTR) {
+                perror("poll failed");
+                return -1;
+            }
+        }
+    }
+
+    perf_counters_track(pc->perf, 0);
+    fcntl(pc->fd, F_SETFL, flags);
+    return (int64_t)pc->completed;
+}
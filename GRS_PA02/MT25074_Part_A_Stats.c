@@ -0,0 +1,276 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Stats.c
+ * Server throughput / goodput counters and the periodic STATS reporter
+ *
+ * Output (one line each, comma separated, for the Part B script):
+ *   STATS,periodic,<t_s>,<goodput_gbps>,<msgs_per_s>,<syscalls_per_msg>
+ *   STATS,final,<label>,<elapsed_s>,<bytes>,<messages>,<syscalls>,
+ *               <goodput_gbps>,<tcp_gbps>,<msgs_per_s>,<syscalls_per_msg>
+ *   PERF,final,<label>,<cycles>,<instructions>,<ipc>,<cache_refs>,<cache_misses>,
+ *              <context_switches>,<cycles_per_msg>
+ * Goodput counts application payload that completed a round trip; tcp bytes
+ * come from TCP_INFO (bytes_sent + bytes_received), i.e. everything TCP
+ * carried for the connection including retransmissions. The PERF counters
+ * belong to the thread bound to each slot and only run between its first
+ * message and its connection close, so accept waits and teardown are not
+ * counted (see MT25074_Part_A_Perf.c).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>      // full struct tcp_info (glibc's copy lacks the byte counters)
+#include "MT25074_Part_A_Common.h"
+
+struct stats_totals {
+    uint64_t bytes;
+    uint64_t messages;
+    uint64_t syscalls;
+};
+
+static struct {
+    struct stats_slot *slots;
+    int num_slots;
+    int interval_ms;
+    uint64_t start_ns;
+    pthread_t reporter;
+    int reporter_running;
+    pthread_mutex_t lock;    // only guards 'stop' for the reporter's timed wait
+    pthread_cond_t cond;
+    int stop;
+    pthread_mutex_t perf_lock;   // bind swapping a slot's counters vs. a reader summing them
+} stats = { .perf_lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Whether slot s has counted since the last RESET; until then its counters
+// hold the previous run's values and read as zero
+static int stats_slot_live(struct stats_slot *s) {
+    // Acquire pairs with the owner's release in stats_slot_restart: a slot seen
+    // in the current epoch has its zeroed counters visible
+    return atomic_load_explicit(&s->epoch, memory_order_acquire) ==
+           atomic_load_explicit(&stats_epoch, memory_order_relaxed);
+}
+
+static void stats_sum(struct stats_totals *t) {
+    memset(t, 0, sizeof(*t));
+    for (int i = 0; i < stats.num_slots; i++) {
+        struct stats_slot *s = &stats.slots[i];
+        if (!stats_slot_live(s)) continue;
+        t->bytes += atomic_load_explicit(&s->bytes, memory_order_relaxed);
+        t->messages += atomic_load_explicit(&s->messages, memory_order_relaxed);
+        t->syscalls += atomic_load_explicit(&s->syscalls, memory_order_relaxed);
+    }
+}
+
+static void* stats_reporter(void *arg) {
+    (void)arg;
+    struct stats_totals prev, cur;
+    stats_sum(&prev);
+    uint64_t prev_ns = stats_now_ns();
+
+    pthread_mutex_lock(&stats.lock);
+    while (!stats.stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += stats.interval_ms / 1000;
+        deadline.tv_nsec += (stats.interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        int rc = 0;
+        while (!stats.stop && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&stats.cond, &stats.lock, &deadline);
+        }
+        if (stats.stop) break;
+
+        // Interval deltas; print without holding up the next interval on the lock
+        pthread_mutex_unlock(&stats.lock);
+        stats_sum(&cur);
+        // A RESET (--persistent) since the last line: count from zero
+        if (cur.messages < prev.messages || cur.bytes < prev.bytes) memset(&prev, 0, sizeof(prev));
+        uint64_t now = stats_now_ns();
+        double secs = (now - prev_ns) / 1e9;
+        uint64_t msgs = cur.messages - prev.messages;
+        printf("STATS,periodic,%.3f,%.4f,%.0f,%.2f\n",
+               (now - stats.start_ns) / 1e9,
+               (cur.bytes - prev.bytes) * 8.0 / (secs * 1e9),
+               msgs / secs,
+               msgs ? (double)(cur.syscalls - prev.syscalls) / msgs : 0.0);
+        fflush(stdout);
+        prev = cur;
+        prev_ns = now;
+        pthread_mutex_lock(&stats.lock);
+    }
+    pthread_mutex_unlock(&stats.lock);
+    return NULL;
+}
+
+int server_stats_init(int num_slots, int interval_ms) {
+
+    stats.slots = aligned_alloc(CACHE_LINE_SIZE, num_slots * sizeof(struct stats_slot));
+    if (!stats.slots) {
+        perror("Failed to allocate stats slots");
+        return -1;
+    }
+    memset(stats.slots, 0, num_slots * sizeof(struct stats_slot));
+    for (int i = 0; i < num_slots; i++) {
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) stats.slots[i].perf.fd[e] = -1;
+    }
+    stats.num_slots = num_slots;
+    stats.interval_ms = interval_ms;
+    stats.start_ns = stats_now_ns();
+    stats.stop = 0;
+
+    if (interval_ms > 0) {
+        pthread_condattr_t ca;
+        pthread_condattr_init(&ca);
+        pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+        pthread_cond_init(&stats.cond, &ca);
+        pthread_condattr_destroy(&ca);
+        pthread_mutex_init(&stats.lock, NULL);
+
+        if (pthread_create(&stats.reporter, NULL, stats_reporter, NULL) != 0) {
+            fprintf(stderr, "Stats reporter not started; only the final line will be printed\n");
+        } else {
+            stats.reporter_running = 1;
+        }
+    }
+    return 0;
+}
+
+void server_stats_bind(int i) {
+    stats_tls = (stats.slots && i >= 0 && i < stats.num_slots) ? &stats.slots[i] : NULL;
+    struct stats_slot *s = stats_tls;
+    if (!s) return;
+
+    // Counters follow a thread, not a slot: bank the previous owner's counts
+    // (thread mode reuses slots) and open a fresh set for this thread
+    pthread_mutex_lock(&stats.perf_lock);
+    perf_counters_read(&s->perf, s->perf_done);
+    perf_counters_close(&s->perf);
+    perf_counters_open(&s->perf);
+    pthread_mutex_unlock(&stats.perf_lock);
+}
+
+void server_stats_message(size_t bytes) {
+    struct stats_slot *s = stats_owned_slot();
+    if (!s) return;
+    if (s->first_ns == 0) s->first_ns = stats_now_ns();
+    if (!s->perf.running) perf_counters_enable(&s->perf);
+    stats_add(&s->bytes, bytes);
+    stats_add(&s->messages, 1);
+}
+
+void server_stats_conn_closed(int conn_fd) {
+    struct stats_slot *s = stats_owned_slot();
+    if (!s) return;
+    // Epoll loops switch back on with their next message on any connection
+    if (s->perf.running) perf_counters_disable(&s->perf);
+
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+    if (getsockopt(conn_fd, IPPROTO_TCP, TCP_INFO, &ti, &len) == 0 &&
+        len >= offsetof(struct tcp_info, tcpi_bytes_received) + sizeof(ti.tcpi_bytes_received)) {
+        s->tcp_bytes += ti.tcpi_bytes_sent + ti.tcpi_bytes_received;
+    }
+    s->last_ns = stats_now_ns();
+}
+
+// The STATS,final line for everything counted so far
+static void stats_format_final(const char *label, char *buf, size_t len) {
+
+    // Active window: first message on any slot to the last connection close
+    struct stats_totals t;
+    stats_sum(&t);
+    uint64_t first = 0, last = 0, tcp_bytes = 0;
+    for (int i = 0; i < stats.num_slots; i++) {
+        struct stats_slot *s = &stats.slots[i];
+        if (!stats_slot_live(s)) continue;
+        if (s->first_ns && (first == 0 || s->first_ns < first)) first = s->first_ns;
+        if (s->last_ns > last) last = s->last_ns;
+        tcp_bytes += s->tcp_bytes;
+    }
+    double secs = (first && last > first) ? (last - first) / 1e9 : 0.0;
+
+    snprintf(buf, len, "STATS,final,%s,%.6f,%lu,%lu,%lu,%.4f,%.4f,%.0f,%.2f\n",
+             label, secs, t.bytes, t.messages, t.syscalls,
+             secs > 0 ? t.bytes * 8.0 / (secs * 1e9) : 0.0,
+             secs > 0 ? tcp_bytes * 8.0 / (secs * 1e9) : 0.0,
+             secs > 0 ? t.messages / secs : 0.0,
+             t.messages ? (double)t.syscalls / t.messages : 0.0);
+}
+
+void server_stats_reset(void) {
+    // Owners may still be counting (idle epoll loops, a connection draining),
+    // and a store here would be lost under their next load+store. Retire the
+    // slots instead: readers skip them and each owner zeroes its own on its
+    // next count (stats_slot_restart).
+    atomic_fetch_add_explicit(&stats_epoch, 1, memory_order_relaxed);
+
+    // The perf counters live in the kernel and reset atomically; perf_done is
+    // only written under perf_lock
+    pthread_mutex_lock(&stats.perf_lock);
+    for (int i = 0; i < stats.num_slots; i++) {
+        struct stats_slot *s = &stats.slots[i];
+        perf_counters_reset(&s->perf);
+        memset(s->perf_done, 0, sizeof(s->perf_done));
+    }
+    pthread_mutex_unlock(&stats.perf_lock);
+    stats.start_ns = stats_now_ns();
+}
+
+// The PERF,final line: every slot's current and banked counts
+static void stats_format_perf(const char *label, char *buf, size_t len) {
+    uint64_t v[PERF_NUM_EVENTS] = {0};
+    pthread_mutex_lock(&stats.perf_lock);
+    for (int i = 0; i < stats.num_slots; i++) {
+        struct stats_slot *s = &stats.slots[i];
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) v[e] += s->perf_done[e];
+        perf_counters_read(&s->perf, v);
+    }
+    pthread_mutex_unlock(&stats.perf_lock);
+
+    struct stats_totals t;
+    stats_sum(&t);
+    perf_format_line("final", label, v, t.messages, buf, len);
+}
+
+void server_stats_dump(const char *label, char *buf, size_t len) {
+    stats_format_final(label, buf, len);
+    size_t used = strlen(buf);
+    stats_format_perf(label, buf + used, len - used);
+    fputs(buf, stdout);
+    fflush(stdout);
+}
+
+void server_stats_finish(const char *label) {
+
+    if (stats.reporter_running) {
+        pthread_mutex_lock(&stats.lock);
+        stats.stop = 1;
+        pthread_cond_signal(&stats.cond);
+        pthread_mutex_unlock(&stats.lock);
+        pthread_join(stats.reporter, NULL);
+        stats.reporter_running = 0;
+    }
+
+    char line[512];
+    server_stats_dump(label, line, sizeof(line));
+
+    for (int i = 0; i < stats.num_slots; i++) perf_counters_close(&stats.slots[i].perf);
+    free(stats.slots);
+    stats.slots = NULL;
+    stats.num_slots = 0;
+}
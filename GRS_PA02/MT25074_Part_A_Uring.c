@@ -0,0 +1,331 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Uring.c
+ * io_uring data path for the A4 client and server
+ *
+ * A message goes out as NUM_FIELDS linked SQEs (one per field) handed to the
+ * kernel with a single io_uring_enter(), and comes in through registered-buffer
+ * reads straight into the receive slab. The socket is a fixed file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "MT25074_Part_A_Uring.h"
+
+#define FIXED_FD 0          // index of the socket in the registered file table
+#define SEND_BUF_INDEX 0    // registered buffer indexes
+#define RECV_BUF_INDEX 1
+#define RECV_USER_DATA NUM_FIELDS   // user_data of the receive SQE (sends use 0..NUM_FIELDS-1)
+
+
+/************************************************/
+
+//RING SETUP (raw syscalls, mirrors what liburing does)
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static int uring_setup(struct uring *r, unsigned entries) {
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+
+    r->ring_fd = sys_io_uring_setup(entries, &p);
+    if (r->ring_fd < 0) return -1;
+
+    r->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        if (r->cq_size > r->sq_size) r->sq_size = r->cq_size;
+        r->cq_size = r->sq_size;
+    }
+
+    r->sq_ptr = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     r->ring_fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) goto fail;
+
+    if (single_mmap) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         r->ring_fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) goto fail;
+    }
+
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->ring_fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) goto fail;
+
+    char *sq = r->sq_ptr, *cq = r->cq_ptr;
+    r->sq_head = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    r->sq_local_tail = *r->sq_tail;
+    return 0;
+
+fail:
+    {
+        int saved = errno;
+        if (r->sq_ptr && r->sq_ptr != MAP_FAILED) munmap(r->sq_ptr, r->sq_size);
+        if (!single_mmap && r->cq_ptr && r->cq_ptr != MAP_FAILED) munmap(r->cq_ptr, r->cq_size);
+        close(r->ring_fd);
+        errno = saved;
+    }
+    return -1;
+}
+
+static void uring_teardown(struct uring *r) {
+    munmap(r->sqes, r->sqes_size);
+    if (r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_size);
+    munmap(r->sq_ptr, r->sq_size);
+    close(r->ring_fd);
+}
+
+// Free SQ entries: the kernel has not consumed what a short or failed submit left
+static unsigned uring_sq_space(struct uring *r) {
+    return URING_ENTRIES - (r->sq_local_tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE));
+}
+
+// Only after uring_sq_reserve() made room, so it cannot run out
+static struct io_uring_sqe* uring_get_sqe(struct uring *r) {
+    unsigned idx = r->sq_local_tail & *r->sq_mask;
+    r->sq_array[idx] = idx;
+    r->sq_local_tail++;
+
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// Publishes every queued SQE and waits until at least wait_nr CQEs are available
+static int uring_submit_and_wait(struct uring_conn *c, unsigned wait_nr) {
+    struct uring *r = &c->ring;
+    unsigned to_submit = r->sq_local_tail - *r->sq_tail;
+    __atomic_store_n(r->sq_tail, r->sq_local_tail, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = sys_io_uring_enter(r->ring_fd, to_submit, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0);
+    } while (ret < 0 && errno == EINTR);
+    c->submits++;
+    return ret < 0 ? -1 : 0;
+}
+
+/*
+ * Makes room for n SQEs, flushing any left over from an earlier submit first.
+ * A linked chain has to go in one submit, so it is reserved whole rather than
+ * flushed halfway; returns -1 (EBUSY) if the kernel still will not take them.
+ */
+static int uring_sq_reserve(struct uring_conn *c, unsigned n) {
+    if (uring_sq_space(&c->ring) >= n) return 0;
+    if (uring_submit_and_wait(c, 0) < 0) return -1;
+    if (uring_sq_space(&c->ring) >= n) return 0;
+    errno = EBUSY;
+    return -1;
+}
+
+/*
+ * Consumes every available CQE. Operation results land in res[user_data] and
+ * bump *got; SEND_ZC buffer-release notifications only update the counters.
+ */
+static void uring_reap(struct uring_conn *c, int32_t *res, unsigned *got) {
+    struct uring *r = &c->ring;
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+
+        if (cqe->flags & IORING_CQE_F_NOTIF) {
+            c->notifs_pending--;
+            if ((uint32_t)cqe->res & IORING_NOTIF_USAGE_ZC_COPIED) c->zc_copied++;
+            else c->zc_sends++;
+        } else {
+            if (res && cqe->user_data <= RECV_USER_DATA) res[cqe->user_data] = cqe->res;
+            if (got) (*got)++;
+            // A SEND_ZC result with F_MORE will be followed by a notification
+            if (cqe->flags & IORING_CQE_F_MORE) c->notifs_pending++;
+        }
+        head++;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Waits for 'want' operation results (notifications do not count)
+static int uring_wait_results(struct uring_conn *c, int32_t *res, unsigned want) {
+    unsigned got = 0;
+    uring_reap(c, res, &got);
+    while (got < want) {
+        if (uring_submit_and_wait(c, 1) < 0) return -1;
+        uring_reap(c, res, &got);
+    }
+    return 0;
+}
+
+
+/************************************************/
+
+//CONNECTION SETUP
+
+int uring_conn_init(struct uring_conn *c, int sockfd, struct message *send_msg,
+                    struct message *recv_msg, int send_zc) {
+
+    memset(c, 0, sizeof(*c));
+    if (uring_setup(&c->ring, URING_ENTRIES) < 0) return -1;
+
+    c->send_msg = send_msg;
+    c->recv_msg = recv_msg;
+    c->send_zc = send_zc;
+
+    // The 8 field writes are separate operations; without NODELAY, Nagle would hold
+    // fields 2..8 back until the peer's delayed ACK
+    int one = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    size_t msg_bytes = NUM_FIELDS * send_msg->field_size;
+    struct iovec bufs[2] = {
+        [SEND_BUF_INDEX] = { .iov_base = send_msg->slab, .iov_len = msg_bytes },
+        [RECV_BUF_INDEX] = { .iov_base = recv_msg->slab, .iov_len = msg_bytes }
+    };
+    if (sys_io_uring_register(c->ring.ring_fd, IORING_REGISTER_BUFFERS, bufs, 2) < 0 ||
+        sys_io_uring_register(c->ring.ring_fd, IORING_REGISTER_FILES, &sockfd, 1) < 0) {
+        int saved = errno;
+        uring_teardown(&c->ring);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+void uring_conn_destroy(struct uring_conn *c) {
+    // Buffers may only go away once the kernel has released every SEND_ZC
+    while (c->notifs_pending > 0) {
+        if (uring_submit_and_wait(c, 1) < 0) break;
+        uring_reap(c, NULL, NULL);
+    }
+    uring_teardown(&c->ring);   // closing the ring drops the registered buffers/files too
+}
+
+
+/************************************************/
+
+//SEND / RECEIVE
+
+ssize_t uring_send_message(struct uring_conn *c) {
+
+    size_t msg_bytes = NUM_FIELDS * c->send_msg->field_size;
+    size_t offset = 0;
+    int32_t res[RECV_USER_DATA + 1];
+
+    // The send slab must not be handed out again while an earlier SEND_ZC still holds it
+    while (c->notifs_pending > 0) {
+        if (uring_submit_and_wait(c, 1) < 0) return -1;
+        uring_reap(c, NULL, NULL);
+    }
+
+    while (offset < msg_bytes) {
+        struct iovec iov[NUM_FIELDS];
+        int cnt = message_iov(c->send_msg, offset, iov);
+        if (uring_sq_reserve(c, cnt) < 0) return -1;
+
+        // One SQE per field, linked so the kernel keeps the byte order on the stream
+        for (int i = 0; i < cnt; i++) {
+            struct io_uring_sqe *sqe = uring_get_sqe(&c->ring);
+            sqe->fd = FIXED_FD;
+            sqe->flags = IOSQE_FIXED_FILE | (i < cnt - 1 ? IOSQE_IO_LINK : 0);
+            sqe->addr = (uint64_t)(uintptr_t)iov[i].iov_base;
+            sqe->len = iov[i].iov_len;
+            sqe->buf_index = SEND_BUF_INDEX;
+            sqe->user_data = i;
+            if (c->send_zc) {
+                sqe->opcode = IORING_OP_SEND_ZC;
+                sqe->ioprio = IORING_RECVSEND_FIXED_BUF | IORING_SEND_ZC_REPORT_USAGE;
+                // Kernel retries short sends itself; MSG_MORE lets it coalesce the fields
+                sqe->msg_flags = MSG_WAITALL | (i < cnt - 1 ? MSG_MORE : 0);
+            } else {
+                sqe->opcode = IORING_OP_WRITE_FIXED;
+                sqe->off = 0;
+            }
+        }
+
+        if (uring_submit_and_wait(c, cnt) < 0) return -1;
+        if (uring_wait_results(c, res, cnt) < 0) return -1;
+
+        // Only the in-order prefix counts: a short write cancels the rest of the chain
+        size_t progressed = 0;
+        for (int i = 0; i < cnt; i++) {
+            if (res[i] < 0) {
+                if (res[i] == -ECANCELED || res[i] == -EINTR || res[i] == -EAGAIN) break;
+                errno = -res[i];
+                return -1;
+            }
+            progressed += res[i];
+            if ((size_t)res[i] < iov[i].iov_len) break;
+        }
+        if (progressed == 0 && res[0] == 0) {
+            errno = EPIPE;
+            return -1;
+        }
+        offset += progressed;
+    }
+    return offset;
+}
+
+ssize_t uring_recv_message(struct uring_conn *c) {
+
+    size_t msg_bytes = NUM_FIELDS * c->recv_msg->field_size;
+    size_t offset = 0;
+    int32_t res[RECV_USER_DATA + 1];
+
+    while (offset < msg_bytes) {
+        // The receive slab is contiguous, so one read covers every remaining field
+        if (uring_sq_reserve(c, 1) < 0) return -1;
+        struct io_uring_sqe *sqe = uring_get_sqe(&c->ring);
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->fd = FIXED_FD;
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->addr = (uint64_t)(uintptr_t)(c->recv_msg->slab + offset);
+        sqe->len = msg_bytes - offset;
+        sqe->off = 0;
+        sqe->buf_index = RECV_BUF_INDEX;
+        sqe->user_data = RECV_USER_DATA;
+
+        if (uring_submit_and_wait(c, 1) < 0) return -1;
+        if (uring_wait_results(c, res, 1) < 0) return -1;
+
+        int32_t n = res[RECV_USER_DATA];
+        if (n < 0) {
+            if (n == -EINTR || n == -EAGAIN) continue;
+            errno = -n;
+            return -1;
+        }
+        if (n == 0) return offset;  // Connection closed
+        offset += n;
+    }
+    return offset;
+}
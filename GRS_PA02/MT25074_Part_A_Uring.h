@@ -0,0 +1,65 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_Uring.h
+ * Minimal io_uring wrapper (raw syscalls, no liburing) used by the A4 variant
+ */
+
+#ifndef MT25074_PART_A_URING_H
+#define MT25074_PART_A_URING_H
+
+#include <stdint.h>
+#include <linux/io_uring.h>
+#include "MT25074_Part_A_Common.h"
+
+// Enough for one batch of NUM_FIELDS sends plus a receive
+#define URING_ENTRIES 16
+
+struct uring {
+    int ring_fd;
+
+    // Submission queue (shared with the kernel)
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+
+    // Completion queue (shared with the kernel)
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size, sqes_size;
+    unsigned sq_local_tail;   // SQEs filled in up to here; published to sq_tail on submit
+};
+
+/*
+ * One socket driven through io_uring: the socket is a registered (fixed) file
+ * and the send/receive slabs are registered buffers, so the kernel does not
+ * look up the fd or pin the pages again on every operation.
+ */
+struct uring_conn {
+    struct uring ring;
+    struct message *send_msg;
+    struct message *recv_msg;
+    int send_zc;               // 1 = IORING_OP_SEND_ZC, 0 = IORING_OP_WRITE_FIXED
+
+    // SEND_ZC bookkeeping: each send completes twice (result, then buffer release)
+    unsigned notifs_pending;
+    uint64_t zc_sends;         // notifications where the pages really went zero-copy
+    uint64_t zc_copied;        // notifications flagged IORING_NOTIF_USAGE_ZC_COPIED
+
+    uint64_t submits;          // io_uring_enter() calls, for comparison with A1-A3 syscall counts
+};
+
+// Returns 0 on success, -1 (errno set) if io_uring is unavailable or setup fails
+int uring_conn_init(struct uring_conn *c, int sockfd, struct message *send_msg,
+                    struct message *recv_msg, int send_zc);
+void uring_conn_destroy(struct uring_conn *c);
+
+// Sends the whole send_msg as one linked batch of NUM_FIELDS SQEs (one per field).
+// Returns the byte count sent or -1.
+ssize_t uring_send_message(struct uring_conn *c);
+
+// Receives one whole message into recv_msg with registered-buffer reads.
+// Returns the byte count, 0 if the peer closed before the first byte, or -1.
+ssize_t uring_recv_message(struct uring_conn *c);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_A_ZcRecv.c
+ * Client receive-side zero copy: TCP_ZEROCOPY_RECEIVE into an mmap()ed window
+ *
+ * Every other receive path copies the response from the socket buffer into
+ * recv_msg, so "zero-copy" only ever described the send side. Here the
+ * socket itself is mmap()ed and getsockopt(TCP_ZEROCOPY_RECEIVE) remaps
+ * whole payload pages from the receive queue into that window. The kernel
+ * can only do that for page-sized, page-aligned chunks; it reports the bytes
+ * in front of the next such chunk in recv_skip_hint, and those (plus
+ * anything shorter than a page) are read with an ordinary copy into the
+ * message. The two byte counts show how much of the stream really avoided
+ * the copy.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>      // struct tcp_zerocopy_receive (not in glibc's netinet/tcp.h)
+#include "MT25074_Part_A_Common.h"
+
+#define ZC_RECV_MAX_WINDOW (4u << 20)   // mapping never needs to exceed this; larger messages loop
+
+int zc_recv_init(struct zc_recv *zr, int fd, size_t msg_bytes) {
+
+    memset(zr, 0, sizeof(*zr));
+    zr->page = sysconf(_SC_PAGESIZE);
+
+    size_t len = (msg_bytes + zr->page - 1) / zr->page * zr->page;
+    if (len > ZC_RECV_MAX_WINDOW) len = ZC_RECV_MAX_WINDOW;
+
+    void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap of the socket failed, receiving with copies");
+        return -1;
+    }
+    zr->map = map;
+    zr->map_len = len;
+    return 0;
+}
+
+void zc_recv_free(struct zc_recv *zr) {
+    if (zr->map) munmap(zr->map, zr->map_len);
+    zr->map = NULL;
+}
+
+// Copies at most want bytes into msg starting at offset, without blocking
+static ssize_t copy_some(struct zc_recv *zr, int fd, struct message *msg, size_t offset, size_t want) {
+
+    struct iovec iov[NUM_FIELDS];
+    int cnt = message_iov_range(msg, offset, offset + want, iov);
+
+    struct msghdr mh = { .msg_iov = iov, .msg_iovlen = cnt };
+    ssize_t n = recvmsg(fd, &mh, MSG_DONTWAIT);
+    if (n > 0) zr->copied_bytes += n;
+    return n;
+}
+
+ssize_t zc_recv_some(struct zc_recv *zr, int fd, struct message *msg, size_t offset, size_t end) {
+
+    size_t want = end - offset;
+
+    if (zr->map && want >= zr->page) {
+        struct tcp_zerocopy_receive zc;
+        memset(&zc, 0, sizeof(zc));
+        zc.address = (uint64_t)(uintptr_t)zr->map;
+        zc.length = (want < zr->map_len ? want : zr->map_len) / zr->page * zr->page;
+        socklen_t len = sizeof(zc);
+
+        // Also unmaps whatever the previous call left in the window
+        if (getsockopt(fd, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE, &zc, &len) == 0) {
+            if (zc.length > 0) {
+                zr->zc_bytes += zc.length;
+                return zc.length;
+            }
+            // Unaligned bytes in front of the next mappable page: copy just those
+            if (zc.recv_skip_hint > 0 && zc.recv_skip_hint < want) want = zc.recv_skip_hint;
+        } else if (errno != EINTR && errno != EAGAIN) {
+            // e.g. EINVAL/EOPNOTSUPP: no zero-copy receive here, copy from now on
+            perror("TCP_ZEROCOPY_RECEIVE failed, receiving with copies");
+            zc_recv_free(zr);
+        }
+    }
+
+    return copy_some(zr, fd, msg, offset, want);
+}
+
+ssize_t zc_recv_all(struct zc_recv *zr, int fd, struct message *msg) {
+
+    size_t msg_bytes = NUM_FIELDS * msg->field_size;
+    size_t total = 0;
+    while (total < msg_bytes) {
+        ssize_t n = zc_recv_some(zr, fd, msg, total, msg_bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+            // Neither path had data: wait for it instead of spinning
+            struct pollfd pfd = { .fd = fd, .events = POLLIN };
+            if (poll(&pfd, 1, -1) < 0 && errno != EINTR) return -1;
+            continue;
+        }
+        if (n == 0) return total;  // Connection closed
+        total += n;
+    }
+    return total;
+}
+
+void zc_recv_report(uint64_t zc_bytes, uint64_t copied_bytes) {
+    uint64_t total = zc_bytes + copied_bytes;
+    printf("Zero-copy receive: %lu of %lu bytes mapped (%.1f%%), %lu copied\n",
+           zc_bytes, total, total ? 100.0 * zc_bytes / total : 0.0, copied_bytes);
+}
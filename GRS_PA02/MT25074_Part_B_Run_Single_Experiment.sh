@@ -1,57 +1,123 @@
 #!/bin/bash
 # MT25074_Part_B_Run_Single_Experiment.sh
 # Runs single experiment, outputs CSV file with encoded parameters in filename
+#
+# With PERSISTENT_CTL=<control socket> the server is not started here: the run
+# goes to an already running --persistent server (Part C starts one per part
+# and size). Its counters are reset before the run and the STATS/PERF lines
+# are fetched with DUMP instead of waiting for exit.
+#
+# Hardware counters come from the server itself (PERF,final line): each
+# worker thread counts with perf_event_open() only while it moves messages,
+# so no external perf binary is needed.
 
 ROLL_NUM="MT25074"
 
-if [ $# -ne 3 ]; then
-    echo "Usage: $0 <A1|A2|A3> <field_size> <num_threads>" >&2
+if [ $# -ne 3 ] && [ $# -ne 4 ]; then
+    echo "Usage: $0 <A1|A2|A3|A4|A4ZC|A5|A6> <field_size> <num_threads> [thread|epoll]" >&2
     exit 1
 fi
 
 PART=$1
 FIELD_SIZE=$2
 NUM_CLIENTS=$3
+SERVER_MODE=${4:-thread}
+
+# A4ZC is the A4 (io_uring) binaries with IORING_OP_SEND_ZC on both sides
+BIN_PART=$PART
+SERVER_FLAGS=()
+CLIENT_FLAGS=()
+if [ "$PART" == "A4ZC" ]; then
+    BIN_PART="A4"
+    SERVER_FLAGS+=(--send-zc)
+    CLIENT_FLAGS+=(--send-zc)
+fi
 
-SERVER_BIN="./${ROLL_NUM}_Part_${PART}_Server"
-CLIENT_BIN="./${ROLL_NUM}_Part_${PART}_Client"
-
-# Output filename with encoded parameters
-OUTPUT_FILE="${ROLL_NUM}_Part_${PART}_size${FIELD_SIZE}_threads${NUM_CLIENTS}.csv"
-
-# Temp file for perf
-PERF_TMP=$(mktemp /tmp/perf_XXXXXX)
-
-# Run server with perf
-sudo ip netns exec ns1 /usr/lib/linux-tools-6.8.0-100/perf stat \
-    -e cycles,cache-misses,instructions,cache-references,context-switches \
-    -o "$PERF_TMP" \
-    "$SERVER_BIN" "$FIELD_SIZE" "$NUM_CLIENTS" > /dev/null 2>&1 &
-SERVER_PID=$!
-
-sleep 0.5
-
-# Check if server started
-if ! kill -0 $SERVER_PID 2>/dev/null; then
-    echo "ERROR: Server failed to start" >&2
-    rm -f "$PERF_TMP"
-    exit 1
+SERVER_BIN="./${ROLL_NUM}_Part_${BIN_PART}_Server"
+CLIENT_BIN="./${ROLL_NUM}_Part_${BIN_PART}_Client"
+CTL_BIN="./${ROLL_NUM}_Part_A_Ctl"
+# A1-A3 clients are identical, so one load-generator process opens all the
+# connections (pinned worker threads, synchronized start) instead of one
+# sudo-launched process per connection. A5/A6 are server-only variants of
+# the same protocol and use it too. A4 keeps its own io_uring client.
+LOAD_BIN="./${ROLL_NUM}_Part_A_Load_Client"
+
+# Output filename with encoded parameters (non-default server modes get a suffix)
+if [ "$SERVER_MODE" == "thread" ]; then
+    MODE_SUFFIX=""
+    PART_LABEL="$PART"
+else
+    MODE_SUFFIX="_${SERVER_MODE}"
+    PART_LABEL="${PART}-${SERVER_MODE}"
+fi
+OUTPUT_FILE="${ROLL_NUM}_Part_${PART}_size${FIELD_SIZE}_threads${NUM_CLIENTS}${MODE_SUFFIX}.csv"
+# Round-trip latency percentiles from the load generator (A1-A3 only)
+LATENCY_FILE="${OUTPUT_FILE%.csv}_latency.csv"
+
+# Temp file for the server's STATS/PERF lines
+SERVER_LOG=$(mktemp /tmp/server_XXXXXX)
+
+if [ -n "$PERSISTENT_CTL" ]; then
+    # Warm server: counting restarts from zero for this run
+    if ! "$CTL_BIN" --control "$PERSISTENT_CTL" RESET > /dev/null; then
+        echo "ERROR: No persistent server at $PERSISTENT_CTL" >&2
+        rm -f "$SERVER_LOG"
+        exit 1
+    fi
+else
+    # Run server (it prints STATS,final and PERF,final when the last client closes)
+    sudo ip netns exec ns1 "$SERVER_BIN" --mode "$SERVER_MODE" "${SERVER_FLAGS[@]}" "$FIELD_SIZE" "$NUM_CLIENTS" > "$SERVER_LOG" 2>&1 &
+    SERVER_PID=$!
+
+    sleep 0.5
+
+    # Check if server started
+    if ! kill -0 $SERVER_PID 2>/dev/null; then
+        echo "ERROR: Server failed to start" >&2
+        rm -f "$SERVER_LOG"
+        exit 1
+    fi
 fi
 
 # Launch clients
-for ((i=1; i<=NUM_CLIENTS; i++)); do
-    sudo ip netns exec ns2 "$CLIENT_BIN" "$FIELD_SIZE" > /dev/null 2>&1 &
-done
+CLIENT_PIDS=()
+if [ "$BIN_PART" != "A4" ]; then
+    sudo ip netns exec ns2 "$LOAD_BIN" --connections "$NUM_CLIENTS" \
+        --latency-csv "$LATENCY_FILE" "$FIELD_SIZE" > /dev/null 2>&1 &
+    CLIENT_PIDS+=($!)
+else
+    for ((i=1; i<=NUM_CLIENTS; i++)); do
+        sudo ip netns exec ns2 "$CLIENT_BIN" "${CLIENT_FLAGS[@]}" "$FIELD_SIZE" > /dev/null 2>&1 &
+        CLIENT_PIDS+=($!)
+    done
+fi
 
-# Wait for server to finish
-wait $SERVER_PID 2>/dev/null
+if [ -n "$PERSISTENT_CTL" ]; then
+    # The run ends with the clients; give the server a moment to record the last closes
+    wait "${CLIENT_PIDS[@]}" 2>/dev/null
+    sleep 0.2
+    "$CTL_BIN" --control "$PERSISTENT_CTL" DUMP "$PART_LABEL" > "$SERVER_LOG"
+else
+    # Wait for server to finish
+    wait $SERVER_PID 2>/dev/null
+fi
 
-# Parse perf output - MUST exclude "time elapsed" line which also contains "cycles"
-CYCLES=$(grep "cycles" "$PERF_TMP" | grep -v "time elapsed" | head -1 | awk '{print $1}' | tr -d ',')
-INSTRUCTIONS=$(grep "instructions" "$PERF_TMP" | head -1 | awk '{print $1}' | tr -d ',')
-CACHE_MISSES=$(grep "cache-misses" "$PERF_TMP" | head -1 | awk '{print $1}' | tr -d ',')
-CACHE_REFS=$(grep "cache-references" "$PERF_TMP" | head -1 | awk '{print $1}' | tr -d ',')
-CONTEXT_SWITCHES=$(grep "context-switches" "$PERF_TMP" | head -1 | awk '{print $1}' | tr -d ',')
+# Server counters: PERF,final,<label>,<cycles>,<instructions>,<ipc>,<cache_refs>,<cache_misses>,<context_switches>,<cycles_per_msg>
+PERF_LINE=$(grep "^PERF,final," "$SERVER_LOG" | tail -1)
+CYCLES=$(echo "$PERF_LINE" | cut -d, -f4)
+INSTRUCTIONS=$(echo "$PERF_LINE" | cut -d, -f5)
+IPC=$(echo "$PERF_LINE" | cut -d, -f6)
+CACHE_REFS=$(echo "$PERF_LINE" | cut -d, -f7)
+CACHE_MISSES=$(echo "$PERF_LINE" | cut -d, -f8)
+CONTEXT_SWITCHES=$(echo "$PERF_LINE" | cut -d, -f9)
+CYCLES_PER_MSG=$(echo "$PERF_LINE" | cut -d, -f10)
+
+# Server throughput: STATS,final,<label>,<elapsed>,<bytes>,<msgs>,<syscalls>,<goodput_gbps>,<tcp_gbps>,<msgs_per_s>,<syscalls_per_msg>
+STATS_LINE=$(grep "^STATS,final," "$SERVER_LOG" | tail -1)
+GOODPUT_GBPS=$(echo "$STATS_LINE" | cut -d, -f8)
+TCP_GBPS=$(echo "$STATS_LINE" | cut -d, -f9)
+MSGS_PER_SEC=$(echo "$STATS_LINE" | cut -d, -f10)
+SYSCALLS_PER_MSG=$(echo "$STATS_LINE" | cut -d, -f11)
 
 # Default to 0 if empty
 CYCLES=${CYCLES:-0}
@@ -59,14 +125,14 @@ INSTRUCTIONS=${INSTRUCTIONS:-0}
 CACHE_MISSES=${CACHE_MISSES:-0}
 CACHE_REFS=${CACHE_REFS:-0}
 CONTEXT_SWITCHES=${CONTEXT_SWITCHES:-0}
+IPC=${IPC:-0}
+CYCLES_PER_MSG=${CYCLES_PER_MSG:-0}
+GOODPUT_GBPS=${GOODPUT_GBPS:-0}
+TCP_GBPS=${TCP_GBPS:-0}
+MSGS_PER_SEC=${MSGS_PER_SEC:-0}
+SYSCALLS_PER_MSG=${SYSCALLS_PER_MSG:-0}
 
 # Calculate derived metrics
-if [[ "$CYCLES" != "0" && -n "$CYCLES" ]]; then
-    IPC=$(echo "scale=4; $INSTRUCTIONS / $CYCLES" | bc 2>/dev/null || echo "0")
-else
-    IPC="0"
-fi
-
 if [[ "$CACHE_REFS" != "0" && -n "$CACHE_REFS" ]]; then
     MISS_RATE=$(echo "scale=4; $CACHE_MISSES / $CACHE_REFS * 100" | bc 2>/dev/null || echo "0")
 else
@@ -74,8 +140,8 @@ else
 fi
 
 # Write CSV
-echo "part,field_size,num_threads,cycles,instructions,ipc,cache_misses,cache_references,cache_miss_rate,context_switches" > "$OUTPUT_FILE"
-echo "$PART,$FIELD_SIZE,$NUM_CLIENTS,$CYCLES,$INSTRUCTIONS,$IPC,$CACHE_MISSES,$CACHE_REFS,$MISS_RATE,$CONTEXT_SWITCHES" >> "$OUTPUT_FILE"
+echo "part,field_size,num_threads,cycles,instructions,ipc,cache_misses,cache_references,cache_miss_rate,context_switches,goodput_gbps,tcp_gbps,msgs_per_sec,syscalls_per_msg,cycles_per_msg" > "$OUTPUT_FILE"
+echo "$PART_LABEL,$FIELD_SIZE,$NUM_CLIENTS,$CYCLES,$INSTRUCTIONS,$IPC,$CACHE_MISSES,$CACHE_REFS,$MISS_RATE,$CONTEXT_SWITCHES,$GOODPUT_GBPS,$TCP_GBPS,$MSGS_PER_SEC,$SYSCALLS_PER_MSG,$CYCLES_PER_MSG" >> "$OUTPUT_FILE"
 
-rm -f "$PERF_TMP"
+rm -f "$SERVER_LOG"
 echo "$OUTPUT_FILE"
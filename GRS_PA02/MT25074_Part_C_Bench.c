@@ -0,0 +1,1090 @@
+/*
+ * Roll Number: MT25074
+ * MT25074_Part_C_Bench.c
+ * Benchmark driver: runs the {variant, size, threads, depth} matrix K times
+ * in random order and writes median / stddev / 95% CI per cell
+ *
+ * The shell sweep ran every cell once, in a fixed order, through sudo, sleep
+ * and bc, so one noisy run (a 2-thread row at twice the cycles of the
+ * 4-thread one) went straight into the plots. This driver forks the server
+ * and clients itself, starts the clients as soon as the server prints its
+ * "Server Listening" line, reads the STATS,final / PERF,final lines and the
+ * client latency summary, and repeats every cell --reps times. The runs are
+ * shuffled (--seed) so slow drift (thermal, page cache, other tenants)
+ * spreads over the cells instead of biasing the ones that happen to run last.
+ *
+ * One --persistent server serves every run of a {variant, size, threads}
+ * group: RESET before the clients start, DUMP after they exit, SHUTDOWN when
+ * the group is done. The groups run in shuffled order, and so do the runs
+ * inside each. --cold-start restarts the server for every run instead (all
+ * runs shuffled together), for measurements that should include a fresh
+ * process.
+ *
+ *   ./MT25074_Part_C_Bench [--variants LIST] [--sizes LIST] [--threads LIST] [--depths LIST]
+ *                          [--reps K] [--seed N] [--duration S] [--warmup S] [--settle MS]
+ *                          [--server-cpus LIST] [--client-cpus LIST] [--isolate] [--netns]
+ *                          [--cold-start] [--out FILE] [--runs-csv FILE]
+ *
+ * Variants are A1..A6 and A4ZC, with "-epoll" for the epoll server mode.
+ * Output (--out), one row per cell and metric:
+ *   variant,field_size,threads,depth,metric,n,median,mean,stddev,ci95_low,ci95_high,outliers
+ * n counts the successful runs; outliers counts runs whose modified z-score
+ * (0.6745 * |x - median| / MAD) is above 3.5. They stay in every statistic
+ * (the median is robust to them anyway) and are flagged in --runs-csv.
+ */
+
+#define _GNU_SOURCE  // pipe2, sched_setaffinity
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "MT25074_Part_A_Common.h"
+
+#define MAX_VARIANTS 32
+#define MAX_CLIENT_PROCS 64                // A4 runs one client process per thread
+#define SERVER_READY_TIMEOUT_MS 5000
+#define SERVER_STOP_TIMEOUT_MS 10000       // SHUTDOWN to exit, before it is killed
+#define CONTROL_REPLY_BYTES 1024           // DUMP: STATS,final + PERF,final
+#define DUMP_SETTLE_MS 50                  // between DUMPs while the counters still move
+#define DUMP_SETTLE_TRIES 20
+#define RUN_GRACE_SECONDS 30               // on top of warm-up + duration before a run is killed
+#define OUTLIER_Z 3.5
+#define DEFAULT_REPS 5
+#define DEFAULT_SETTLE_MS 200
+#define DEFAULT_OUT "MT25074_Part_C_Results.csv"
+
+enum metric {
+    M_GOODPUT, M_TCP, M_MSGS, M_SYSCALLS,
+    M_CYCLES, M_INSTRUCTIONS, M_IPC, M_CACHE_MISSES, M_CACHE_REFS, M_MISS_RATE,
+    M_CTX_SWITCHES, M_CYCLES_PER_MSG, M_P50_US, M_P99_US,
+    NUM_METRICS
+};
+
+static const char *metric_names[NUM_METRICS] = {
+    "goodput_gbps", "tcp_gbps", "msgs_per_sec", "syscalls_per_msg",
+    "cycles", "instructions", "ipc", "cache_misses", "cache_references", "cache_miss_rate",
+    "context_switches", "cycles_per_msg", "p50_us", "p99_us"
+};
+
+struct variant {
+    char name[16];     // as written in the output: A1, A4ZC, A2-epoll, ...
+    char part[4];      // binary: A1..A6
+    int send_zc;       // A4ZC
+    int epoll;
+};
+
+struct cell {
+    const struct variant *v;
+    int field_size;
+    int threads;
+    int depth;
+};
+
+struct run {
+    int cell;
+    int rep;
+    int ok;
+    double m[NUM_METRICS];
+};
+
+struct bench_config {
+    struct variant variants[MAX_VARIANTS];
+    int num_variants;
+    int *sizes, num_sizes;
+    int *threads, num_threads;
+    int *depths, num_depths;
+    int reps;
+    unsigned long seed;
+    int duration;
+    int warmup;
+    int settle_ms;
+    const char *server_cpus;   // passed through as --cpus, also the process affinity
+    const char *client_cpus;
+    int isolate;
+    int netns;                 // server in ns1, clients in ns2 (Part A namespaces script)
+    const char *pages;         // passed through as --pages (NULL = server/client default)
+    int numa_local;            // passed through as --numa-local
+    int cold_start;            // a fresh server per run instead of one per group
+    const char *control;       // persistent servers' control socket
+    const char *out;
+    const char *runs_csv;
+};
+
+
+/************************************************/
+
+//ARGUMENTS
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--variants LIST] [--sizes LIST] [--threads LIST] [--depths LIST]\n"
+                    "          [--reps K] [--seed N] [--duration S] [--warmup S] [--settle MS]\n"
+                    "          [--server-cpus LIST] [--client-cpus LIST] [--isolate] [--netns]\n"
+                    "          [--pages P] [--numa-local] [--cold-start] [--out FILE] [--runs-csv FILE]\n", prog);
+    fprintf(stderr, "  --variants LIST    A1..A6, A4ZC; all but A4/A4ZC also with -epoll (default A1,A2,A3,A4,A4ZC,A5,A6)\n");
+    fprintf(stderr, "  --reps K           runs per cell (default %d), all cells shuffled together\n", DEFAULT_REPS);
+    fprintf(stderr, "  --seed N           shuffle seed (default: time; printed so a sweep can be replayed)\n");
+    fprintf(stderr, "  --settle MS        pause between runs (default %d)\n", DEFAULT_SETTLE_MS);
+    fprintf(stderr, "  --server-cpus LIST pin the server (and its workers) to these CPUs\n");
+    fprintf(stderr, "  --client-cpus LIST pin the clients to these CPUs\n");
+    fprintf(stderr, "  --isolate          require disjoint server/client CPUs; the driver runs on the rest\n");
+    fprintf(stderr, "  --netns            server in ns1, clients in ns2 (needs root)\n");
+    fprintf(stderr, "  --pages P          message buffers on default, thp or hugetlb pages (both sides)\n");
+    fprintf(stderr, "  --numa-local       bind message buffers to each worker's NUMA node (both sides)\n");
+    fprintf(stderr, "  --cold-start       start a fresh server for every run (default: one persistent\n"
+                    "                     server per variant/size/threads, RESET between runs)\n");
+    fprintf(stderr, "  --out FILE         per-cell statistics (default %s)\n", DEFAULT_OUT);
+    fprintf(stderr, "  --runs-csv FILE    also write every run's metrics\n");
+}
+
+static int parse_variant(const char *s, struct variant *v) {
+    memset(v, 0, sizeof(*v));
+    size_t len = strcspn(s, "-");
+    if (strcmp(s + len, "-epoll") == 0) {
+        v->epoll = 1;
+    } else if (s[len] != '\0') {
+        return -1;
+    }
+    if (len == 4 && strncmp(s, "A4ZC", 4) == 0) {
+        v->send_zc = 1;
+    } else if (len != 2 || s[0] != 'A' || s[1] < '1' || s[1] > '6') {
+        return -1;
+    }
+    snprintf(v->part, sizeof(v->part), "A%c", s[1]);
+    snprintf(v->name, sizeof(v->name), "%s", s);
+    // The io_uring server has no epoll mode; fail here, not in every run
+    if (v->epoll && strcmp(v->part, "A4") == 0) {
+        fprintf(stderr, "%s: A4 has no epoll mode\n", s);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_variants(const char *list, struct bench_config *cfg) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", list);
+    cfg->num_variants = 0;
+    for (char *save, *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        if (cfg->num_variants == MAX_VARIANTS || parse_variant(tok, &cfg->variants[cfg->num_variants]) < 0) {
+            fprintf(stderr, "Bad variant: %s\n", tok);
+            return -1;
+        }
+        cfg->num_variants++;
+    }
+    return cfg->num_variants > 0 ? 0 : -1;
+}
+
+// Sizes, thread counts and depths are comma-separated like CPU lists
+static int parse_list(const char *what, const char *s, int **out, int *count) {
+    free(*out);
+    *out = NULL;
+    *count = parse_cpu_list(s, out);
+    for (int i = 0; i < *count; i++) {
+        if ((*out)[i] == 0) *count = -1;
+    }
+    if (*count <= 0) {
+        fprintf(stderr, "Bad --%s list: %s\n", what, s);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_bench_args(int argc, char *argv[], struct bench_config *cfg) {
+
+    static struct option long_opts[] = {
+        {"variants",    required_argument, NULL, 'v'},
+        {"sizes",       required_argument, NULL, 's'},
+        {"threads",     required_argument, NULL, 't'},
+        {"depths",      required_argument, NULL, 'q'},
+        {"reps",        required_argument, NULL, 'k'},
+        {"seed",        required_argument, NULL, 'S'},
+        {"duration",    required_argument, NULL, 'd'},
+        {"warmup",      required_argument, NULL, 'w'},
+        {"settle",      required_argument, NULL, 'g'},
+        {"server-cpus", required_argument, NULL, 'c'},
+        {"client-cpus", required_argument, NULL, 'C'},
+        {"isolate",     no_argument,       NULL, 'i'},
+        {"netns",       no_argument,       NULL, 'n'},
+        {"pages",       required_argument, NULL, 'H'},
+        {"numa-local",  no_argument,       NULL, 'N'},
+        {"cold-start",  no_argument,       NULL, 'K'},
+        {"out",         required_argument, NULL, 'o'},
+        {"runs-csv",    required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}
+    };
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->reps = DEFAULT_REPS;
+    cfg->seed = (unsigned long)time(NULL) ^ (unsigned long)getpid();
+    cfg->duration = DEFAULT_DURATION_SECONDS;
+    cfg->warmup = DEFAULT_WARMUP_SECONDS;
+    cfg->settle_ms = DEFAULT_SETTLE_MS;
+    cfg->out = DEFAULT_OUT;
+    if (parse_variants("A1,A2,A3,A4,A4ZC,A5,A6", cfg) < 0 ||
+        parse_list("sizes", "64,256,1024,4096,65536,262144,1048576,4194304", &cfg->sizes, &cfg->num_sizes) < 0 ||
+        parse_list("threads", "1,2,4,8", &cfg->threads, &cfg->num_threads) < 0 ||
+        parse_list("depths", "1", &cfg->depths, &cfg->num_depths) < 0) {
+        return -1;
+    }
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "v:s:t:q:k:S:d:w:g:c:C:inH:NKo:r:", long_opts, NULL)) != -1) {
+        int rc = 0;
+        switch (opt) {
+        case 'v':
+            if (parse_variants(optarg, cfg) < 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 's': rc = parse_list("sizes", optarg, &cfg->sizes, &cfg->num_sizes); break;
+        case 't': rc = parse_list("threads", optarg, &cfg->threads, &cfg->num_threads); break;
+        case 'q': rc = parse_list("depths", optarg, &cfg->depths, &cfg->num_depths); break;
+        case 'k': cfg->reps = atoi(optarg); break;
+        case 'S': cfg->seed = strtoul(optarg, NULL, 10); break;
+        case 'd': cfg->duration = atoi(optarg); break;
+        case 'w': cfg->warmup = atoi(optarg); break;
+        case 'g': cfg->settle_ms = atoi(optarg); break;
+        case 'c': cfg->server_cpus = optarg; break;
+        case 'C': cfg->client_cpus = optarg; break;
+        case 'i': cfg->isolate = 1; break;
+        case 'n': cfg->netns = 1; break;
+        case 'H':
+            cfg->pages = optarg;
+            if (parse_buffer_pages(optarg) < 0) rc = -1;
+            break;
+        case 'N': cfg->numa_local = 1; break;
+        case 'K': cfg->cold_start = 1; break;
+        case 'o': cfg->out = optarg; break;
+        case 'r': cfg->runs_csv = optarg; break;
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+        if (rc < 0) return -1;
+    }
+
+    if (optind != argc || cfg->reps < 1 || cfg->duration < 1 || cfg->warmup < 0 || cfg->settle_ms < 0) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    for (int i = 0; i < cfg->num_threads; i++) {
+        if (cfg->threads[i] > MAX_CLIENT_PROCS) {
+            fprintf(stderr, "At most %d threads per cell\n", MAX_CLIENT_PROCS);
+            return -1;
+        }
+    }
+    for (int i = 0; i < cfg->num_depths; i++) {
+        if (cfg->depths[i] > PIPELINE_MAX_DEPTH) {
+            fprintf(stderr, "Depth must be between 1 and %d\n", PIPELINE_MAX_DEPTH);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/************************************************/
+
+//CPU PLACEMENT
+
+static int cpu_set_from_list(const char *list, cpu_set_t *set) {
+    int *cpus = NULL;
+    int n = parse_cpu_list(list, &cpus);
+    if (n <= 0) {
+        fprintf(stderr, "Bad CPU list: %s\n", list);
+        return -1;
+    }
+    CPU_ZERO(set);
+    for (int i = 0; i < n; i++) {
+        if (cpus[i] < CPU_SETSIZE) CPU_SET(cpus[i], set);
+    }
+    free(cpus);
+    return 0;
+}
+
+// --isolate: server and client CPUs must not overlap, and the driver itself
+// (pipe reads, waitpid) moves to whatever online CPUs are left
+static int isolate_driver(const struct bench_config *cfg) {
+
+    cpu_set_t server, client, both, rest;
+    if (!cfg->server_cpus || !cfg->client_cpus) {
+        fprintf(stderr, "--isolate needs both --server-cpus and --client-cpus\n");
+        return -1;
+    }
+    if (cpu_set_from_list(cfg->server_cpus, &server) < 0 ||
+        cpu_set_from_list(cfg->client_cpus, &client) < 0) {
+        return -1;
+    }
+    CPU_AND(&both, &server, &client);
+    if (CPU_COUNT(&both) > 0) {
+        fprintf(stderr, "--isolate: server CPUs %s and client CPUs %s overlap\n",
+                cfg->server_cpus, cfg->client_cpus);
+        return -1;
+    }
+
+    CPU_ZERO(&rest);
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long c = 0; c < online && c < CPU_SETSIZE; c++) {
+        if (!CPU_ISSET(c, &server) && !CPU_ISSET(c, &client)) CPU_SET(c, &rest);
+    }
+    if (CPU_COUNT(&rest) == 0) {
+        fprintf(stderr, "--isolate: no CPU left for the driver; it shares the client CPUs\n");
+        return 0;
+    }
+    if (sched_setaffinity(0, sizeof(rest), &rest) < 0) {
+        perror("sched_setaffinity failed for the driver");
+        return -1;
+    }
+    return 0;
+}
+
+
+/************************************************/
+
+//CHILD PROCESSES
+
+struct child {
+    pid_t pid;
+    int fd;          // read end of its stdout + stderr, -1 once at EOF
+    char *out;
+    size_t len;
+    size_t cap;
+};
+
+// Forks argv with stdout and stderr on a pipe, optionally pinned to cpus
+static int spawn(struct child *c, char *const argv[], const char *cpus) {
+
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+    cpu_set_t set;
+    if (cpus && cpu_set_from_list(cpus, &set) < 0) return -1;
+
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) < 0) {
+        perror("pipe2 failed");
+        return -1;
+    }
+    c->pid = fork();
+    if (c->pid < 0) {
+        perror("fork failed");
+        close(p[0]);
+        close(p[1]);
+        return -1;
+    }
+    if (c->pid == 0) {
+        dup2(p[1], STDOUT_FILENO);
+        dup2(p[1], STDERR_FILENO);
+        // Inherited by every thread the program starts, so nothing escapes the set
+        if (cpus && sched_setaffinity(0, sizeof(set), &set) < 0) perror("sched_setaffinity failed");
+        execvp(argv[0], argv);
+        perror("exec failed");
+        _exit(127);
+    }
+    close(p[1]);
+    c->fd = p[0];
+    return 0;
+}
+
+static void child_append(struct child *c, const char *buf, size_t n) {
+    if (c->len + n + 1 > c->cap) {
+        size_t cap = c->cap ? c->cap : 4096;
+        while (cap < c->len + n + 1) cap *= 2;
+        char *grown = realloc(c->out, cap);
+        if (!grown) return;   // keep what we have; parsing reports the missing lines
+        c->out = grown;
+        c->cap = cap;
+    }
+    memcpy(c->out + c->len, buf, n);
+    c->len += n;
+    c->out[c->len] = '\0';
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Reads every child's pipe until children[first..n-1] are all at EOF
+ * (returns 0), until children[0]'s output contains 'until' (returns 0), or
+ * until timeout_ms has passed (returns -1). Children before 'first' (a
+ * persistent server) are only drained so they never block on a full pipe.
+ */
+static int read_children(struct child *cs, int n, int first, const char *until, int timeout_ms) {
+
+    uint64_t deadline = now_ms() + timeout_ms;
+    struct pollfd pfds[MAX_CLIENT_PROCS + 1];
+    while (1) {
+        if (until && cs[0].out && strstr(cs[0].out, until)) return 0;
+
+        int npoll = 0, waiting = 0;
+        for (int i = 0; i < n; i++) {
+            if (cs[i].fd < 0) continue;
+            pfds[npoll++] = (struct pollfd){ .fd = cs[i].fd, .events = POLLIN };
+            if (i >= first) waiting++;
+        }
+        if (waiting == 0) return until ? -1 : 0;
+
+        uint64_t now = now_ms();
+        if (now >= deadline) return -1;
+        if (poll(pfds, npoll, (int)(deadline - now)) < 0 && errno != EINTR) {
+            perror("poll failed");
+            return -1;
+        }
+
+        for (int i = 0, k = 0; i < n; i++) {
+            if (cs[i].fd < 0) continue;
+            if (pfds[k++].revents == 0) continue;
+            char buf[4096];
+            ssize_t got = read(cs[i].fd, buf, sizeof(buf));
+            if (got > 0) {
+                child_append(&cs[i], buf, got);
+            } else if (got == 0 || errno != EINTR) {
+                close(cs[i].fd);
+                cs[i].fd = -1;
+            }
+        }
+    }
+}
+
+// Reaps every child (killing any still running when kill_first is set); returns 0 if all exited 0
+static int reap_children(struct child *cs, int n, int kill_first) {
+    int failed = 0;
+    for (int i = 0; i < n; i++) {
+        if (cs[i].pid <= 0) continue;
+        if (kill_first) kill(cs[i].pid, SIGKILL);
+        int status = 0;
+        pid_t got;
+        while ((got = waitpid(cs[i].pid, &status, 0)) < 0 && errno == EINTR) {}
+        if (got < 0) {
+            perror("waitpid failed");
+            failed = 1;
+        } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = 1;
+        }
+        if (cs[i].fd >= 0) close(cs[i].fd);
+        free(cs[i].out);
+        memset(&cs[i], 0, sizeof(cs[i]));
+        cs[i].fd = -1;
+    }
+    return failed ? -1 : 0;
+}
+
+
+/************************************************/
+
+//ONE RUN
+
+// Field idx (0-based) of the last line starting with prefix, as a number
+static int line_field(const char *out, const char *prefix, int idx, double *v) {
+    const char *line = NULL;
+    for (const char *p = out; p && (p = strstr(p, prefix)); p++) {
+        if (p == out || p[-1] == '\n') line = p;
+    }
+    if (!line) return -1;
+    for (int i = 0; i < idx; i++) {
+        line = strpbrk(line, ",\n");
+        if (!line || *line == '\n') return -1;
+        line++;
+    }
+    char *end;
+    *v = strtod(line, &end);
+    return end == line ? -1 : 0;
+}
+
+// "Latency (us): ... p50=X p99=Y ..." from one client; keeps the worst client's value
+static void client_latency(const char *out, double *p50, double *p99) {
+    const char *lat = out ? strstr(out, "Latency (us):") : NULL;
+    if (!lat) return;
+    const char *p = strstr(lat, "p50=");
+    if (p && atof(p + 4) > *p50) *p50 = atof(p + 4);
+    p = strstr(lat, "p99=");
+    if (p && atof(p + 4) > *p99) *p99 = atof(p + 4);
+}
+
+static int parse_run(const char *server_out, struct child *clients, int num_clients, struct run *r) {
+
+    // STATS,final,<label>,<elapsed_s>,<bytes>,<messages>,<syscalls>,<goodput_gbps>,<tcp_gbps>,<msgs_per_s>,<syscalls_per_msg>
+    static const struct { int idx; enum metric m; } stats_fields[] = {
+        { 7, M_GOODPUT }, { 8, M_TCP }, { 9, M_MSGS }, { 10, M_SYSCALLS }
+    };
+    // PERF,final,<label>,<cycles>,<instructions>,<ipc>,<cache_refs>,<cache_misses>,<context_switches>,<cycles_per_msg>
+    static const struct { int idx; enum metric m; } perf_fields[] = {
+        { 3, M_CYCLES }, { 4, M_INSTRUCTIONS }, { 5, M_IPC }, { 6, M_CACHE_REFS },
+        { 7, M_CACHE_MISSES }, { 8, M_CTX_SWITCHES }, { 9, M_CYCLES_PER_MSG }
+    };
+
+    for (size_t i = 0; i < sizeof(stats_fields) / sizeof(stats_fields[0]); i++) {
+        if (line_field(server_out, "STATS,final,", stats_fields[i].idx, &r->m[stats_fields[i].m]) < 0) {
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < sizeof(perf_fields) / sizeof(perf_fields[0]); i++) {
+        if (line_field(server_out, "PERF,final,", perf_fields[i].idx, &r->m[perf_fields[i].m]) < 0) {
+            return -1;
+        }
+    }
+    r->m[M_MISS_RATE] = r->m[M_CACHE_REFS] > 0 ? 100.0 * r->m[M_CACHE_MISSES] / r->m[M_CACHE_REFS] : 0.0;
+    for (int i = 0; i < num_clients; i++) {
+        client_latency(clients[i].out, &r->m[M_P50_US], &r->m[M_P99_US]);
+    }
+    return 0;
+}
+
+// Appends argv words after an optional "ip netns exec <ns>" prefix
+static int netns_prefix(char **argv, const struct bench_config *cfg, const char *ns) {
+    if (!cfg->netns) return 0;
+    argv[0] = "ip";
+    argv[1] = "netns";
+    argv[2] = "exec";
+    argv[3] = (char *)ns;
+    return 4;
+}
+
+// Appends the --pages / --numa-local choice, the same for server and clients
+static int buffer_args(char **argv, int n, const struct bench_config *cfg) {
+    if (cfg->pages) {
+        argv[n++] = "--pages";
+        argv[n++] = (char *)cfg->pages;
+    }
+    if (cfg->numa_local) argv[n++] = "--numa-local";
+    return n;
+}
+
+// Server and client command lines for one cell
+struct run_args {
+    char size[16], threads[16], depth[16], duration[16], warmup[16];
+    char server_bin[64];
+    char *sargv[28];
+    char *cargv[24];
+    int procs;        // client processes: one load generator, or one A4 client per thread
+};
+
+// control != NULL: a --persistent server on that control socket
+static void build_run_args(const struct bench_config *cfg, const struct cell *c, const char *control,
+                           struct run_args *a) {
+
+    snprintf(a->size, sizeof(a->size), "%d", c->field_size);
+    snprintf(a->threads, sizeof(a->threads), "%d", c->threads);
+    snprintf(a->depth, sizeof(a->depth), "%d", c->depth);
+    snprintf(a->duration, sizeof(a->duration), "%d", cfg->duration);
+    snprintf(a->warmup, sizeof(a->warmup), "%d", cfg->warmup);
+
+    // Server: final lines only, no periodic reporter in the way
+    snprintf(a->server_bin, sizeof(a->server_bin), "./MT25074_Part_%s_Server", c->v->part);
+    char **sargv = a->sargv;
+    int n = netns_prefix(sargv, cfg, "ns1");
+    sargv[n++] = a->server_bin;
+    sargv[n++] = "--stats-interval";
+    sargv[n++] = "0";
+    if (control) {
+        sargv[n++] = "--persistent";
+        sargv[n++] = "--control";
+        sargv[n++] = (char *)control;
+    }
+    if (c->v->epoll) {
+        sargv[n++] = "--mode";
+        sargv[n++] = "epoll";
+    }
+    if (c->v->send_zc) sargv[n++] = "--send-zc";
+    if (cfg->server_cpus) {
+        sargv[n++] = "--cpus";
+        sargv[n++] = (char *)cfg->server_cpus;
+    }
+    n = buffer_args(sargv, n, cfg);
+    sargv[n++] = a->size;
+    sargv[n++] = a->threads;
+    sargv[n] = NULL;
+
+    // Clients: one load generator for the whole cell, or one A4 process per thread
+    int is_a4 = strcmp(c->v->part, "A4") == 0;
+    char **cargv = a->cargv;
+    n = netns_prefix(cargv, cfg, "ns2");
+    if (!is_a4) {
+        cargv[n++] = "./MT25074_Part_A_Load_Client";
+        cargv[n++] = "--connections";
+        cargv[n++] = a->threads;
+        cargv[n++] = "--depth";
+        cargv[n++] = a->depth;
+        if (cfg->client_cpus) {
+            cargv[n++] = "--cpus";
+            cargv[n++] = (char *)cfg->client_cpus;
+        }
+    } else {
+        cargv[n++] = "./MT25074_Part_A4_Client";
+        if (c->v->send_zc) cargv[n++] = "--send-zc";
+    }
+    n = buffer_args(cargv, n, cfg);
+    cargv[n++] = "--duration";
+    cargv[n++] = a->duration;
+    cargv[n++] = "--warmup";
+    cargv[n++] = a->warmup;
+    cargv[n++] = a->size;
+    cargv[n] = NULL;
+    a->procs = is_a4 ? c->threads : 1;
+}
+
+static int start_server(const struct bench_config *cfg, struct run_args *a, struct child *server) {
+    if (spawn(server, a->sargv, cfg->server_cpus) < 0) return -1;
+    if (read_children(server, 1, 0, "Server Listening", SERVER_READY_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "Server did not start listening:\n%s", server->out ? server->out : "");
+        reap_children(server, 1, 1);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Starts the clients and reads all pipes until the clients are done, and the
+ * server too unless it is persistent. all[0] is the server on entry and on
+ * return, all[1..*num_clients] the clients. Returns -1 if a client could not
+ * be started or the run timed out.
+ */
+static int run_clients(const struct bench_config *cfg, struct run_args *a, struct child *all,
+                       int *num_clients, int persistent) {
+
+    *num_clients = 0;
+    for (int i = 0; i < a->procs; i++) {
+        if (spawn(&all[1 + i], a->cargv, cfg->client_cpus) < 0) return -1;
+        (*num_clients)++;
+    }
+    int timeout_ms = (cfg->warmup + cfg->duration + RUN_GRACE_SECONDS) * 1000;
+    if (read_children(all, *num_clients + 1, persistent ? 1 : 0, NULL, timeout_ms) < 0) {
+        fprintf(stderr, "Run timed out after %d s; killing it\n", timeout_ms / 1000);
+        return -1;
+    }
+    return 0;
+}
+
+// A fresh server for this run alone; it exits after its last client, so its EOF ends the run
+static int run_cold(const struct bench_config *cfg, const struct cell *c, struct run *r) {
+
+    struct run_args a;
+    build_run_args(cfg, c, NULL, &a);
+    struct child all[MAX_CLIENT_PROCS + 1];
+    if (start_server(cfg, &a, &all[0]) < 0) return -1;
+
+    int num_clients;
+    int failed = run_clients(cfg, &a, all, &num_clients, 0) < 0;
+    if (!failed && parse_run(all[0].out, &all[1], num_clients, r) < 0) {
+        fprintf(stderr, "No STATS/PERF final lines from the server:\n%s", all[0].out ? all[0].out : "");
+        failed = 1;
+    }
+    if (reap_children(all, num_clients + 1, failed) < 0 && !failed) {
+        fprintf(stderr, "A server or client exited with an error\n");
+        failed = 1;
+    }
+    return failed ? -1 : 0;
+}
+
+
+/************************************************/
+
+//PERSISTENT SERVERS
+
+// Runs of two cells can share a server when its command line is the same
+static int same_server(const struct cell *a, const struct cell *b) {
+    return a->v == b->v && a->field_size == b->field_size && a->threads == b->threads;
+}
+
+// One command on the control socket; the server replies and closes
+static int control_request(const char *path, const char *cmd, char *reply, size_t len) {
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "%s: control socket %s: %s\n", cmd, path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    if (dprintf(fd, "%s\n", cmd) < 0) {
+        perror("Control write failed");
+        close(fd);
+        return -1;
+    }
+    size_t used = 0;
+    while (used < len - 1) {
+        ssize_t n = read(fd, reply + used, len - 1 - used);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        used += n;
+    }
+    reply[used] = '\0';
+    close(fd);
+    if (used == 0 || strncmp(reply, "ERR", 3) == 0) {
+        fprintf(stderr, "%s: bad control reply '%s'\n", cmd, reply);
+        return -1;
+    }
+    return 0;
+}
+
+// Starts the group's server and checks the control socket is really its own
+static int server_up(const struct bench_config *cfg, const struct cell *c, struct child *server) {
+
+    struct run_args a;
+    build_run_args(cfg, c, cfg->control, &a);
+    if (start_server(cfg, &a, server) < 0) return -1;
+    // Thread mode opens the control socket only after "Server Listening"
+    if (read_children(server, 1, 0, "Persistent server: pid", SERVER_READY_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "Server did not open its control socket:\n%s", server->out ? server->out : "");
+        reap_children(server, 1, 1);
+        return -1;
+    }
+
+    char reply[CONTROL_REPLY_BYTES];
+    if (control_request(cfg->control, "PID", reply, sizeof(reply)) < 0 || atoi(reply) != server->pid) {
+        fprintf(stderr, "Control socket %s does not belong to server pid %d\n", cfg->control, (int)server->pid);
+        reap_children(server, 1, 1);
+        return -1;
+    }
+    return 0;
+}
+
+// SHUTDOWN and wait for the exit; killed if it does not answer or hangs
+static void server_down(const struct bench_config *cfg, struct child *server) {
+    if (server->pid <= 0) return;
+    char reply[CONTROL_REPLY_BYTES];
+    int stuck = control_request(cfg->control, "SHUTDOWN", reply, sizeof(reply)) < 0 ||
+                read_children(server, 1, 0, NULL, SERVER_STOP_TIMEOUT_MS) < 0;
+    if (reap_children(server, 1, stuck) < 0 && !stuck) {
+        fprintf(stderr, "Persistent server exited with an error\n");
+    }
+}
+
+/*
+ * DUMP once the counters stop moving. A client can exit before the server
+ * thread has seen its close, and that close stamps the end of the window, so
+ * the STATS line must read the same twice in a row.
+ */
+static int dump_settled(const char *control, char *reply, size_t len) {
+
+    char prev[CONTROL_REPLY_BYTES] = "";
+    for (int i = 0; i < DUMP_SETTLE_TRIES; i++) {
+        if (i > 0) usleep(DUMP_SETTLE_MS * 1000);
+        if (control_request(control, "DUMP", reply, len) < 0) return -1;
+        size_t line = strcspn(reply, "\n");
+        if (i > 0 && strlen(prev) == line && strncmp(prev, reply, line) == 0) return 0;
+        snprintf(prev, sizeof(prev), "%.*s", (int)line, reply);
+    }
+    fprintf(stderr, "Server counters still moving %d ms after the clients exited\n",
+            DUMP_SETTLE_MS * DUMP_SETTLE_TRIES);
+    return -1;
+}
+
+// One run against the group's server: RESET, clients, DUMP
+static int run_warm(const struct bench_config *cfg, struct child *server, const struct cell *c,
+                    struct run *r) {
+
+    struct run_args a;
+    build_run_args(cfg, c, cfg->control, &a);
+
+    // Only this run's output, for the error messages
+    server->len = 0;
+    if (server->out) server->out[0] = '\0';
+
+    char reply[CONTROL_REPLY_BYTES];
+    if (control_request(cfg->control, "RESET", reply, sizeof(reply)) < 0) return -1;
+
+    struct child all[MAX_CLIENT_PROCS + 1];
+    all[0] = *server;
+    int num_clients;
+    int failed = run_clients(cfg, &a, all, &num_clients, 1) < 0;
+    *server = all[0];
+
+    if (!failed && dump_settled(cfg->control, reply, sizeof(reply)) < 0) failed = 1;
+    if (!failed && parse_run(reply, &all[1], num_clients, r) < 0) {
+        fprintf(stderr, "No STATS/PERF final lines in the DUMP reply:\n%s", reply);
+        failed = 1;
+    }
+    if (reap_children(&all[1], num_clients, failed) < 0 && !failed) {
+        fprintf(stderr, "A client exited with an error\n");
+        failed = 1;
+    }
+    if (server->fd < 0) {
+        fprintf(stderr, "Persistent server exited:\n%s", server->out ? server->out : "");
+        failed = 1;
+    }
+    return failed ? -1 : 0;
+}
+
+// Pulls the shuffled runs of each server group together, groups in the order they first appear
+static void group_runs(const struct cell *cells, const struct run *runs, int *order, int num_runs) {
+
+    int *grouped = malloc(num_runs * sizeof(*grouped));
+    char *taken = calloc(num_runs, 1);
+    if (!grouped || !taken) {
+        free(grouped);
+        free(taken);
+        return;   // shuffled but ungrouped: more server restarts, same results
+    }
+    int n = 0;
+    for (int k = 0; k < num_runs; k++) {
+        if (taken[k]) continue;
+        const struct cell *c = &cells[runs[order[k]].cell];
+        for (int j = k; j < num_runs; j++) {
+            if (!taken[j] && same_server(c, &cells[runs[order[j]].cell])) {
+                grouped[n++] = order[j];
+                taken[j] = 1;
+            }
+        }
+    }
+    memcpy(order, grouped, num_runs * sizeof(*order));
+    free(grouped);
+    free(taken);
+}
+
+
+/************************************************/
+
+//STATISTICS
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_of(double *v, int n) {
+    qsort(v, n, sizeof(*v), cmp_double);
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+// Two-sided 95% Student t quantile for df degrees of freedom
+static double t95(int df) {
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    return df < 1 ? 0.0 : df <= 30 ? table[df - 1] : 1.960;
+}
+
+struct summary {
+    int n;
+    double median, mean, stddev, ci_low, ci_high;
+    int outliers;
+    double mad;       // median absolute deviation, for flagging single runs
+};
+
+static void summarize(const double *x, int n, struct summary *s) {
+
+    memset(s, 0, sizeof(*s));
+    s->n = n;
+    if (n == 0) return;
+
+    double *tmp = malloc(n * sizeof(*tmp));
+    if (!tmp) return;
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        tmp[i] = x[i];
+        sum += x[i];
+    }
+    s->mean = sum / n;
+    s->median = median_of(tmp, n);
+
+    double sq = 0;
+    for (int i = 0; i < n; i++) {
+        sq += (x[i] - s->mean) * (x[i] - s->mean);
+        tmp[i] = fabs(x[i] - s->median);
+    }
+    s->stddev = n > 1 ? sqrt(sq / (n - 1)) : 0.0;
+    double half = n > 1 ? t95(n - 1) * s->stddev / sqrt(n) : 0.0;
+    s->ci_low = s->mean - half;
+    s->ci_high = s->mean + half;
+
+    s->mad = median_of(tmp, n);
+    for (int i = 0; i < n; i++) {
+        if (s->mad > 0 && 0.6745 * fabs(x[i] - s->median) / s->mad > OUTLIER_Z) s->outliers++;
+    }
+    free(tmp);
+}
+
+static int is_outlier(double x, const struct summary *s) {
+    return s->mad > 0 && 0.6745 * fabs(x - s->median) / s->mad > OUTLIER_Z;
+}
+
+
+/************************************************/
+
+//OUTPUT
+
+static int write_results(const struct bench_config *cfg, const struct cell *cells, int num_cells,
+                         const struct run *runs, int num_runs) {
+
+    FILE *out = fopen(cfg->out, "w");
+    FILE *raw = cfg->runs_csv ? fopen(cfg->runs_csv, "w") : NULL;
+    if (!out || (cfg->runs_csv && !raw)) {
+        perror("Cannot open the output file");
+        if (out) fclose(out);
+        return -1;
+    }
+
+    fprintf(out, "variant,field_size,threads,depth,metric,n,median,mean,stddev,ci95_low,ci95_high,outliers\n");
+    if (raw) {
+        fprintf(raw, "variant,field_size,threads,depth,rep,ok,outlier");
+        for (int m = 0; m < NUM_METRICS; m++) fprintf(raw, ",%s", metric_names[m]);
+        fprintf(raw, "\n");
+    }
+
+    double *x = malloc(cfg->reps * sizeof(*x));
+    if (!x) {
+        fclose(out);
+        if (raw) fclose(raw);
+        return -1;
+    }
+    for (int ci = 0; ci < num_cells; ci++) {
+        const struct cell *c = &cells[ci];
+        struct summary goodput = {0};
+        for (int m = 0; m < NUM_METRICS; m++) {
+            int n = 0;
+            for (int i = 0; i < num_runs; i++) {
+                if (runs[i].cell == ci && runs[i].ok) x[n++] = runs[i].m[m];
+            }
+            struct summary s;
+            summarize(x, n, &s);
+            if (m == M_GOODPUT) goodput = s;
+            fprintf(out, "%s,%d,%d,%d,%s,%d,%.6g,%.6g,%.6g,%.6g,%.6g,%d\n",
+                    c->v->name, c->field_size, c->threads, c->depth, metric_names[m],
+                    s.n, s.median, s.mean, s.stddev, s.ci_low, s.ci_high, s.outliers);
+        }
+        // Runs in rep order; a run is flagged by its goodput
+        for (int i = 0; raw && i < num_runs; i++) {
+            if (runs[i].cell != ci) continue;
+            fprintf(raw, "%s,%d,%d,%d,%d,%d,%d", c->v->name, c->field_size, c->threads, c->depth,
+                    runs[i].rep, runs[i].ok, runs[i].ok && is_outlier(runs[i].m[M_GOODPUT], &goodput));
+            for (int m = 0; m < NUM_METRICS; m++) fprintf(raw, ",%.6g", runs[i].m[m]);
+            fprintf(raw, "\n");
+        }
+    }
+    free(x);
+    fclose(out);
+    if (raw) fclose(raw);
+    return 0;
+}
+
+
+/************************************************/
+
+int main(int argc, char *argv[]) {
+
+    struct bench_config cfg;
+    if (parse_bench_args(argc, argv, &cfg) < 0) {
+        exit(1);
+    }
+    if (cfg.isolate && isolate_driver(&cfg) < 0) {
+        exit(1);
+    }
+
+    // Cells; A4 has no pipelined client, so its depth > 1 cells are skipped
+    int max_cells = cfg.num_variants * cfg.num_sizes * cfg.num_threads * cfg.num_depths;
+    struct cell *cells = calloc(max_cells, sizeof(*cells));
+    if (!cells) {
+        perror("Failed to allocate the cell matrix");
+        exit(1);
+    }
+    int num_cells = 0;
+    for (int v = 0; v < cfg.num_variants; v++)
+        for (int s = 0; s < cfg.num_sizes; s++)
+            for (int t = 0; t < cfg.num_threads; t++)
+                for (int d = 0; d < cfg.num_depths; d++) {
+                    if (strcmp(cfg.variants[v].part, "A4") == 0 && cfg.depths[d] > 1) continue;
+                    cells[num_cells++] = (struct cell){ &cfg.variants[v], cfg.sizes[s], cfg.threads[t], cfg.depths[d] };
+                }
+
+    // Every (cell, rep) pair, shuffled together (Fisher-Yates)
+    int num_runs = num_cells * cfg.reps;
+    struct run *runs = calloc(num_runs, sizeof(*runs));
+    int *order = malloc(num_runs * sizeof(*order));
+    if (!runs || !order) {
+        perror("Failed to allocate the run list");
+        exit(1);
+    }
+    for (int i = 0; i < num_runs; i++) {
+        runs[i].cell = i / cfg.reps;
+        runs[i].rep = i % cfg.reps;
+        order[i] = i;
+    }
+    srand48(cfg.seed);
+    for (int i = num_runs - 1; i > 0; i--) {
+        int j = (int)(drand48() * (i + 1));
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    char control[64];
+    if (!cfg.cold_start) {
+        group_runs(cells, runs, order, num_runs);
+        snprintf(control, sizeof(control), "/tmp/MT25074_bench_%d.sock", (int)getpid());
+        cfg.control = control;
+    }
+
+    printf("Benchmark: %d cells x %d reps = %d runs, %ds warm-up + %ds each, seed %lu, %s\n",
+           num_cells, cfg.reps, num_runs, cfg.warmup, cfg.duration, cfg.seed,
+           cfg.cold_start ? "fresh server per run" : "persistent server per variant/size/threads");
+    fflush(stdout);
+
+    int failures = 0;
+    struct child server = { .fd = -1 };
+    const struct cell *server_cell = NULL;    // the group the running server belongs to
+    for (int k = 0; k < num_runs; k++) {
+        struct run *r = &runs[order[k]];
+        const struct cell *c = &cells[r->cell];
+        if (cfg.cold_start) {
+            r->ok = run_cold(&cfg, c, r) == 0;
+        } else {
+            if (server_cell && !same_server(server_cell, c)) {
+                server_down(&cfg, &server);
+                server_cell = NULL;
+            }
+            if (!server_cell && server_up(&cfg, c, &server) == 0) server_cell = c;
+            r->ok = server_cell && run_warm(&cfg, &server, c, r) == 0;
+            // A run that went wrong may have left connections or a dead server behind
+            if (!r->ok && server_cell) {
+                reap_children(&server, 1, 1);
+                server_cell = NULL;
+            }
+        }
+        failures += !r->ok;
+        printf("[%d/%d] %s size=%d threads=%d depth=%d rep=%d: ", k + 1, num_runs,
+               c->v->name, c->field_size, c->threads, c->depth, r->rep);
+        if (r->ok) {
+            printf("%.4f Gbps, %.0f cycles/msg, p99 %.1f us\n",
+                   r->m[M_GOODPUT], r->m[M_CYCLES_PER_MSG], r->m[M_P99_US]);
+        } else {
+            printf("FAILED\n");
+        }
+        fflush(stdout);
+        if (cfg.settle_ms > 0 && k + 1 < num_runs) usleep(cfg.settle_ms * 1000);
+    }
+
+    if (server_cell) server_down(&cfg, &server);
+
+    int rc = write_results(&cfg, cells, num_cells, runs, num_runs);
+    if (rc == 0) {
+        printf("Wrote %s%s%s (%d failed runs)\n", cfg.out,
+               cfg.runs_csv ? " and " : "", cfg.runs_csv ? cfg.runs_csv : "", failures);
+    }
+
+    free(order);
+    free(runs);
+    free(cells);
+    free(cfg.sizes);
+    free(cfg.threads);
+    free(cfg.depths);
+    return rc < 0 || failures == num_runs ? 1 : 0;
+}
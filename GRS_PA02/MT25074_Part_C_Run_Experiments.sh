@@ -1,18 +1,44 @@
 #!/bin/bash
 # MT25074_Part_C_Run_Experiments.sh
-# Automated experiments - produces individual CSV files + aggregated CSV
+# Automated experiments - builds, sets up the namespaces and hands the whole
+# matrix to the benchmark driver (MT25074_Part_C_Bench), which repeats every
+# cell REPS times in shuffled order and writes median / stddev / 95% CI
 
 ROLL_NUM="MT25074"
-PART_B_SCRIPT="./MT25074_Part_B_Run_Single_Experiment.sh"
+BENCH_BIN="./${ROLL_NUM}_Part_C_Bench"
 
-SIZES=(64 256 1024 4096)
-THREADS=(1 2 4 8)
-AGGREGATED_CSV="${ROLL_NUM}_Part_C_Results.csv"
+VARIANTS="A1,A2,A3,A4,A4ZC,A5,A6"
+# Small fields plus 64 KB - 4 MB, where sendfile / vmsplice can pay off
+SIZES="64,256,1024,4096,65536,262144,1048576,4194304"
+THREADS="1,2,4,8"
+DEPTHS=${DEPTHS:-1}
+REPS=${REPS:-5}
+AGGREGATED_CSV="${ROLL_NUM}_Part_C_Results.csv"   # one row per cell and metric
+RUNS_CSV="${ROLL_NUM}_Part_C_Runs.csv"            # one row per run
+
+# Optional placement, e.g. SERVER_CPUS=2,3 CLIENT_CPUS=4,5 ISOLATE=1;
+# SEED=<n> replays the run order of an earlier sweep; COLD_START=1 starts a
+# fresh server for every run instead of one persistent server per group
+BENCH_FLAGS=()
+[ -n "$SERVER_CPUS" ] && BENCH_FLAGS+=(--server-cpus "$SERVER_CPUS")
+[ -n "$CLIENT_CPUS" ] && BENCH_FLAGS+=(--client-cpus "$CLIENT_CPUS")
+[ "$ISOLATE" == "1" ] && BENCH_FLAGS+=(--isolate)
+[ -n "$SEED" ] && BENCH_FLAGS+=(--seed "$SEED")
+[ "$COLD_START" == "1" ] && BENCH_FLAGS+=(--cold-start)
+# BASELINE=<results csv> of an earlier sweep: compare against it when done.
+# Copied aside first, since it may well be last sweep's output cleaned below.
+BASELINE_COPY=""
+if [ -n "$BASELINE" ]; then
+    [ -f "$BASELINE" ] || { echo "Baseline $BASELINE not found"; exit 1; }
+    BASELINE_COPY=$(mktemp --suffix=.csv) || exit 1
+    cp "$BASELINE" "$BASELINE_COPY" || exit 1
+    trap 'rm -f "$BASELINE_COPY"' EXIT
+fi
 
 # Clean previous results (keep only .c, .h, .sh, Makefile, README)
 echo "Cleaning previous results..."
-rm -f ${ROLL_NUM}_Part_A?_size*_threads*.csv 2>/dev/null || true
-rm -f "$AGGREGATED_CSV" 2>/dev/null || true
+rm -f ${ROLL_NUM}_Part_A*_size*_threads*.csv 2>/dev/null || true
+rm -f "$AGGREGATED_CSV" "$RUNS_CSV" 2>/dev/null || true
 
 # Clean and build
 make clean 2>/dev/null || true
@@ -25,30 +51,11 @@ make all || exit 1
 echo "Setting up namespaces..."
 sudo bash ${ROLL_NUM}_Part_A_Namespaces.sh || exit 1
 
-# Aggregated CSV header
-echo "part,field_size,num_threads,cycles,instructions,ipc,cache_misses,cache_references,cache_miss_rate,context_switches" > "$AGGREGATED_CSV"
-
-TOTAL=$((3 * 4 * 4))
-CURRENT=0
-
 echo "Running experiments..."
-
-for PART in A1 A2 A3; do
-    for SIZE in "${SIZES[@]}"; do
-        for NUM in "${THREADS[@]}"; do
-            CURRENT=$((CURRENT + 1))
-            echo "[$CURRENT/$TOTAL] $PART size=$SIZE threads=$NUM"
-            
-            # Run experiment and get output filename
-            OUTPUT_FILE=$(sudo bash "$PART_B_SCRIPT" "$PART" "$SIZE" "$NUM")
-            
-            # Append to aggregated CSV (skip header, take data line)
-            tail -1 "$OUTPUT_FILE" >> "$AGGREGATED_CSV"
-            
-            sleep 0.2
-        done
-    done
-done
+sudo "$BENCH_BIN" --netns --variants "$VARIANTS" --sizes "$SIZES" --threads "$THREADS" \
+    --depths "$DEPTHS" --reps "$REPS" "${BENCH_FLAGS[@]}" \
+    --out "$AGGREGATED_CSV" --runs-csv "$RUNS_CSV"
+RC=$?
 
 # Cleanup
 make clean 2>/dev/null || true
@@ -57,13 +64,17 @@ sudo ip netns del ns2 2>/dev/null || true
 
 echo ""
 echo "=========================================="
-echo "Experiments complete!"
+[ $RC -eq 0 ] && echo "Experiments complete!" || echo "Experiments finished with errors (rc=$RC)"
 echo "=========================================="
 echo ""
-echo "Individual result files (48 files):"
-ls -1 ${ROLL_NUM}_Part_A?_size*_threads*.csv | head -10
-echo "... ($(ls ${ROLL_NUM}_Part_A?_size*_threads*.csv 2>/dev/null | wc -l) total files)"
-echo ""
-echo "Aggregated results: $AGGREGATED_CSV"
+echo "Per-cell statistics: $AGGREGATED_CSV"
+echo "Every run:           $RUNS_CSV"
 echo ""
-cat "$AGGREGATED_CSV"
\ No newline at end of file
+grep ",goodput_gbps," "$AGGREGATED_CSV" 2>/dev/null | head -20
+
+if [ $RC -eq 0 ] && [ -n "$BASELINE_COPY" ]; then
+    echo ""
+    echo "Comparing against $BASELINE..."
+    python3 ${ROLL_NUM}_Part_D_Plots.py --baseline "$BASELINE_COPY" -- "$RUNS_CSV" || RC=$?
+fi
+exit $RC
@@ -2,238 +2,399 @@
 # MT25074_Part_D_Plots.py
 # Part D: Plotting and Visualization
 # Generates plots from Part C experimental results
+#
+# Reads any number of result CSVs and merges them by cell
+# (variant, field_size, threads, depth):
+#   - MT25074_Part_C_Results.csv    benchmark driver, one row per cell and metric
+#   - MT25074_Part_C_Runs.csv       benchmark driver, one row per run
+#   - MT25074_Part_A*_size*.csv     Part B single experiments (old aggregated CSVs too;
+#                                   they only have perf counters, so give Plots 3 and 4)
+#   - MT25074_Part_A*_latency.csv   Part B latency percentiles
+# Raw runs of the same cell are pooled, whichever file they come from. Every
+# point is the mean, and its error bar the 95% CI of that mean
+# (mean +/- t * stddev / sqrt(n), the driver's ci95_low / ci95_high).
+#
+# Usage:
+#   python3 MT25074_Part_D_Plots.py [--size S] [--depth D] [--variants LIST] [CSV ...]
+#   python3 MT25074_Part_D_Plots.py --baseline OLD.csv [OLD2.csv ...] -- NEW.csv [NEW2.csv ...]
+# The second form compares two result sets, writes MT25074_Part_D_Regression.png
+# and .csv, and exits with status 1 when any metric regressed, so it can run
+# after every build.
 
+import argparse
+import csv
+import math
+import os
+import platform
+import re
+import statistics
+import sys
+
+import matplotlib
+matplotlib.use('Agg')   # files only, no display needed
 import matplotlib.pyplot as plt
-import numpy as np
 
 # System configuration
-SYSTEM_CONFIG = "Linux 6.8.0-100, perf tool, Network namespaces (ns1/ns2)"
-
-# Hardcoded data from MT25074_Part_C_Results.csv
-# Format: part, field_size, num_threads, cycles, instructions, ipc, cache_misses, cache_references, cache_miss_rate, context_switches
-
-# A1 (Two-Copy) data
-A1_field_size = [64, 64, 64, 64, 256, 256, 256, 256, 1024, 1024, 1024, 1024, 4096, 4096, 4096, 4096]
-A1_num_threads = [1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8]
-A1_cycles = [39475195, 72915496, 145423266, 239993734, 57339554, 422731044, 196384431, 559373781, 
-             481972275, 889358924, 1632860714, 3505906322, 21837116057, 39078594641, 66151152030, 112375457443]
-A1_cache_misses = [1106106, 1852938, 4599321, 8261668, 1766876, 14328400, 6127387, 18548918,
-                   11534759, 21468263, 38828402, 82573726, 451861353, 794469453, 1203171466, 1470317153]
-
-# A2 (One-Copy) data
-A2_field_size = [64, 64, 64, 64, 256, 256, 256, 256, 1024, 1024, 1024, 1024, 4096, 4096, 4096, 4096]
-A2_num_threads = [1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8]
-A2_cycles = [42492945, 80720228, 154138040, 287522828, 64854783, 450791965, 201773672, 435136643,
-             457718323, 1237521711, 2069915834, 4762915157, 21312543835, 38604787844, 74897780705, 104265049315]
-A2_cache_misses = [1109381, 2130726, 4701976, 7935811, 1636074, 15007026, 6345088, 12662830,
-                   10792756, 30842059, 51231940, 119332090, 457004495, 803483378, 1390654072, 1381411280]
-
-# A3 (Zero-Copy) data
-A3_field_size = [64, 64, 64, 64, 256, 256, 256, 256, 1024, 1024, 1024, 1024, 4096, 4096, 4096, 4096]
-A3_num_threads = [1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8]
-A3_cycles = [47243393, 91816484, 164884933, 292013243, 164299763, 435833879, 781801562, 1724926034,
-             311139173, 681113648, 1483712583, 2971613313, 20499727968, 37578446744, 75483270897, 109139400671]
-A3_cache_misses = [1324059, 2856468, 4826505, 9849433, 5840901, 15492459, 25941890, 63279628,
-                   8606617, 19603870, 42365662, 82880079, 658121770, 1090285843, 1883149653, 1770599067]
-
-# Message sizes for plotting
-message_sizes = [64, 256, 1024, 4096]
-thread_counts = [1, 2, 4, 8]
-
-def extract_by_size(data_dict, field_size_val):
-    """Extract data for a specific field size"""
-    result = []
-    for i, size in enumerate(data_dict['field_size']):
-        if size == field_size_val:
-            result.append(data_dict['value'][i])
-    return result
-
-def extract_by_threads(data_dict, thread_val):
-    """Extract data for a specific thread count"""
-    result = []
-    for i, threads in enumerate(data_dict['num_threads']):
-        if threads == thread_val:
-            result.append(data_dict['value'][i])
-    return result
-
-# Plot 1: Throughput vs Message Size
-# Throughput calculated as: bytes per cycle (field_size / cycles)
-# Higher throughput = more bytes transferred per cycle
-def plot_throughput_vs_size():
-    fig, ax = plt.subplots(figsize=(10, 6))
-    
-    # Calculate throughput for each size (average across thread counts for each size)
-    A1_throughput = []
-    A2_throughput = []
-    A3_throughput = []
-    
-    for size in message_sizes:
-        # Get all cycles for this size across all threads
-        A1_cycles_for_size = [A1_cycles[i] for i in range(len(A1_field_size)) if A1_field_size[i] == size]
-        A2_cycles_for_size = [A2_cycles[i] for i in range(len(A2_field_size)) if A2_field_size[i] == size]
-        A3_cycles_for_size = [A3_cycles[i] for i in range(len(A3_field_size)) if A3_field_size[i] == size]
-        
-        # Calculate average throughput (bytes per cycle) - using harmonic mean for better representation
-        A1_avg = size / np.mean(A1_cycles_for_size) if A1_cycles_for_size else 0
-        A2_avg = size / np.mean(A2_cycles_for_size) if A2_cycles_for_size else 0
-        A3_avg = size / np.mean(A3_cycles_for_size) if A3_cycles_for_size else 0
-        
-        A1_throughput.append(A1_avg * 1e9)  # Scale for readability
-        A2_throughput.append(A2_avg * 1e9)
-        A3_throughput.append(A3_avg * 1e9)
-    
-    ax.plot(message_sizes, A1_throughput, marker='o', label='A1 (Two-Copy)', linewidth=2)
-    ax.plot(message_sizes, A2_throughput, marker='s', label='A2 (One-Copy)', linewidth=2)
-    ax.plot(message_sizes, A3_throughput, marker='^', label='A3 (Zero-Copy)', linewidth=2)
-    
-    ax.set_xlabel('Message Size (bytes)', fontsize=12)
-    ax.set_ylabel('Throughput (Normalized: bytes/cycle × 10⁹)', fontsize=12)
-    ax.set_title('Throughput vs Message Size', fontsize=14, fontweight='bold')
-    ax.legend(fontsize=10)
-    ax.grid(True, alpha=0.3)
-    ax.set_xscale('log', base=2)
-    ax.set_xticks(message_sizes)
-    ax.set_xticklabels([str(s) for s in message_sizes])
-    
-    # Add system config
-    fig.text(0.5, 0.02, f'System: {SYSTEM_CONFIG}', ha='center', fontsize=9, style='italic')
-    
-    plt.tight_layout()
-    plt.savefig('MT25074_Part_D_Plot1_Throughput_vs_Size.png', dpi=300, bbox_inches='tight')
-    plt.close()
-    print("Plot 1 saved: MT25074_Part_D_Plot1_Throughput_vs_Size.png")
-
-# Plot 2: Latency vs Thread Count
-# Latency represented as cycles (proxy metric)
-def plot_latency_vs_threads():
-    fig, ax = plt.subplots(figsize=(10, 6))
-    
-    # Use size=1024 as representative for latency analysis
-    size_idx = 1024
-    
-    # Extract cycles for size=1024 across different thread counts
-    A1_latency = []
-    A2_latency = []
-    A3_latency = []
-    
-    for threads in thread_counts:
-        A1_cycles_val = [A1_cycles[i] for i in range(len(A1_field_size)) 
-                         if A1_field_size[i] == size_idx and A1_num_threads[i] == threads]
-        A2_cycles_val = [A2_cycles[i] for i in range(len(A2_field_size)) 
-                         if A2_field_size[i] == size_idx and A2_num_threads[i] == threads]
-        A3_cycles_val = [A3_cycles[i] for i in range(len(A3_field_size)) 
-                         if A3_field_size[i] == size_idx and A3_num_threads[i] == threads]
-        
-        A1_latency.append(A1_cycles_val[0] if A1_cycles_val else 0)
-        A2_latency.append(A2_cycles_val[0] if A2_cycles_val else 0)
-        A3_latency.append(A3_cycles_val[0] if A3_cycles_val else 0)
-    
-    ax.plot(thread_counts, A1_latency, marker='o', label='A1 (Two-Copy)', linewidth=2)
-    ax.plot(thread_counts, A2_latency, marker='s', label='A2 (One-Copy)', linewidth=2)
-    ax.plot(thread_counts, A3_latency, marker='^', label='A3 (Zero-Copy)', linewidth=2)
-    
-    ax.set_xlabel('Number of Threads', fontsize=12)
-    ax.set_ylabel('Latency (CPU Cycles)', fontsize=12)
-    ax.set_title('Latency vs Thread Count (Message Size: 1024 bytes)', fontsize=14, fontweight='bold')
-    ax.legend(fontsize=10)
-    ax.grid(True, alpha=0.3)
-    ax.set_xticks(thread_counts)
-    
-    # Add system config
-    fig.text(0.5, 0.02, f'System: {SYSTEM_CONFIG}', ha='center', fontsize=9, style='italic')
-    
-    plt.tight_layout()
-    plt.savefig('MT25074_Part_D_Plot2_Latency_vs_Threads.png', dpi=300, bbox_inches='tight')
-    plt.close()
-    print("Plot 2 saved: MT25074_Part_D_Plot2_Latency_vs_Threads.png")
-
-# Plot 3: Cache Misses vs Message Size
-def plot_cache_misses_vs_size():
-    fig, ax = plt.subplots(figsize=(10, 6))
-    
-    # Calculate average cache misses for each size (across all thread counts)
-    A1_cache_avg = []
-    A2_cache_avg = []
-    A3_cache_avg = []
-    
-    for size in message_sizes:
-        A1_misses = [A1_cache_misses[i] for i in range(len(A1_field_size)) if A1_field_size[i] == size]
-        A2_misses = [A2_cache_misses[i] for i in range(len(A2_field_size)) if A2_field_size[i] == size]
-        A3_misses = [A3_cache_misses[i] for i in range(len(A3_field_size)) if A3_field_size[i] == size]
-        
-        A1_cache_avg.append(np.mean(A1_misses))
-        A2_cache_avg.append(np.mean(A2_misses))
-        A3_cache_avg.append(np.mean(A3_misses))
-    
-    ax.plot(message_sizes, A1_cache_avg, marker='o', label='A1 (Two-Copy)', linewidth=2)
-    ax.plot(message_sizes, A2_cache_avg, marker='s', label='A2 (One-Copy)', linewidth=2)
-    ax.plot(message_sizes, A3_cache_avg, marker='^', label='A3 (Zero-Copy)', linewidth=2)
-    
-    ax.set_xlabel('Message Size (bytes)', fontsize=12)
-    ax.set_ylabel('Cache Misses (Average)', fontsize=12)
-    ax.set_title('Cache Misses vs Message Size', fontsize=14, fontweight='bold')
-    ax.legend(fontsize=10)
-    ax.grid(True, alpha=0.3)
-    ax.set_xscale('log', base=2)
-    ax.set_xticks(message_sizes)
-    ax.set_xticklabels([str(s) for s in message_sizes])
-    ax.set_yscale('log')
-    
-    # Add system config
-    fig.text(0.5, 0.02, f'System: {SYSTEM_CONFIG}', ha='center', fontsize=9, style='italic')
-    
-    plt.tight_layout()
-    plt.savefig('MT25074_Part_D_Plot3_CacheMisses_vs_Size.png', dpi=300, bbox_inches='tight')
-    plt.close()
-    print("Plot 3 saved: MT25074_Part_D_Plot3_CacheMisses_vs_Size.png")
-
-# Plot 4: CPU Cycles per Byte Transferred
-def plot_cycles_per_byte():
-    fig, ax = plt.subplots(figsize=(10, 6))
-    
-    # Calculate cycles per byte for each size (average across thread counts)
-    A1_cpb = []
-    A2_cpb = []
-    A3_cpb = []
-    
-    for size in message_sizes:
-        A1_cycles_for_size = [A1_cycles[i] for i in range(len(A1_field_size)) if A1_field_size[i] == size]
-        A2_cycles_for_size = [A2_cycles[i] for i in range(len(A2_field_size)) if A2_field_size[i] == size]
-        A3_cycles_for_size = [A3_cycles[i] for i in range(len(A3_field_size)) if A3_field_size[i] == size]
-        
-        A1_cpb.append(np.mean([c / size for c in A1_cycles_for_size]))
-        A2_cpb.append(np.mean([c / size for c in A2_cycles_for_size]))
-        A3_cpb.append(np.mean([c / size for c in A3_cycles_for_size]))
-    
-    ax.plot(message_sizes, A1_cpb, marker='o', label='A1 (Two-Copy)', linewidth=2)
-    ax.plot(message_sizes, A2_cpb, marker='s', label='A2 (One-Copy)', linewidth=2)
-    ax.plot(message_sizes, A3_cpb, marker='^', label='A3 (Zero-Copy)', linewidth=2)
-    
-    ax.set_xlabel('Message Size (bytes)', fontsize=12)
-    ax.set_ylabel('CPU Cycles per Byte', fontsize=12)
-    ax.set_title('CPU Cycles per Byte Transferred', fontsize=14, fontweight='bold')
-    ax.legend(fontsize=10)
-    ax.grid(True, alpha=0.3)
-    ax.set_xscale('log', base=2)
-    ax.set_xticks(message_sizes)
-    ax.set_xticklabels([str(s) for s in message_sizes])
-    
-    # Add system config
-    fig.text(0.5, 0.02, f'System: {SYSTEM_CONFIG}', ha='center', fontsize=9, style='italic')
-    
-    plt.tight_layout()
-    plt.savefig('MT25074_Part_D_Plot4_CyclesPerByte.png', dpi=300, bbox_inches='tight')
-    plt.close()
-    print("Plot 4 saved: MT25074_Part_D_Plot4_CyclesPerByte.png")
+SYSTEM_CONFIG = (f"Linux {platform.release()}, in-process perf_event_open counters, "
+                 f"Network namespaces (ns1/ns2)")
+
+DEFAULT_INPUT = "MT25074_Part_C_Results.csv"
+NUM_FIELDS = 8
+
+VARIANT_NAMES = {
+    'A1': 'A1 (Two-Copy)',
+    'A2': 'A2 (One-Copy)',
+    'A3': 'A3 (Zero-Copy)',
+    'A4': 'A4 (io_uring)',
+    'A4ZC': 'A4ZC (io_uring SEND_ZC)',
+    'A5': 'A5 (sendfile)',
+    'A6': 'A6 (vmsplice + splice)',
+}
+MARKERS = ['o', 's', '^', 'D', 'v', 'P', 'X', '*', 'h', '<', '>']
+
+# Regression check: which direction is better, per metric
+HIGHER_IS_BETTER = {'goodput_gbps': True, 'msgs_per_sec': True, 'p50_us': False,
+                    'p99_us': False, 'cycles_per_msg': False, 'cycles_per_byte': False,
+                    'cache_misses': False, 'context_switches': False}
+DEFAULT_THRESHOLD_PCT = 5.0
+
+
+class Stat:
+    """One metric of one cell: mean and its 95% CI"""
+    def __init__(self, center, low, high, n):
+        self.center, self.low, self.high, self.n = center, low, high, n
+
+    def scaled(self, k):
+        return Stat(self.center * k, self.low * k, self.high * k, self.n)
+
+
+def t95(df):
+    """Two-sided 95% Student t quantile (same table as the benchmark driver)"""
+    table = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+             2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+             2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+    if df < 1:
+        return 0.0
+    return table[df - 1] if df <= len(table) else 1.960
+
+
+def stat_from_samples(values):
+    n = len(values)
+    mean = statistics.fmean(values)
+    half = t95(n - 1) * statistics.stdev(values) / math.sqrt(n) if n > 1 else 0.0
+    return Stat(mean, mean - half, mean + half, n)
+
+
+def bytes_per_message(field_size):
+    # Request + response payload of one round trip
+    return 2 * NUM_FIELDS * field_size
+
+
+# ==================== LOADING ====================
+
+class ResultSet:
+    def __init__(self):
+        self.samples = {}     # cell -> metric -> [values]  (raw runs)
+        self.summaries = {}   # cell -> metric -> Stat      (driver summary rows)
+
+    def add_sample(self, cell, metric, value):
+        self.samples.setdefault(cell, {}).setdefault(metric, []).append(value)
+
+    def add_row(self, cell, row, skip):
+        for key, value in row.items():
+            if key in skip or value in (None, ''):
+                continue
+            try:
+                self.add_sample(cell, key, float(value))
+            except ValueError:
+                pass
+        cpm = row.get('cycles_per_msg')
+        if cpm not in (None, ''):
+            self.add_sample(cell, 'cycles_per_byte', float(cpm) / bytes_per_message(cell[1]))
+        elif 'cycles_per_msg' not in row and row.get('cycles') not in (None, ''):
+            # Old aggregated layout, no message count: cycles over the field
+            # size, as the original Part D plots computed it
+            self.add_sample(cell, 'cycles_per_byte', float(row['cycles']) / cell[1])
+
+    def cells(self):
+        """cell -> metric -> Stat; raw runs win over summary rows"""
+        out = {}
+        for cell, metrics in self.summaries.items():
+            out.setdefault(cell, {}).update(metrics)
+        for cell, metrics in self.samples.items():
+            for metric, values in metrics.items():
+                out.setdefault(cell, {})[metric] = stat_from_samples(values)
+        return out
+
+
+LATENCY_NAME = re.compile(r'_Part_(A\w+?)_size(\d+)_threads(\d+)(?:_(\w+?))?_latency\.csv$')
+
+
+def load_csv(path, results):
+    with open(path, newline='') as f:
+        rows = list(csv.DictReader(f))
+    if not rows:
+        print(f"  {path}: empty, skipped")
+        return
+    header = set(rows[0].keys())
+
+    if {'metric', 'mean', 'ci95_low', 'ci95_high'} <= header:
+        # Driver summary: already one Stat per cell and metric
+        for r in rows:
+            if int(r['n']) == 0:
+                continue
+            cell = (r['variant'], int(r['field_size']), int(r['threads']), int(r['depth']))
+            stat = Stat(float(r['mean']), float(r['ci95_low']), float(r['ci95_high']), int(r['n']))
+            metrics = results.summaries.setdefault(cell, {})
+            metrics[r['metric']] = stat
+            if r['metric'] == 'cycles_per_msg':
+                metrics['cycles_per_byte'] = stat.scaled(1.0 / bytes_per_message(cell[1]))
+        kind = "driver summary"
+    elif {'rep', 'ok'} <= header:
+        # Driver runs: one sample per successful run
+        for r in rows:
+            if r['ok'] != '1':
+                continue
+            cell = (r['variant'], int(r['field_size']), int(r['threads']), int(r['depth']))
+            results.add_row(cell, r, {'variant', 'field_size', 'threads', 'depth', 'rep', 'ok', 'outlier'})
+        kind = "driver runs"
+    elif {'part', 'num_threads'} <= header:
+        # Part B experiment (stop-and-wait clients: depth 1)
+        for r in rows:
+            cell = (r['part'], int(r['field_size']), int(r['num_threads']), 1)
+            results.add_row(cell, r, {'part', 'field_size', 'num_threads'})
+        kind = "Part B"
+    elif 'p50_ns' in header:
+        # Part B latency file: the cell is in the file name
+        m = LATENCY_NAME.search(os.path.basename(path))
+        if not m:
+            print(f"  {path}: latency CSV without a Part B file name, skipped")
+            return
+        variant = m.group(1) + (f"-{m.group(4)}" if m.group(4) else "")
+        cell = (variant, int(m.group(2)), int(m.group(3)), 1)
+        for r in rows:
+            results.add_sample(cell, 'p50_us', float(r['p50_ns']) / 1000.0)
+            results.add_sample(cell, 'p99_us', float(r['p99_ns']) / 1000.0)
+        kind = "latency"
+    else:
+        print(f"  {path}: unknown CSV layout, skipped")
+        return
+    print(f"  {path}: {len(rows)} rows ({kind})")
+
+
+def load_all(paths):
+    results = ResultSet()
+    for path in paths:
+        if not os.path.exists(path):
+            print(f"  {path}: not found, skipped")
+            continue
+        load_csv(path, results)
+    return results.cells()
+
+
+# ==================== PLOTTING ====================
+
+def variant_label(variant):
+    base, _, mode = variant.partition('-')
+    label = VARIANT_NAMES.get(base, base)
+    return f"{label} {mode}" if mode else label
+
+
+def select(cells, variants, depth):
+    chosen = sorted({c[0] for c in cells if c[3] == depth})
+    if variants:
+        chosen = [v for v in variants if v in chosen]
+    return chosen
+
+
+def plot_series(ax, cells, variants, metric, xs_of, x_key):
+    """One line per variant; x_key(cell) picks the x value of the cells in xs_of(variant)"""
+    plotted = False
+    for i, variant in enumerate(variants):
+        points = sorted((x_key(c), cells[c][metric]) for c in xs_of(variant) if metric in cells[c])
+        if not points:
+            continue
+        xs = [p[0] for p in points]
+        ys = [p[1].center for p in points]
+        err = [[p[1].center - p[1].low for p in points],
+               [p[1].high - p[1].center for p in points]]
+        ax.errorbar(xs, ys, yerr=err, marker=MARKERS[i % len(MARKERS)], capsize=3,
+                    label=variant_label(variant), linewidth=2)
+        plotted = True
+    return plotted
+
+
+def finish(fig, filename):
+    fig.text(0.5, 0.01, f'System: {SYSTEM_CONFIG}', ha='center', fontsize=9, style='italic')
+    fig.tight_layout(rect=(0, 0.03, 1, 1))
+    fig.savefig(filename, dpi=300, bbox_inches='tight')
+    plt.close(fig)
+    print(f"Saved: {filename}")
+
+
+def plot_metric_vs_size(cells, variants, depth, metric, ylabel, title, filename, logy=False):
+    """One panel per thread count, x = field size"""
+    threads = sorted({c[2] for c in cells if c[3] == depth and metric in cells[c]})
+    if not threads:
+        print(f"No {metric} data, {filename} skipped")
+        return
+    fig, axes = plt.subplots(1, len(threads), figsize=(5 * len(threads), 5), squeeze=False)
+    for ax, t in zip(axes[0], threads):
+        plot_series(ax, cells, variants, metric,
+                    lambda v: [c for c in cells if c[0] == v and c[2] == t and c[3] == depth],
+                    lambda c: c[1])
+        ax.set_title(f'{t} thread{"s" if t > 1 else ""}', fontsize=12)
+        ax.set_xlabel('Field Size (bytes)', fontsize=11)
+        ax.set_xscale('log', base=2)
+        ax.grid(True, alpha=0.3)
+        positive = all(cells[c][metric].center > 0 for c in cells
+                       if c[2] == t and c[3] == depth and metric in cells[c])
+        if logy and positive:
+            ax.set_yscale('log')
+    axes[0][0].set_ylabel(ylabel, fontsize=11)
+    axes[0][-1].legend(fontsize=8)
+    fig.suptitle(f'{title} (depth {depth}, mean, 95% CI)', fontsize=14, fontweight='bold')
+    finish(fig, filename)
+
+
+def plot_latency_vs_threads(cells, variants, depth, size, filename):
+    """p50 and p99 round-trip latency, x = thread count, at one field size"""
+    fig, axes = plt.subplots(1, 2, figsize=(12, 5), squeeze=False)
+    any_data = False
+    for ax, metric, name in zip(axes[0], ['p50_us', 'p99_us'], ['p50', 'p99']):
+        any_data |= plot_series(ax, cells, variants, metric,
+                                lambda v: [c for c in cells if c[0] == v and c[1] == size and c[3] == depth],
+                                lambda c: c[2])
+        ax.set_title(f'{name} round-trip latency', fontsize=12)
+        ax.set_xlabel('Number of Threads', fontsize=11)
+        ax.set_ylabel('Latency (us)', fontsize=11)
+        ax.grid(True, alpha=0.3)
+    if not any_data:
+        plt.close(fig)
+        print(f"No latency data for size {size}, {filename} skipped")
+        return
+    axes[0][-1].legend(fontsize=8)
+    fig.suptitle(f'Latency vs Thread Count (Field Size: {size} bytes, depth {depth})',
+                 fontsize=14, fontweight='bold')
+    finish(fig, filename)
+
+
+def plot_all(cells, args):
+    variants = select(cells, args.variants, args.depth)
+    if not variants:
+        print(f"No cells with depth {args.depth}; nothing to plot")
+        return 1
+    print(f"Variants: {', '.join(variants)}")
+
+    plot_metric_vs_size(cells, variants, args.depth, 'goodput_gbps', 'Goodput (Gbps)',
+                        'Throughput vs Field Size', 'MT25074_Part_D_Plot1_Throughput_vs_Size.png')
+    plot_latency_vs_threads(cells, variants, args.depth, args.size,
+                            'MT25074_Part_D_Plot2_Latency_vs_Threads.png')
+    plot_metric_vs_size(cells, variants, args.depth, 'cache_misses', 'Cache Misses',
+                        'Cache Misses vs Field Size', 'MT25074_Part_D_Plot3_CacheMisses_vs_Size.png',
+                        logy=True)
+    plot_metric_vs_size(cells, variants, args.depth, 'cycles_per_byte', 'CPU Cycles per Byte',
+                        'CPU Cycles per Byte Transferred', 'MT25074_Part_D_Plot4_CyclesPerByte.png',
+                        logy=True)
+    return 0
+
+
+# ==================== REGRESSION COMPARISON ====================
+
+def compare(baseline, candidate, threshold_pct):
+    """
+    Every cell and metric present in both sets. A change counts as a
+    regression (or improvement) only when it is larger than threshold_pct and
+    the two 95% CIs do not overlap; anything else is noise.
+    """
+    rows = []
+    for cell in sorted(set(baseline) & set(candidate)):
+        for metric, higher_better in HIGHER_IS_BETTER.items():
+            b, c = baseline[cell].get(metric), candidate[cell].get(metric)
+            if b is None or c is None or b.center == 0:
+                continue
+            change = 100.0 * (c.center - b.center) / abs(b.center)
+            overlap = c.low <= b.high and b.low <= c.high
+            worse = change < 0 if higher_better else change > 0
+            if abs(change) <= threshold_pct or overlap:
+                verdict = 'noise'
+            else:
+                verdict = 'regression' if worse else 'improvement'
+            rows.append((cell, metric, b, c, change, verdict))
+    return rows
+
+
+def write_regression(rows, csv_path, png_path):
+    with open(csv_path, 'w', newline='') as f:
+        w = csv.writer(f)
+        w.writerow(['variant', 'field_size', 'threads', 'depth', 'metric', 'baseline_mean',
+                    'candidate_mean', 'change_pct', 'verdict'])
+        for cell, metric, b, c, change, verdict in rows:
+            w.writerow([*cell, metric, f'{b.center:.6g}', f'{c.center:.6g}', f'{change:.2f}', verdict])
+    print(f"Saved: {csv_path}")
+
+    # One panel per metric: % change per cell, red = regression, green = improvement
+    metrics = [m for m in HIGHER_IS_BETTER if any(r[1] == m for r in rows)]
+    fig, axes = plt.subplots(len(metrics), 1, figsize=(14, 3.2 * len(metrics)), squeeze=False)
+    colors = {'regression': 'tab:red', 'improvement': 'tab:green', 'noise': 'tab:gray'}
+    for ax, metric in zip(axes[:, 0], metrics):
+        sel = [r for r in rows if r[1] == metric]
+        labels = [f'{r[0][0]}/{r[0][1]}/t{r[0][2]}/d{r[0][3]}' for r in sel]
+        ax.bar(range(len(sel)), [r[4] for r in sel], color=[colors[r[5]] for r in sel])
+        ax.axhline(0, color='black', linewidth=0.8)
+        ax.set_ylabel(f'{metric}\n% change', fontsize=9)
+        ax.set_xticks(range(len(sel)))
+        ax.set_xticklabels(labels, rotation=90, fontsize=6)
+        ax.grid(True, axis='y', alpha=0.3)
+    fig.suptitle('Candidate vs Baseline (red: regression, green: improvement, grey: within noise)',
+                 fontsize=13, fontweight='bold')
+    finish(fig, png_path)
+
+
+def run_regression(args):
+    print("Baseline:")
+    baseline = load_all(args.baseline)
+    print("Candidate:")
+    candidate = load_all(args.csv or [DEFAULT_INPUT])
+    rows = compare(baseline, candidate, args.threshold)
+    if not rows:
+        print("No cells in common between the two result sets")
+        return 1
+
+    write_regression(rows, 'MT25074_Part_D_Regression.csv', 'MT25074_Part_D_Regression.png')
+    regressions = [r for r in rows if r[5] == 'regression']
+    improvements = sum(1 for r in rows if r[5] == 'improvement')
+    print(f"{len(rows)} comparisons: {len(regressions)} regressions, {improvements} improvements "
+          f"(threshold {args.threshold}% and non-overlapping 95% CIs)")
+    for cell, metric, b, c, change, _ in regressions:
+        print(f"  REGRESSION {cell[0]} size={cell[1]} threads={cell[2]} depth={cell[3]} "
+              f"{metric}: {b.center:.6g} -> {c.center:.6g} ({change:+.1f}%)")
+    return 1 if regressions else 0
+
+
+def parse_args():
+    ap = argparse.ArgumentParser(description="Part D plots from Part B/C result CSVs")
+    ap.add_argument('csv', nargs='*', help=f"result CSVs (default {DEFAULT_INPUT})")
+    ap.add_argument('--size', type=int, default=1024, help="field size of the latency plot (default 1024)")
+    ap.add_argument('--depth', type=int, default=1, help="pipeline depth to plot (default 1)")
+    ap.add_argument('--variants', type=lambda s: s.split(','), help="comma-separated variants to plot")
+    ap.add_argument('--baseline', nargs='+', metavar='CSV',
+                    help="compare the given CSVs against these instead of plotting")
+    ap.add_argument('--threshold', type=float, default=DEFAULT_THRESHOLD_PCT,
+                    help=f"minimum change in %% to report (default {DEFAULT_THRESHOLD_PCT})")
+    return ap.parse_args()
+
 
 if __name__ == "__main__":
+    args = parse_args()
     print("Generating Part D plots...")
     print("=" * 50)
-    
-    plot_throughput_vs_size()
-    plot_latency_vs_threads()
-    plot_cache_misses_vs_size()
-    plot_cycles_per_byte()
-    
+
+    if args.baseline:
+        rc = run_regression(args)
+    else:
+        print("Input:")
+        rc = plot_all(load_all(args.csv or [DEFAULT_INPUT]), args)
+
     print("=" * 50)
-    print("All plots generated successfully!")
+    sys.exit(rc)